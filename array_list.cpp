@@ -2,31 +2,2315 @@
 #include <stdexcept>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
+/**
+ * @brief Decides how an ArrayList grows and shrinks its buffer.
+ *
+ * The buffer grows to grow(capacity) when it is full. Once fewer than
+ * shrink_threshold * capacity elements are in use it shrinks to the first
+ * capacity on the growth ladder (starting at min_capacity) that holds
+ * shrink_headroom * size elements. A headroom above one keeps a list that
+ * hovers around the threshold from shrinking and growing over and over.
+ */
+struct GrowthPolicy {
+    // Returns the next capacity when the buffer is full
+    int (*grow)(int capacity) = grow_double;
+    // Shrink when less than this fraction of the capacity is used
+    double shrink_threshold = 0.25;
+    // Keep room for this many times the current size after shrinking
+    double shrink_headroom = 1.0;
+    // The buffer never gets smaller than this
+    int min_capacity = 1;
+    // Keep the buffer at its largest size
+    bool never_shrink = false;
+
+    static int grow_double(int capacity) {
+        return capacity * 2;
+    }
+
+    static int grow_one_and_a_half(int capacity) {
+        return capacity + capacity / 2;
+    }
+
+    // Double on growth, shrink to a tight fit below 25% usage
+    static GrowthPolicy doubling() {
+        return GrowthPolicy{};
+    }
+
+    // Grow by 1.5x, which lets freed blocks be reused by later growth
+    static GrowthPolicy one_and_a_half() {
+        GrowthPolicy policy;
+        policy.grow = grow_one_and_a_half;
+        return policy;
+    }
+
+    // Grow with a user supplied function
+    static GrowthPolicy custom(int (*grow)(int capacity)) {
+        GrowthPolicy policy;
+        policy.grow = grow;
+        return policy;
+    }
+
+    // Shrink below 25% usage, but only down to twice the current size
+    static GrowthPolicy hysteresis() {
+        GrowthPolicy policy;
+        policy.shrink_headroom = 2.0;
+        return policy;
+    }
+
+    // Never give memory back
+    static GrowthPolicy no_shrink() {
+        GrowthPolicy policy;
+        policy.never_shrink = true;
+        return policy;
+    }
+};
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ARRAY_LIST_SIMD 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Vectorized scans over int buffers for ArrayList::min, max, argmin,
+ * argmax and count.
+ *
+ * Every kernel exists as a scalar loop and, on x86 with GCC or Clang, as
+ * SSE4.1, AVX2 and AVX-512 versions compiled with target attributes. The
+ * best version the CPU supports is picked from cpuid the first time
+ * kernels() is called. argmin and argmax keep the best index per lane and
+ * only replace it on a strictly smaller/larger value, so ties still resolve
+ * to the first index like the scalar loops.
+ */
+namespace simd {
+
+enum class Isa { scalar, sse41, avx2, avx512 };
+
+// Function table for one instruction set. All functions require n > 0
+// except count.
+struct Kernels {
+    int (*min)(const int* data, int n);
+    int (*max)(const int* data, int n);
+    int (*argmin)(const int* data, int n);
+    int (*argmax)(const int* data, int n);
+    int (*count)(const int* data, int n, int value);
+};
+
+inline int min_scalar(const int* data, int n) {
+    int min_value = data[0];
+    for (int i = 1; i < n; i++) {
+        if (data[i] < min_value) {
+            min_value = data[i];
+        }
+    }
+    return min_value;
+}
+
+inline int max_scalar(const int* data, int n) {
+    int max_value = data[0];
+    for (int i = 1; i < n; i++) {
+        if (data[i] > max_value) {
+            max_value = data[i];
+        }
+    }
+    return max_value;
+}
+
+inline int argmin_scalar(const int* data, int n) {
+    int min_index = 0;
+    for (int i = 1; i < n; i++) {
+        if (data[i] < data[min_index]) {
+            min_index = i;
+        }
+    }
+    return min_index;
+}
+
+inline int argmax_scalar(const int* data, int n) {
+    int max_index = 0;
+    for (int i = 1; i < n; i++) {
+        if (data[i] > data[max_index]) {
+            max_index = i;
+        }
+    }
+    return max_index;
+}
+
+inline int count_scalar(const int* data, int n, int value) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        count += data[i] == value;
+    }
+    return count;
+}
+
+// Pick the first index among the lanes holding the best value, then let the
+// scalar tail starting at from improve on it.
+template <bool Smaller>
+inline int reduce_lanes(const int* data, int n, int from, const int* values, const int* indices, int lanes) {
+    int best = 0;
+    for (int lane = 1; lane < lanes; lane++) {
+        bool better = Smaller ? values[lane] < values[best] : values[lane] > values[best];
+        if (better || (values[lane] == values[best] && indices[lane] < indices[best])) {
+            best = lane;
+        }
+    }
+    int best_index = indices[best];
+    for (int i = from; i < n; i++) {
+        if (Smaller ? data[i] < data[best_index] : data[i] > data[best_index]) {
+            best_index = i;
+        }
+    }
+    return best_index;
+}
+
+#ifdef ARRAY_LIST_SIMD
+
+__attribute__((target("sse4.1"))) inline int min_sse41(const int* data, int n) {
+    if (n < 4) {
+        return min_scalar(data, n);
+    }
+    __m128i best = _mm_loadu_si128((const __m128i*)data);
+    int i = 4;
+    for (; i + 4 <= n; i += 4) {
+        best = _mm_min_epi32(best, _mm_loadu_si128((const __m128i*)(data + i)));
+    }
+    alignas(16) int lanes[4];
+    _mm_store_si128((__m128i*)lanes, best);
+    int min_value = min_scalar(lanes, 4);
+    for (; i < n; i++) {
+        min_value = std::min(min_value, data[i]);
+    }
+    return min_value;
+}
+
+__attribute__((target("sse4.1"))) inline int max_sse41(const int* data, int n) {
+    if (n < 4) {
+        return max_scalar(data, n);
+    }
+    __m128i best = _mm_loadu_si128((const __m128i*)data);
+    int i = 4;
+    for (; i + 4 <= n; i += 4) {
+        best = _mm_max_epi32(best, _mm_loadu_si128((const __m128i*)(data + i)));
+    }
+    alignas(16) int lanes[4];
+    _mm_store_si128((__m128i*)lanes, best);
+    int max_value = max_scalar(lanes, 4);
+    for (; i < n; i++) {
+        max_value = std::max(max_value, data[i]);
+    }
+    return max_value;
+}
+
+template <bool Smaller>
+__attribute__((target("sse4.1"))) inline int arg_sse41(const int* data, int n) {
+    if (n < 4) {
+        return Smaller ? argmin_scalar(data, n) : argmax_scalar(data, n);
+    }
+    __m128i best = _mm_loadu_si128((const __m128i*)data);
+    __m128i best_index = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i index = best_index;
+    const __m128i step = _mm_set1_epi32(4);
+    int i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+        index = _mm_add_epi32(index, step);
+        __m128i better = Smaller ? _mm_cmpgt_epi32(best, v) : _mm_cmpgt_epi32(v, best);
+        best = _mm_blendv_epi8(best, v, better);
+        best_index = _mm_blendv_epi8(best_index, index, better);
+    }
+    alignas(16) int values[4];
+    alignas(16) int indices[4];
+    _mm_store_si128((__m128i*)values, best);
+    _mm_store_si128((__m128i*)indices, best_index);
+    return reduce_lanes<Smaller>(data, n, i, values, indices, 4);
+}
+
+__attribute__((target("sse4.1"))) inline int argmin_sse41(const int* data, int n) {
+    return arg_sse41<true>(data, n);
+}
+
+__attribute__((target("sse4.1"))) inline int argmax_sse41(const int* data, int n) {
+    return arg_sse41<false>(data, n);
+}
+
+__attribute__((target("sse4.1"))) inline int count_sse41(const int* data, int n, int value) {
+    __m128i needle = _mm_set1_epi32(value);
+    __m128i total = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(data + i)), needle);
+        // Equal lanes are all ones, i.e. -1
+        total = _mm_sub_epi32(total, equal);
+    }
+    alignas(16) int lanes[4];
+    _mm_store_si128((__m128i*)lanes, total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + count_scalar(data + i, n - i, value);
+}
+
+__attribute__((target("avx2"))) inline int min_avx2(const int* data, int n) {
+    if (n < 8) {
+        return min_scalar(data, n);
+    }
+    __m256i best = _mm256_loadu_si256((const __m256i*)data);
+    int i = 8;
+    for (; i + 8 <= n; i += 8) {
+        best = _mm256_min_epi32(best, _mm256_loadu_si256((const __m256i*)(data + i)));
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256((__m256i*)lanes, best);
+    int min_value = min_scalar(lanes, 8);
+    for (; i < n; i++) {
+        min_value = std::min(min_value, data[i]);
+    }
+    return min_value;
+}
+
+__attribute__((target("avx2"))) inline int max_avx2(const int* data, int n) {
+    if (n < 8) {
+        return max_scalar(data, n);
+    }
+    __m256i best = _mm256_loadu_si256((const __m256i*)data);
+    int i = 8;
+    for (; i + 8 <= n; i += 8) {
+        best = _mm256_max_epi32(best, _mm256_loadu_si256((const __m256i*)(data + i)));
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256((__m256i*)lanes, best);
+    int max_value = max_scalar(lanes, 8);
+    for (; i < n; i++) {
+        max_value = std::max(max_value, data[i]);
+    }
+    return max_value;
+}
+
+template <bool Smaller>
+__attribute__((target("avx2"))) inline int arg_avx2(const int* data, int n) {
+    if (n < 8) {
+        return Smaller ? argmin_scalar(data, n) : argmax_scalar(data, n);
+    }
+    __m256i best = _mm256_loadu_si256((const __m256i*)data);
+    __m256i best_index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i index = best_index;
+    const __m256i step = _mm256_set1_epi32(8);
+    int i = 8;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+        index = _mm256_add_epi32(index, step);
+        __m256i better = Smaller ? _mm256_cmpgt_epi32(best, v) : _mm256_cmpgt_epi32(v, best);
+        best = _mm256_blendv_epi8(best, v, better);
+        best_index = _mm256_blendv_epi8(best_index, index, better);
+    }
+    alignas(32) int values[8];
+    alignas(32) int indices[8];
+    _mm256_store_si256((__m256i*)values, best);
+    _mm256_store_si256((__m256i*)indices, best_index);
+    return reduce_lanes<Smaller>(data, n, i, values, indices, 8);
+}
+
+__attribute__((target("avx2"))) inline int argmin_avx2(const int* data, int n) {
+    return arg_avx2<true>(data, n);
+}
+
+__attribute__((target("avx2"))) inline int argmax_avx2(const int* data, int n) {
+    return arg_avx2<false>(data, n);
+}
+
+__attribute__((target("avx2"))) inline int count_avx2(const int* data, int n, int value) {
+    __m256i needle = _mm256_set1_epi32(value);
+    __m256i total = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(data + i)), needle);
+        total = _mm256_sub_epi32(total, equal);
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256((__m256i*)lanes, total);
+    int count = 0;
+    for (int lane = 0; lane < 8; lane++) {
+        count += lanes[lane];
+    }
+    return count + count_scalar(data + i, n - i, value);
+}
+
+// GCC 12's avx512fintrin.h starts the results of _mm512_min_epi32 and
+// friends from an undefined vector, which -Wmaybe-uninitialized then reports
+// once they are inlined here; the values are never read
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+__attribute__((target("avx512f"))) inline int min_avx512(const int* data, int n) {
+    if (n < 16) {
+        return min_scalar(data, n);
+    }
+    __m512i best = _mm512_loadu_si512(data);
+    int i = 16;
+    for (; i + 16 <= n; i += 16) {
+        best = _mm512_min_epi32(best, _mm512_loadu_si512(data + i));
+    }
+    int min_value = _mm512_reduce_min_epi32(best);
+    for (; i < n; i++) {
+        min_value = std::min(min_value, data[i]);
+    }
+    return min_value;
+}
+
+__attribute__((target("avx512f"))) inline int max_avx512(const int* data, int n) {
+    if (n < 16) {
+        return max_scalar(data, n);
+    }
+    __m512i best = _mm512_loadu_si512(data);
+    int i = 16;
+    for (; i + 16 <= n; i += 16) {
+        best = _mm512_max_epi32(best, _mm512_loadu_si512(data + i));
+    }
+    int max_value = _mm512_reduce_max_epi32(best);
+    for (; i < n; i++) {
+        max_value = std::max(max_value, data[i]);
+    }
+    return max_value;
+}
+
+template <bool Smaller>
+__attribute__((target("avx512f"))) inline int arg_avx512(const int* data, int n) {
+    if (n < 16) {
+        return Smaller ? argmin_scalar(data, n) : argmax_scalar(data, n);
+    }
+    __m512i best = _mm512_loadu_si512(data);
+    __m512i best_index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512i index = best_index;
+    const __m512i step = _mm512_set1_epi32(16);
+    int i = 16;
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_loadu_si512(data + i);
+        index = _mm512_add_epi32(index, step);
+        __mmask16 better = Smaller ? _mm512_cmplt_epi32_mask(v, best) : _mm512_cmpgt_epi32_mask(v, best);
+        best = _mm512_mask_mov_epi32(best, better, v);
+        best_index = _mm512_mask_mov_epi32(best_index, better, index);
+    }
+    alignas(64) int values[16];
+    alignas(64) int indices[16];
+    _mm512_store_si512(values, best);
+    _mm512_store_si512(indices, best_index);
+    return reduce_lanes<Smaller>(data, n, i, values, indices, 16);
+}
+
+__attribute__((target("avx512f"))) inline int argmin_avx512(const int* data, int n) {
+    return arg_avx512<true>(data, n);
+}
+
+__attribute__((target("avx512f"))) inline int argmax_avx512(const int* data, int n) {
+    return arg_avx512<false>(data, n);
+}
+
+__attribute__((target("avx512f"))) inline int count_avx512(const int* data, int n, int value) {
+    __m512i needle = _mm512_set1_epi32(value);
+    int count = 0;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        count += __builtin_popcount(_mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i), needle));
+    }
+    return count + count_scalar(data + i, n - i, value);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+// Check whether this CPU can run the kernels of the given instruction set
+inline bool supported(Isa isa) {
+#ifdef ARRAY_LIST_SIMD
+    switch (isa) {
+    case Isa::sse41:
+        return __builtin_cpu_supports("sse4.1");
+    case Isa::avx2:
+        return __builtin_cpu_supports("avx2");
+    case Isa::avx512:
+        return __builtin_cpu_supports("avx512f");
+    default:
+        return true;
+    }
+#else
+    return isa == Isa::scalar;
+#endif
+}
+
+inline const char* isa_name(Isa isa) {
+    switch (isa) {
+    case Isa::sse41:
+        return "sse4.1";
+    case Isa::avx2:
+        return "avx2";
+    case Isa::avx512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+// The best instruction set this CPU supports
+inline Isa detect_isa() {
+    for (Isa isa : {Isa::avx512, Isa::avx2, Isa::sse41}) {
+        if (supported(isa)) {
+            return isa;
+        }
+    }
+    return Isa::scalar;
+}
+
+/**
+ * @brief Get the kernels of an instruction set.
+ * Throws a runtime error if the CPU does not support it.
+ *
+ * @param isa The instruction set
+ * @return Kernels The function table
+ */
+inline Kernels kernels_for(Isa isa) {
+    if (!supported(isa)) {
+        throw std::runtime_error(std::string("CPU does not support ") + isa_name(isa));
+    }
+    switch (isa) {
+#ifdef ARRAY_LIST_SIMD
+    case Isa::sse41:
+        return Kernels{min_sse41, max_sse41, argmin_sse41, argmax_sse41, count_sse41};
+    case Isa::avx2:
+        return Kernels{min_avx2, max_avx2, argmin_avx2, argmax_avx2, count_avx2};
+    case Isa::avx512:
+        return Kernels{min_avx512, max_avx512, argmin_avx512, argmax_avx512, count_avx512};
+#endif
+    default:
+        return Kernels{min_scalar, max_scalar, argmin_scalar, argmax_scalar, count_scalar};
+    }
+}
+
+// The kernels for the best instruction set, detected once
+inline const Kernels& kernels() {
+    static const Kernels best = kernels_for(detect_isa());
+    return best;
+}
+
+} // namespace simd
+
+/**
+ * @brief Scans over n > 0 contiguous elements (count also takes n == 0),
+ * shared by the containers in this file. int buffers go through the
+ * dispatched simd kernels.
+ */
+namespace reduce {
+
+template <typename T>
+T max_of(const T* data, int n) {
+    if constexpr (std::is_same<T, int>::value) {
+        return simd::kernels().max(data, n);
+    }
+
+    T max_value = data[0];
+
+    for (int i = 1; i < n; i++) {
+        if (data[i] > max_value) {
+            max_value = data[i];
+        }
+    }
+
+    return max_value;
+}
+
+template <typename T>
+T min_of(const T* data, int n) {
+    if constexpr (std::is_same<T, int>::value) {
+        return simd::kernels().min(data, n);
+    }
+
+    T min_value = data[0];
+
+    for (int i = 1; i < n; i++) {
+        if (data[i] < min_value) {
+            min_value = data[i];
+        }
+    }
+
+    return min_value;
+}
+
+template <typename T>
+int argmax_of(const T* data, int n) {
+    if constexpr (std::is_same<T, int>::value) {
+        return simd::kernels().argmax(data, n);
+    }
+
+    T max_value = data[0];
+    int max_index = 0;
+
+    for (int i = 1; i < n; i++) {
+        if (data[i] > max_value) {
+            max_value = data[i];
+            max_index = i;
+        }
+    }
+
+    return max_index;
+}
+
+template <typename T>
+int argmin_of(const T* data, int n) {
+    if constexpr (std::is_same<T, int>::value) {
+        return simd::kernels().argmin(data, n);
+    }
+
+    T min_value = data[0];
+    int min_index = 0;
+
+    for (int i = 1; i < n; i++) {
+        if (data[i] < min_value) {
+            min_value = data[i];
+            min_index = i;
+        }
+    }
+
+    return min_index;
+}
+
+template <typename T>
+int count_of(const T* data, int n, const T& value) {
+    if constexpr (std::is_same<T, int>::value) {
+        return simd::kernels().count(data, n, value);
+    }
+
+    int count = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (data[i] == value) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+} // namespace reduce
+
+/**
+ * @brief A fixed set of worker threads that run the chunks of parallel scans.
+ *
+ * run() hands out task indices to the workers and to the calling thread and
+ * returns once every task is done. One job runs at a time, so a task must not
+ * call run() itself.
+ */
+class ThreadPool {
+private:
+    // One call to run(). Lives on the caller's stack until every worker that
+    // picked it up has let go of it.
+    struct Job {
+        const std::function<void(int)>* task;
+        int tasks;
+        std::atomic<int> next{0};
+        int finished = 0;
+        int active = 0;
+    };
+
+    std::vector<std::thread> _workers;
+    std::mutex _run_mutex;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    Job* _job = nullptr;
+    long _generation = 0;
+    bool _stop = false;
+
+    // Run tasks of the job until there are none left, returning how many ran
+    static int drain(Job& job) {
+        int done = 0;
+        for (int i = job.next++; i < job.tasks; i = job.next++) {
+            (*job.task)(i);
+            done++;
+        }
+        return done;
+    }
+
+    void work() {
+        long seen = 0;
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _wake.wait(lock, [&] { return _stop || (_job != nullptr && _generation != seen); });
+            if (_stop) {
+                return;
+            }
+            seen = _generation;
+            Job* job = _job;
+            job->active++;
+
+            lock.unlock();
+            int done = drain(*job);
+            lock.lock();
+
+            job->finished += done;
+            job->active--;
+            if (job->finished == job->tasks && job->active == 0) {
+                _done.notify_all();
+            }
+        }
+    }
+
+public:
+    // Start a pool where run() uses the given number of threads, the caller included
+    explicit ThreadPool(int threads) {
+        for (int i = 1; i < threads; i++) {
+            _workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (std::thread& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads taking part in run(), the caller included
+    int size() {
+        return _workers.size() + 1;
+    }
+
+    /**
+     * @brief Run task(i) for every i in [0, tasks) and wait for all of them.
+     * A single task runs directly on the calling thread.
+     *
+     * @param tasks The number of tasks
+     * @param task The function to run for each task index
+     */
+    void run(int tasks, const std::function<void(int)>& task) {
+        if (tasks <= 0) {
+            return;
+        }
+        if (tasks == 1 || _workers.empty()) {
+            for (int i = 0; i < tasks; i++) {
+                task(i);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> run_lock(_run_mutex);
+        Job job;
+        job.task = &task;
+        job.tasks = tasks;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _job = &job;
+            _generation++;
+        }
+        _wake.notify_all();
+
+        int done = drain(job);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        job.finished += done;
+        _done.wait(lock, [&] { return job.finished == job.tasks && job.active == 0; });
+        _job = nullptr;
+    }
+
+    // The shared pool with one thread per hardware thread
+    static ThreadPool& instance() {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+        return pool;
+    }
+};
+
+/**
+ * @brief How to split a scan over an ArrayList between threads.
+ *
+ * The list is cut into at most threads chunks of at least min_chunk elements,
+ * so lists shorter than 2 * min_chunk are scanned serially by the caller.
+ * Partial results are always combined in chunk order, which makes the result
+ * independent of how the threads were scheduled.
+ */
+struct ParallelPolicy {
+    // Number of threads to use, 0 means every thread in the pool
+    int threads = 0;
+    // Smallest number of elements worth handing to a thread
+    int min_chunk = 1 << 16;
+    // Pool to run on, nullptr means the shared ThreadPool::instance()
+    ThreadPool* pool = nullptr;
+
+    ThreadPool& thread_pool() {
+        return pool != nullptr ? *pool : ThreadPool::instance();
+    }
+
+    // Number of chunks to split n elements into. Short lists are decided
+    // before looking at the pool, so they never start the shared one.
+    int chunks(int n) {
+        if (n / std::max(min_chunk, 1) < 2) {
+            return 1;
+        }
+        int pool_threads = thread_pool().size();
+        int max_threads = threads > 0 ? std::min(threads, pool_threads) : pool_threads;
+        return std::max(1, std::min(max_threads, n / std::max(min_chunk, 1)));
+    }
+};
+
+// Uninitialized room for the first N elements of a list, inside the list itself
+template <typename T, int N>
+struct InlineStorage {
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+
+    T* data() {
+        return reinterpret_cast<T*>(bytes);
+    }
+};
+
+template <typename T>
+struct InlineStorage<T, 0> {
+    T* data() {
+        return nullptr;
+    }
+};
+
+/**
+ * @brief Dynamic array of T.
+ *
+ * The first InlineCapacity elements are stored inside the list object, and
+ * the buffer only moves to the heap once they overflow. Without inline
+ * storage an empty list has no buffer at all; it is allocated on the first
+ * append.
+ */
+template <typename T = int, typename Allocator = std::allocator<T>, int InlineCapacity = 0>
 class ArrayList {
+public:
+    // The elements are contiguous, so plain pointers are random-access iterators
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    // Trivially copyable elements can be moved around with memcpy/memmove,
+    // everything else has to be move-constructed one element at a time.
+    static constexpr bool bitwise_movable = std::is_trivially_copyable<T>::value;
+    // Moving a list only moves elements one by one when they are inline
+    static constexpr bool nothrow_move = InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value;
+
+    Allocator _alloc;
+    GrowthPolicy _policy;
+    InlineStorage<T, InlineCapacity> _inline;
+    T* _data = _inline.data();
+    int _capacity = InlineCapacity;
+    int _size = 0;
+    // Owns the buffer when it was adopted from a std::vector
+    std::unique_ptr<std::vector<T>> _owner;
+
+    // Check if the elements live in a heap buffer
+    bool on_heap() {
+        return _data != nullptr && _data != _inline.data();
+    }
+
+    // Give the heap buffer back, if there is one
+    void release_buffer() {
+        if (_owner) {
+            _owner.reset();
+        } else if (on_heap()) {
+            alloc_traits::deallocate(_alloc, _data, _capacity);
+        }
+    }
+
+    // Destroy the elements, free the buffer and go back to an empty list
+    void clear_storage() {
+        destroy_elements(_size);
+        release_buffer();
+        _data = _inline.data();
+        _capacity = InlineCapacity;
+        _size = 0;
+    }
+
+    // Copy n elements into the (empty) buffer, which must have room for them
+    void copy_from(const T* src, int n) {
+        if constexpr (bitwise_movable) {
+            if (n > 0) {
+                std::memcpy(static_cast<void*>(_data), static_cast<const void*>(src), n * sizeof(T));
+            }
+        } else {
+            for (int i = 0; i < n; i++) {
+                alloc_traits::construct(_alloc, _data + i, src[i]);
+            }
+        }
+        _size = n;
+    }
+
+    // Take over the elements of an empty-handed other list: its heap buffer
+    // is stolen in O(1), inline elements are moved one by one. Without inline
+    // storage a list off the heap is empty, and its data may be null.
+    void take(ArrayList& other) {
+        if (other._owner || other.on_heap()) {
+            _data = other._data;
+            _capacity = other._capacity;
+            _owner = std::move(other._owner);
+        } else if constexpr (InlineCapacity > 0) {
+            relocate(_data, other._data, other._size);
+        }
+        _size = other._size;
+
+        other._data = other._inline.data();
+        other._capacity = InlineCapacity;
+        other._size = 0;
+    }
+
+    // Move n elements from src into the uninitialized memory at dst
+    void relocate(T* dst, T* src, int n) {
+        if constexpr (bitwise_movable) {
+            if (n > 0) {
+                std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+            }
+        } else {
+            for (int i = 0; i < n; i++) {
+                alloc_traits::construct(_alloc, dst + i, std::move(src[i]));
+                alloc_traits::destroy(_alloc, src + i);
+            }
+        }
+    }
+
+    // Destroy the n first elements of the buffer
+    void destroy_elements(int n) {
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            for (int i = 0; i < n; i++) {
+                alloc_traits::destroy(_alloc, _data + i);
+            }
+        }
+    }
+
+    // Move the elements over to a new buffer with the given capacity, which
+    // is the inline storage if they fit there
+    void reallocate(int new_capacity) {
+        T* new_data;
+        if (new_capacity <= InlineCapacity) {
+            new_data = _inline.data();
+            new_capacity = InlineCapacity;
+        } else {
+            new_data = alloc_traits::allocate(_alloc, new_capacity);
+        }
+
+        relocate(new_data, _data, _size);
+        release_buffer();
+
+        _data = new_data;
+        _capacity = new_capacity;
+    }
+
+    // Open a hole at index by moving [index, _size) one slot to the right.
+    // The slot at index is left holding a (moved-from) live element unless
+    // index == _size. Requires _size < _capacity.
+    void shift_right(int index) {
+        if constexpr (bitwise_movable) {
+            std::memmove(static_cast<void*>(_data + index + 1), static_cast<const void*>(_data + index),
+                         (_size - index) * sizeof(T));
+        } else if (index < _size) {
+            alloc_traits::construct(_alloc, _data + _size, std::move(_data[_size - 1]));
+            std::move_backward(_data + index, _data + _size - 1, _data + _size);
+        }
+    }
+
+    // Close the slot at index by moving (index, _size) one slot to the left
+    // and destroying the element that ends up past the end.
+    void shift_left(int index) {
+        if constexpr (bitwise_movable) {
+            std::memmove(static_cast<void*>(_data + index), static_cast<const void*>(_data + index + 1),
+                         (_size - index - 1) * sizeof(T));
+        } else {
+            std::move(_data + index + 1, _data + _size, _data + index);
+            alloc_traits::destroy(_alloc, _data + _size - 1);
+        }
+    }
+
+    // Method for increasing the capacity of the array
+    void resize() {
+        if (_capacity == 0) {
+            // First allocation of a list without inline storage
+            reallocate(std::max(_policy.min_capacity, 1));
+        } else {
+            reallocate(next_capacity(_capacity));
+        }
+    }
+
+    // The capacity after capacity on the growth ladder, always strictly larger
+    int next_capacity(int capacity) {
+        return std::max(capacity + 1, _policy.grow(capacity));
+    }
+
+    // Check if less of the capacity than the policy allows is used
+    bool should_shrink() {
+        return !_policy.never_shrink && _capacity > _policy.min_capacity
+            && _size < _policy.shrink_threshold * _capacity;
+    }
+
+    void shrink_to_fit() {
+        int new_capacity = std::max(_policy.min_capacity, 1);
+
+        while (new_capacity < _size * _policy.shrink_headroom) {
+            new_capacity = next_capacity(new_capacity);
+        }
+
+        if (std::max(new_capacity, InlineCapacity) >= _capacity) {
+            // No need to reduce, the capacity is already suitable.
+            return;
+        }
+
+        reallocate(new_capacity);
+    }
+
+    // Cut the buffer into chunks of almost equal size, run scan(data, n) on
+    // each of them in the thread pool and return the results in chunk order.
+    // A single chunk is scanned by the caller without touching the pool.
+    template <typename Result, typename Scan>
+    std::unique_ptr<Result[]> scan_chunks(ParallelPolicy& policy, int chunks, Scan scan) {
+        std::unique_ptr<Result[]> partial(new Result[chunks]);
+        if (chunks == 1) {
+            partial[0] = scan(_data, _size);
+            return partial;
+        }
+        int chunk_size = _size / chunks;
+        int remainder = _size % chunks;
+
+        policy.thread_pool().run(chunks, [&](int chunk) {
+            int begin = chunk * chunk_size + std::min(chunk, remainder);
+            int n = chunk_size + (chunk < remainder ? 1 : 0);
+            partial[chunk] = scan(_data + begin, n);
+        });
+        return partial;
+    }
+
+public:
+    // Default constructor
+    ArrayList() {
+    }
+
+    // Constructor for an empty list with a given growth policy. It is a
+    // template so that a braced list like {0, 1} never converts to a policy.
+    template <typename Policy, typename = std::enable_if_t<std::is_same<Policy, GrowthPolicy>::value>>
+    explicit ArrayList(Policy policy) : _policy(policy) {
+    }
+
+    // Constructor for a list of values
+    ArrayList(std::vector<T> values, GrowthPolicy policy = GrowthPolicy{}) : _policy(policy) {
+        _size = values.size();
+
+        // Allocate memory to match the input size, unless it fits inline
+        if (_size > InlineCapacity) {
+            _capacity = std::max(_size, _policy.min_capacity);
+            _data = alloc_traits::allocate(_alloc, _capacity);
+        }
+
+        // Copy elements from the vector
+        if constexpr (bitwise_movable) {
+            if (_size > 0) {
+                std::memcpy(static_cast<void*>(_data), static_cast<const void*>(values.data()), _size * sizeof(T));
+            }
+        } else {
+            for (int i = 0; i < _size; i++) {
+                alloc_traits::construct(_alloc, _data + i, std::move(values[i]));
+            }
+        }
+    }
+
+    // Copy constructor, trivially copyable elements are copied with one memcpy
+    ArrayList(const ArrayList& other)
+        : _alloc(alloc_traits::select_on_container_copy_construction(other._alloc)), _policy(other._policy) {
+        if (other._size > InlineCapacity) {
+            _capacity = std::max(other._size, _policy.min_capacity);
+            _data = alloc_traits::allocate(_alloc, _capacity);
+        }
+        copy_from(other._data, other._size);
+    }
+
+    // Move constructor, takes over the other list's buffer in O(1) and leaves
+    // it empty. Inline elements are moved one by one.
+    ArrayList(ArrayList&& other) noexcept(nothrow_move) : _alloc(std::move(other._alloc)), _policy(other._policy) {
+        take(other);
+    }
+
+    // Destructor
+    ~ArrayList() {
+        destroy_elements(_size);
+        release_buffer();
+    }
+
+    ArrayList& operator=(const ArrayList& other) {
+        if (this != &other) {
+            ArrayList copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    ArrayList& operator=(ArrayList&& other) noexcept(nothrow_move) {
+        if (this != &other) {
+            clear_storage();
+            _alloc = std::move(other._alloc);
+            _policy = other._policy;
+            take(other);
+        }
+        return *this;
+    }
+
+    // Exchange the contents of two lists, O(1) unless they use inline storage
+    void swap(ArrayList& other) noexcept(nothrow_move) {
+        ArrayList tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    /**
+     * @brief Make a list that takes over the buffer of a vector instead of
+     * copying it. Trivially copyable elements stay where they are and the
+     * whole capacity of the vector is used; other element types are moved
+     * into a new buffer.
+     *
+     * @param values The vector to take the buffer from
+     * @return ArrayList The list
+     */
+    static ArrayList adopt(std::vector<T>&& values) {
+        ArrayList list;
+        if constexpr (bitwise_movable && std::is_trivially_destructible<T>::value) {
+            if (values.capacity() > 0) {
+                list._owner.reset(new std::vector<T>(std::move(values)));
+                list._data = list._owner->data();
+                list._size = list._owner->size();
+                list._capacity = list._owner->capacity();
+            }
+        } else {
+            list = ArrayList(std::move(values));
+        }
+        return list;
+    }
+
+    /**
+     * @brief Make a list that takes ownership of a raw buffer.
+     *
+     * @param data Buffer from Allocator::allocate(capacity)
+     * @param size Number of constructed elements at the start of the buffer
+     * @param capacity Number of elements the buffer has room for
+     * @return ArrayList The list
+     */
+    static ArrayList adopt(T* data, int size, int capacity) {
+        if (size < 0 || size > capacity) {
+            throw std::invalid_argument("Size must be between 0 and the capacity");
+        }
+        ArrayList list;
+        if (data != nullptr) {
+            list._data = data;
+            list._size = size;
+            list._capacity = capacity;
+        }
+        return list;
+    }
+
+    // Length of array
+    // Get the current size of the array
+    int length() {
+        return _size;
+    }
+
+    // Retrieve the array's maximum capacity
+    int capacity() {
+        return _capacity;
+    }
+
+    // The policy used when growing and shrinking the buffer
+    GrowthPolicy growth_policy() {
+        return _policy;
+    }
+
+    /**
+     * @brief Change the growth policy. It takes effect the next time the
+     * buffer grows or shrinks.
+     *
+     * @param policy The new policy
+     */
+    void set_growth_policy(GrowthPolicy policy) {
+        _policy = policy;
+    }
+
+    // Check if the elements are stored inside the list object
+    bool is_inline() {
+        return InlineCapacity > 0 && _data == _inline.data();
+    }
+
+    // Iterators over the elements. Any insertion or removal may move the
+    // elements and invalidate them.
+    iterator begin() {
+        return _data;
+    }
+
+    iterator end() {
+        return _data + _size;
+    }
+
+    const_iterator begin() const {
+        return _data;
+    }
+
+    const_iterator end() const {
+        return _data + _size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param n The value to be appended
+     */
+    void append(T value) {
+        if (_size >= _capacity) {
+            resize();
+        }
+
+        alloc_traits::construct(_alloc, _data + _size, std::move(value));
+        _size++;
+    }
+
+    /**
+     * @brief Get value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T The value at that index
+     */
+    T get(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+        return _data[index];
+    }
+
+    /**
+     * @brief Prints the array
+     *
+     */
+    void print() {
+        std::cout << "[";
+        for (int i = 0; i < _size - 1; i++) {
+            std::cout << _data[i] << ", ";
+        }
+        if (_size > 0) {
+            std::cout << _data[_size - 1];
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get a reference to the value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T& The value at that index
+     */
+    T &operator[](int index) {
+        if (index < 0 || index >= _size) {
+            throw std::range_error("Index is out of bounds");
+        }
+        return _data[index];
+    }
+
+    /**
+     * @brief get a value and an index.
+     * throw an error if the index is out of bounds
+     *
+     * increase size by 1
+     *
+     * move values to the right of the index by one index up.
+     *
+     * @param val the value
+     * @param index the index
+     *
+     */
+    void insert(T value, int index) {
+        if (index < 0 || index > _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        if (_size >= _capacity) {
+            resize();
+        }
+
+        if (index == _size) {
+            append(std::move(value));
+        } else {
+            shift_right(index);
+            if constexpr (bitwise_movable) {
+                alloc_traits::construct(_alloc, _data + index, std::move(value));
+            } else {
+                _data[index] = std::move(value);
+            }
+            _size++;
+        }
+    }
+
+    /**
+     * @brief Insert a value in front of the element an iterator points to
+     *
+     * @param position The iterator, end() to append
+     * @param value The value
+     * @return iterator The inserted element
+     */
+    iterator insert_before(iterator position, T value) {
+        int index = position - _data;
+        insert(std::move(value), index);
+        return _data + index;
+    }
+
+    /**
+     * @brief Remove the element an iterator points to
+     *
+     * @param position The iterator
+     * @return iterator The element after the removed one
+     */
+    iterator erase(iterator position) {
+        int index = position - _data;
+        remove(index);
+        return _data + index;
+    }
+
+    /**
+     * @brief Remove the elements in [first, last) with a single shift of the
+     * elements after them, e.g. after std::remove_if
+     *
+     * @param first The first element to remove
+     * @param last The element after the last one to remove
+     * @return iterator The element after the removed ones
+     */
+    iterator erase(iterator first, iterator last) {
+        int index = first - _data;
+        int count = last - first;
+        if (index < 0 || count < 0 || index + count > _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+        if (count == 0) {
+            return first;
+        }
+
+        if constexpr (bitwise_movable) {
+            std::memmove(static_cast<void*>(first), static_cast<const void*>(last),
+                         (_size - index - count) * sizeof(T));
+        } else {
+            std::move(last, end(), first);
+            for (int i = _size - count; i < _size; i++) {
+                alloc_traits::destroy(_alloc, _data + i);
+            }
+        }
+        _size -= count;
+
+        if (should_shrink()) {
+            shrink_to_fit();
+        }
+        return _data + index;
+    }
+
+    /**
+     * @brief deletes the element from the list.
+     *
+     * @param index the index
+     *
+     */
+    void remove(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        shift_left(index);
+        _size--;
+
+        // Check if the array can be resized to fit if less of the allocated capacity is used than the policy allows
+        if (should_shrink()) {
+            shrink_to_fit();
+        }
+    }
+
+    /***
+     * @brief removing an element at a given index
+     *
+     * @param index
+     * @return T the value at that index
+     */
+
+    T pop(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        T old_value = std::move(_data[index]);
+
+        // Move the elements to fill the gap left by the removed element
+        shift_left(index);
+        _size--;
+
+        // Check if the array can be resized to fit if less of the allocated capacity is used than the policy allows
+        if (should_shrink()) {
+            shrink_to_fit();
+        }
+
+        return old_value;
+    }
+
+    /**
+     * @brief removing the last element in the list
+     *
+     * @return T the last element
+     */
+    T pop() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot pop");
+        }
+
+        T old_value = std::move(_data[_size - 1]);
+        alloc_traits::destroy(_alloc, _data + _size - 1);
+        _size--;
+
+        // Check if the array can be resized to fit if less of the allocated capacity is used than the policy allows
+        if (should_shrink()) {
+            shrink_to_fit();
+        }
+
+        return old_value;
+    }
+
+    T max() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find max");
+        }
+
+        return reduce::max_of(_data, _size);
+    }
+
+    T min() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find min");
+        }
+
+        return reduce::min_of(_data, _size);
+    }
+
+    int argmax() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmax");
+        }
+
+        return reduce::argmax_of(_data, _size);
+    }
+
+    int argmin() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmin");
+        }
+
+        return reduce::argmin_of(_data, _size);
+    }
+
+    int count(const T& value) {
+        return reduce::count_of(_data, _size, value);
+    }
+
+    /**
+     * @brief Find the largest value with the work split between threads
+     *
+     * @param policy How to split the list into chunks
+     * @return T The largest value
+     */
+    T max(ParallelPolicy policy) {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find max");
+        }
+
+        int chunks = policy.chunks(_size);
+        std::unique_ptr<T[]> partial = scan_chunks<T>(policy, chunks, [](const T* data, int n) { return reduce::max_of(data, n); });
+        return reduce::max_of(partial.get(), chunks);
+    }
+
+    /**
+     * @brief Find the smallest value with the work split between threads
+     *
+     * @param policy How to split the list into chunks
+     * @return T The smallest value
+     */
+    T min(ParallelPolicy policy) {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find min");
+        }
+
+        int chunks = policy.chunks(_size);
+        std::unique_ptr<T[]> partial = scan_chunks<T>(policy, chunks, [](const T* data, int n) { return reduce::min_of(data, n); });
+        return reduce::min_of(partial.get(), chunks);
+    }
+
+    /**
+     * @brief Find the first index of the largest value with the work split
+     * between threads
+     *
+     * @param policy How to split the list into chunks
+     * @return int The index
+     */
+    int argmax(ParallelPolicy policy) {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmax");
+        }
+
+        int chunks = policy.chunks(_size);
+        std::unique_ptr<int[]> partial = scan_chunks<int>(policy, chunks, [this](const T* data, int n) {
+            return (int)(data - _data) + reduce::argmax_of(data, n);
+        });
+
+        // Earlier chunks win ties
+        int max_index = partial[0];
+        for (int chunk = 1; chunk < chunks; chunk++) {
+            if (_data[partial[chunk]] > _data[max_index]) {
+                max_index = partial[chunk];
+            }
+        }
+        return max_index;
+    }
+
+    /**
+     * @brief Find the first index of the smallest value with the work split
+     * between threads
+     *
+     * @param policy How to split the list into chunks
+     * @return int The index
+     */
+    int argmin(ParallelPolicy policy) {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmin");
+        }
+
+        int chunks = policy.chunks(_size);
+        std::unique_ptr<int[]> partial = scan_chunks<int>(policy, chunks, [this](const T* data, int n) {
+            return (int)(data - _data) + reduce::argmin_of(data, n);
+        });
+
+        // Earlier chunks win ties
+        int min_index = partial[0];
+        for (int chunk = 1; chunk < chunks; chunk++) {
+            if (_data[partial[chunk]] < _data[min_index]) {
+                min_index = partial[chunk];
+            }
+        }
+        return min_index;
+    }
+
+    /**
+     * @brief Count the occurrences of a value with the work split between
+     * threads
+     *
+     * @param value The value to count
+     * @param policy How to split the list into chunks
+     * @return int The number of occurrences
+     */
+    int count(const T& value, ParallelPolicy policy) {
+        int chunks = policy.chunks(_size);
+        std::unique_ptr<int[]> partial = scan_chunks<int>(policy, chunks, [&value](const T* data, int n) {
+            return reduce::count_of(data, n, value);
+        });
+
+        int count = 0;
+        for (int chunk = 0; chunk < chunks; chunk++) {
+            count += partial[chunk];
+        }
+        return count;
+    }
+};
+
+
+/**
+ * @brief ArrayList variant that keeps its elements in a ring buffer.
+ *
+ * The elements start at a movable head offset and wrap around the end of the
+ * buffer, so adding or removing at the front is O(1) amortized just like at
+ * the back, while indexing stays O(1). Inserting or removing in the middle
+ * moves whichever side of the index is shorter. The capacity is always a
+ * power of two so that wrapping an index is a single mask.
+ */
+template <typename T = int, typename Allocator = std::allocator<T>>
+class CircularArrayList {
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    static constexpr bool bitwise_movable = std::is_trivially_copyable<T>::value;
+
+    Allocator _alloc;
+    T* _data;
+    int _capacity = 1;
+    int _head = 0;
+    int _size = 0;
+
+    // Position in the buffer of the element at the given index
+    int slot(int index) {
+        return (_head + index) & (_capacity - 1);
+    }
+
+    // Move n elements from src into the uninitialized memory at dst
+    void relocate(T* dst, T* src, int n) {
+        if constexpr (bitwise_movable) {
+            if (n > 0) {
+                std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+            }
+        } else {
+            for (int i = 0; i < n; i++) {
+                alloc_traits::construct(_alloc, dst + i, std::move(src[i]));
+                alloc_traits::destroy(_alloc, src + i);
+            }
+        }
+    }
+
+    // Move the elements to a new buffer with the given capacity, unwrapping
+    // them so that the head ends up at the start of the buffer
+    void reallocate(int new_capacity) {
+        T* new_data = alloc_traits::allocate(_alloc, new_capacity);
+
+        int first = std::min(_size, _capacity - _head);
+        relocate(new_data, _data + _head, first);
+        relocate(new_data + first, _data, _size - first);
+        alloc_traits::deallocate(_alloc, _data, _capacity);
+
+        _data = new_data;
+        _capacity = new_capacity;
+        _head = 0;
+    }
+
+    // Method for increasing the capacity of the array
+    void resize() {
+        reallocate(_capacity * 2);
+    }
+
+    void shrink_to_fit() {
+        int new_capacity = 1;
+
+        while (new_capacity < _size) {
+            new_capacity *= 2;
+        }
+
+        if (new_capacity == _capacity) {
+            // No need to reduce, the capacity is already suitable.
+            return;
+        }
+
+        reallocate(new_capacity);
+    }
+
+    // The elements as at most two contiguous runs: [_data + _head, first) and
+    // [_data, _size - first)
+    int first_run() {
+        return std::min(_size, _capacity - _head);
+    }
+
+public:
+    // Default constructor
+    CircularArrayList() {
+        _data = alloc_traits::allocate(_alloc, _capacity);
+    }
+
+    // Constructor for a list of values
+    CircularArrayList(std::vector<T> values) {
+        while (_capacity < (int)values.size()) {
+            _capacity *= 2;
+        }
+        _data = alloc_traits::allocate(_alloc, _capacity);
+        for (T& value : values) {
+            alloc_traits::construct(_alloc, _data + _size, std::move(value));
+            _size++;
+        }
+    }
+
+    // Destructor
+    ~CircularArrayList() {
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            for (int i = 0; i < _size; i++) {
+                alloc_traits::destroy(_alloc, _data + slot(i));
+            }
+        }
+        alloc_traits::deallocate(_alloc, _data, _capacity);
+    }
+
+    CircularArrayList(const CircularArrayList&) = delete;
+    CircularArrayList& operator=(const CircularArrayList&) = delete;
+
+    // Get the current size of the array
+    int length() {
+        return _size;
+    }
+
+    // Retrieve the array's maximum capacity
+    int capacity() {
+        return _capacity;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param value The value to be appended
+     */
+    void append(T value) {
+        if (_size >= _capacity) {
+            resize();
+        }
+
+        alloc_traits::construct(_alloc, _data + slot(_size), std::move(value));
+        _size++;
+    }
+
+    /**
+     * @brief Add element to the beginning of the list
+     *
+     * @param value The value to be added
+     */
+    void push_front(T value) {
+        if (_size >= _capacity) {
+            resize();
+        }
+
+        _head = (_head - 1) & (_capacity - 1);
+        alloc_traits::construct(_alloc, _data + _head, std::move(value));
+        _size++;
+    }
+
+    /**
+     * @brief Get value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T The value at that index
+     */
+    T get(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+        return _data[slot(index)];
+    }
+
+    /**
+     * @brief Prints the array
+     *
+     */
+    void print() {
+        std::cout << "[";
+        for (int i = 0; i < _size; i++) {
+            std::cout << _data[slot(i)];
+            if (i < _size - 1) {
+                std::cout << ", ";
+            }
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get a reference to the value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T& The value at that index
+     */
+    T &operator[](int index) {
+        if (index < 0 || index >= _size) {
+            throw std::range_error("Index is out of bounds");
+        }
+        return _data[slot(index)];
+    }
+
+    /**
+     * @brief Insert a value before the given index, moving the shorter side
+     * of the list one step out of the way.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param value the value
+     * @param index the index
+     */
+    void insert(T value, int index) {
+        if (index < 0 || index > _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        if (index == 0) {
+            push_front(std::move(value));
+            return;
+        }
+        if (index == _size) {
+            append(std::move(value));
+            return;
+        }
+
+        if (_size >= _capacity) {
+            resize();
+        }
+
+        if (index < _size / 2) {
+            // Move the elements before index one step towards the front
+            int new_head = (_head - 1) & (_capacity - 1);
+            alloc_traits::construct(_alloc, _data + new_head, std::move(_data[_head]));
+            for (int i = 0; i < index - 1; i++) {
+                _data[slot(i)] = std::move(_data[slot(i + 1)]);
+            }
+            _data[slot(index - 1)] = std::move(value);
+            _head = new_head;
+        } else {
+            // Move the elements from index one step towards the back
+            alloc_traits::construct(_alloc, _data + slot(_size), std::move(_data[slot(_size - 1)]));
+            for (int i = _size - 1; i > index; i--) {
+                _data[slot(i)] = std::move(_data[slot(i - 1)]);
+            }
+            _data[slot(index)] = std::move(value);
+        }
+        _size++;
+    }
+
+    /**
+     * @brief deletes the element from the list, closing the gap from the
+     * shorter side.
+     *
+     * @param index the index
+     */
+    void remove(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        if (index < _size / 2) {
+            for (int i = index; i > 0; i--) {
+                _data[slot(i)] = std::move(_data[slot(i - 1)]);
+            }
+            alloc_traits::destroy(_alloc, _data + _head);
+            _head = (_head + 1) & (_capacity - 1);
+        } else {
+            for (int i = index; i < _size - 1; i++) {
+                _data[slot(i)] = std::move(_data[slot(i + 1)]);
+            }
+            alloc_traits::destroy(_alloc, _data + slot(_size - 1));
+        }
+        _size--;
+
+        // Check if the array can be resized to fit if less than 25% of the allocated capacity is used
+        if (_size < 0.25 * _capacity) {
+            shrink_to_fit();
+        }
+    }
+
+    /***
+     * @brief removing an element at a given index
+     *
+     * @param index
+     * @return T the value at that index
+     */
+    T pop(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        T old_value = std::move(_data[slot(index)]);
+        remove(index);
+        return old_value;
+    }
+
+    /**
+     * @brief removing the last element in the list
+     *
+     * @return T the last element
+     */
+    T pop() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot pop");
+        }
+
+        return pop(_size - 1);
+    }
+
+    T max() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find max");
+        }
+
+        int first = first_run();
+        T max_value = reduce::max_of(_data + _head, first);
+        if (first < _size) {
+            max_value = std::max(max_value, reduce::max_of(_data, _size - first));
+        }
+        return max_value;
+    }
+
+    T min() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find min");
+        }
+
+        int first = first_run();
+        T min_value = reduce::min_of(_data + _head, first);
+        if (first < _size) {
+            min_value = std::min(min_value, reduce::min_of(_data, _size - first));
+        }
+        return min_value;
+    }
+
+    int argmax() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmax");
+        }
+
+        int first = first_run();
+        int max_index = reduce::argmax_of(_data + _head, first);
+        if (first < _size) {
+            int wrapped = reduce::argmax_of(_data, _size - first);
+            if (_data[wrapped] > _data[_head + max_index]) {
+                max_index = first + wrapped;
+            }
+        }
+        return max_index;
+    }
+
+    int argmin() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmin");
+        }
+
+        int first = first_run();
+        int min_index = reduce::argmin_of(_data + _head, first);
+        if (first < _size) {
+            int wrapped = reduce::argmin_of(_data, _size - first);
+            if (_data[wrapped] < _data[_head + min_index]) {
+                min_index = first + wrapped;
+            }
+        }
+        return min_index;
+    }
+
+    int count(const T& value) {
+        int first = first_run();
+        return reduce::count_of(_data + _head, first, value) + reduce::count_of(_data, _size - first, value);
+    }
+};
+
+
+/**
+ * @brief List with the ArrayList interface stored as a tiered vector: a row
+ * of fixed-size circular blocks where every block but the last one is full.
+ *
+ * Indexing is one shift and one mask. Inserting or removing at an index
+ * shifts the elements inside one block and then passes a single element
+ * from block to block through their ring heads, so with blocks of about
+ * sqrt(N) elements every positional edit is O(sqrt N). The block size is
+ * doubled or halved (rebuilding the list) as the list grows or shrinks.
+ * T must be default constructible.
+ */
+template <typename T = int>
+class TieredVector {
+private:
+    // A ring of _block_size slots
+    struct Block {
+        std::unique_ptr<T[]> data;
+        int head = 0;
+        int size = 0;
+    };
+
+    std::vector<Block> _blocks;
+    int _shift = 4;
+    int _block_size = 1 << 4;
+    int _size = 0;
+
+    static constexpr int min_shift = 4;
+
+    T& at(Block& block, int offset) {
+        return block.data[(block.head + offset) & (_block_size - 1)];
+    }
+
+    Block new_block() {
+        Block block;
+        block.data.reset(new T[_block_size]);
+        return block;
+    }
+
+    void push_front(Block& block, T value) {
+        block.head = (block.head - 1) & (_block_size - 1);
+        block.data[block.head] = std::move(value);
+        block.size++;
+    }
+
+    void push_back(Block& block, T value) {
+        at(block, block.size) = std::move(value);
+        block.size++;
+    }
+
+    T pop_front(Block& block) {
+        T value = std::move(block.data[block.head]);
+        block.head = (block.head + 1) & (_block_size - 1);
+        block.size--;
+        return value;
+    }
+
+    T pop_back(Block& block) {
+        block.size--;
+        return std::move(at(block, block.size));
+    }
+
+    // Rebuild the list with blocks of 2^shift elements
+    void rebuild(int shift) {
+        std::vector<Block> old_blocks = std::move(_blocks);
+        int old_block_size = _block_size;
+        _blocks.clear();
+        _shift = shift;
+        _block_size = 1 << shift;
+        _size = 0;
+
+        for (Block& block : old_blocks) {
+            for (int i = 0; i < block.size; i++) {
+                append_element(std::move(block.data[(block.head + i) & (old_block_size - 1)]));
+            }
+        }
+    }
+
+    // Keep the number of blocks between a quarter of and twice the block size
+    void rebalance() {
+        int blocks = _blocks.size();
+        if (blocks > 2 * _block_size) {
+            rebuild(_shift + 1);
+        } else if (_shift > min_shift && blocks < _block_size / 4) {
+            rebuild(_shift - 1);
+        }
+    }
+
+    void append_element(T value) {
+        if (_blocks.empty() || _blocks.back().size == _block_size) {
+            _blocks.push_back(new_block());
+        }
+        push_back(_blocks.back(), std::move(value));
+        _size++;
+    }
+
+    // Find the smallest or largest element's index, earlier blocks winning ties
+    template <bool Smaller>
+    int arg_best() {
+        int best_index = 0;
+        int index = 0;
+        for (Block& block : _blocks) {
+            int first = std::min(block.size, _block_size - block.head);
+            const T* runs[2] = {block.data.get() + block.head, block.data.get()};
+            int lengths[2] = {first, block.size - first};
+            for (int run = 0; run < 2; run++) {
+                if (lengths[run] == 0) {
+                    continue;
+                }
+                int i = Smaller ? reduce::argmin_of(runs[run], lengths[run]) : reduce::argmax_of(runs[run], lengths[run]);
+                const T& candidate = runs[run][i];
+                const T& best = (*this)[best_index];
+                if (Smaller ? candidate < best : candidate > best) {
+                    best_index = index + i;
+                }
+                index += lengths[run];
+            }
+        }
+        return best_index;
+    }
+
+public:
+    // Default constructor
+    TieredVector() {
+    }
+
+    // Constructor for a list of values
+    TieredVector(std::vector<T> values) {
+        while ((1 << (2 * _shift)) < (int)values.size()) {
+            _shift++;
+        }
+        _block_size = 1 << _shift;
+        for (T& value : values) {
+            append_element(std::move(value));
+        }
+    }
+
+    // Length of array
+    int length() {
+        return _size;
+    }
+
+    // Number of elements that fit in the allocated blocks
+    int capacity() {
+        return _blocks.size() * _block_size;
+    }
+
+    // Number of elements per block
+    int block_size() {
+        return _block_size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param value The value to be appended
+     */
+    void append(T value) {
+        append_element(std::move(value));
+        rebalance();
+    }
+
+    /**
+     * @brief Get value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T The value at that index
+     */
+    T get(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+        return at(_blocks[index >> _shift], index & (_block_size - 1));
+    }
+
+    /**
+     * @brief Prints the array
+     *
+     */
+    void print() {
+        std::cout << "[";
+        for (int i = 0; i < _size; i++) {
+            std::cout << (*this)[i];
+            if (i < _size - 1) {
+                std::cout << ", ";
+            }
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get a reference to the value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T& The value at that index
+     */
+    T &operator[](int index) {
+        if (index < 0 || index >= _size) {
+            throw std::range_error("Index is out of bounds");
+        }
+        return at(_blocks[index >> _shift], index & (_block_size - 1));
+    }
+
+    /**
+     * @brief Insert a value before the given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param value the value
+     * @param index the index
+     */
+    void insert(T value, int index) {
+        if (index < 0 || index > _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        if (index == _size) {
+            append(std::move(value));
+            return;
+        }
+
+        if (_blocks.back().size == _block_size) {
+            _blocks.push_back(new_block());
+        }
+
+        // Make room in the target block by passing one element on from
+        // every block after it
+        int target = index >> _shift;
+        for (int b = _blocks.size() - 1; b > target; b--) {
+            push_front(_blocks[b], pop_back(_blocks[b - 1]));
+        }
+
+        Block& block = _blocks[target];
+        int offset = index & (_block_size - 1);
+        for (int i = block.size; i > offset; i--) {
+            at(block, i) = std::move(at(block, i - 1));
+        }
+        at(block, offset) = std::move(value);
+        block.size++;
+        _size++;
+
+        rebalance();
+    }
+
+    /**
+     * @brief deletes the element from the list.
+     *
+     * @param index the index
+     */
+    void remove(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        int target = index >> _shift;
+        Block& block = _blocks[target];
+        for (int i = index & (_block_size - 1); i < block.size - 1; i++) {
+            at(block, i) = std::move(at(block, i + 1));
+        }
+        block.size--;
+
+        // Fill the hole by pulling one element back from every later block
+        for (int b = target + 1; b < (int)_blocks.size(); b++) {
+            push_back(_blocks[b - 1], pop_front(_blocks[b]));
+        }
+        if (_blocks.back().size == 0) {
+            _blocks.pop_back();
+        }
+        _size--;
+
+        rebalance();
+    }
+
+    /***
+     * @brief removing an element at a given index
+     *
+     * @param index
+     * @return T the value at that index
+     */
+    T pop(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        T old_value = std::move((*this)[index]);
+        remove(index);
+        return old_value;
+    }
+
+    /**
+     * @brief removing the last element in the list
+     *
+     * @return T the last element
+     */
+    T pop() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot pop");
+        }
+
+        return pop(_size - 1);
+    }
+
+    T max() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find max");
+        }
+
+        return (*this)[arg_best<false>()];
+    }
+
+    T min() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find min");
+        }
+
+        return (*this)[arg_best<true>()];
+    }
+
+    int argmax() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmax");
+        }
+
+        return arg_best<false>();
+    }
+
+    int argmin() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmin");
+        }
+
+        return arg_best<true>();
+    }
+
+    int count(const T& value) {
+        int count = 0;
+        for (Block& block : _blocks) {
+            int first = std::min(block.size, _block_size - block.head);
+            count += reduce::count_of(block.data.get() + block.head, first, value);
+            count += reduce::count_of(block.data.get(), block.size - first, value);
+        }
+        return count;
+    }
+};
+
+
+/**
+ * @brief ArrayList variant for editing around a moving cursor, stored as a
+ * gap buffer.
+ *
+ * The free slots of the buffer form one gap, and the gap is moved to where
+ * the list is edited. Inserting or removing right at the gap is O(1);
+ * moving the gap to another index costs O(distance). A run of edits around
+ * the same cursor therefore never shifts the whole tail of the list the way
+ * ArrayList::insert does. T must be default constructible.
+ */
+template <typename T = int>
+class GapBuffer {
 private:
-    int* _data;
+    std::unique_ptr<T[]> _data;
     int _capacity = 1;
-    int _size = 0;
+    // The gap is [_gap_start, _gap_end), elements live on both sides of it
+    int _gap_start = 0;
+    int _gap_end = 1;
 
-    // Method for increasing the capacity of the array
-    void resize() {
-        int new_capacity = _capacity * 2;
-        int* new_data = new int[new_capacity];
+    int gap_length() {
+        return _gap_end - _gap_start;
+    }
+
+    // Position in the buffer of the element at the given index
+    int slot(int index) {
+        return index < _gap_start ? index : index + gap_length();
+    }
 
-        for (int i = 0; i < _size; i++)
-            new_data[i] = _data[i];
+    // Move the gap so that it starts at the given index
+    void move_gap(int index) {
+        if (index < _gap_start) {
+            std::move_backward(_data.get() + index, _data.get() + _gap_start, _data.get() + _gap_end);
+        } else if (index > _gap_start) {
+            std::move(_data.get() + _gap_end, _data.get() + _gap_end + (index - _gap_start), _data.get() + _gap_start);
+        }
+        _gap_end += index - _gap_start;
+        _gap_start = index;
+    }
 
-        delete[] _data;
+    // Move the elements to a new buffer, keeping the gap where it is
+    void reallocate(int new_capacity) {
+        std::unique_ptr<T[]> new_data(new T[new_capacity]);
+        int tail = _capacity - _gap_end;
 
-        _data = new_data;
+        std::move(_data.get(), _data.get() + _gap_start, new_data.get());
+        std::move(_data.get() + _gap_end, _data.get() + _capacity, new_data.get() + new_capacity - tail);
+
+        _data = std::move(new_data);
         _capacity = new_capacity;
+        _gap_end = new_capacity - tail;
+    }
+
+    // Method for increasing the capacity of the array
+    void resize() {
+        reallocate(_capacity * 2);
     }
 
     void shrink_to_fit() {
         int new_capacity = 1;
 
-        while (new_capacity < _size) {
+        while (new_capacity < length()) {
             new_capacity *= 2;
         }
 
@@ -35,47 +2319,28 @@ private:
             return;
         }
 
-        int* new_data = new int[new_capacity];
-
-        for (int i = 0; i < _size; i++) {
-            new_data[i] = _data[i];
-        }
-
-        delete[] _data;
-        _data = new_data;
-        _capacity = new_capacity;
+        reallocate(new_capacity);
     }
 
 public:
     // Default constructor
-    ArrayList() {
-        _data = new int[_capacity];
+    GapBuffer() : _data(new T[1]) {
     }
 
     // Constructor for a list of values
-    ArrayList(std::vector<int> values) {
-        // Set the capacity to match the input size
-        _capacity = values.size();
-        _size = 0;  // Initialize size to 0
-
-        // Allocate memory
-        _data = new int[_capacity];
-
-        // Copy elements from the vector
-        for (int value : values) {
-            append(value);
+    GapBuffer(std::vector<T> values) {
+        while (_capacity < (int)values.size()) {
+            _capacity *= 2;
         }
-    }
-
-    // Destructor
-    ~ArrayList() {
-        delete[] _data;
+        _data.reset(new T[_capacity]);
+        std::move(values.begin(), values.end(), _data.get());
+        _gap_start = values.size();
+        _gap_end = _capacity;
     }
 
     // Length of array
-    // Get the current size of the array
     int length() {
-        return _size;
+        return _capacity - gap_length();
     }
 
     // Retrieve the array's maximum capacity
@@ -83,17 +2348,18 @@ public:
         return _capacity;
     }
 
+    // Index where the gap sits, i.e. where the last edit happened
+    int cursor() {
+        return _gap_start;
+    }
+
     /**
      * @brief Append element to the end of the list
      *
-     * @param n The value to be appended
+     * @param value The value to be appended
      */
-    void append(int value) {
-        if (_size >= _capacity) {
-            resize();
-        }
-
-        _data[_size++] = value;
+    void append(T value) {
+        insert(std::move(value), length());
     }
 
     /**
@@ -101,13 +2367,13 @@ public:
      * Throws a range error if the index is out of bounds
      *
      * @param index The index
-     * @return int The value at that index
+     * @return T The value at that index
      */
-    int get(int index) {
-        if (index < 0 || index >= _size) {
+    T get(int index) {
+        if (index < 0 || index >= length()) {
             throw std::out_of_range("Index is out of bounds");
         }
-        return _data[index];
+        return _data[slot(index)];
     }
 
     /**
@@ -116,10 +2382,13 @@ public:
      */
     void print() {
         std::cout << "[";
-        for (int i = 0; i < _size - 1; i++) {
-            std::cout << _data[i] << ", ";
+        for (int i = 0; i < length(); i++) {
+            std::cout << _data[slot(i)];
+            if (i < length() - 1) {
+                std::cout << ", ";
+            }
         }
-        std::cout << _data[_size - 1] << "]\n";
+        std::cout << "]\n";
     }
 
     /**
@@ -127,66 +2396,50 @@ public:
      * Throws a range error if the index is out of bounds
      *
      * @param index The index
-     * @return int The value at that index
+     * @return T& The value at that index
      */
-    int &operator[](int index) {
-        if (index < 0 || index >= _size) {
+    T &operator[](int index) {
+        if (index < 0 || index >= length()) {
             throw std::range_error("Index is out of bounds");
         }
-        return _data[index];
+        return _data[slot(index)];
     }
 
     /**
-     * @brief get a value and an index.
-     * throw an error if the index is out of bounds
-     *
-     * increase size by 1
-     *
-     * move values to the right of the index by one index up.
+     * @brief Insert a value before the given index, moving the gap there first
+     * Throws a range error if the index is out of bounds
      *
-     * @param val the value
+     * @param value the value
      * @param index the index
-     *
      */
-    void insert(int value, int index) {
-        if (index < 0 || index > _size) {
+    void insert(T value, int index) {
+        if (index < 0 || index > length()) {
             throw std::out_of_range("Index is out of bounds");
         }
 
-        if (_size >= _capacity) {
+        if (gap_length() == 0) {
             resize();
         }
 
-        if (index == _size) {
-            append(value);
-        } else {
-            for (int i = _size; i > index; i--) {
-                _data[i] = _data[i - 1];
-            }
-            _data[index] = value;
-            _size++;
-        }
+        move_gap(index);
+        _data[_gap_start++] = std::move(value);
     }
 
     /**
-     * @brief deletes the element from the list.
+     * @brief deletes the element from the list, moving the gap there first
      *
      * @param index the index
-     *
      */
     void remove(int index) {
-        if (index < 0 || index >= _size) {
+        if (index < 0 || index >= length()) {
             throw std::out_of_range("Index is out of bounds");
         }
 
-        for (int i = index; i < _size - 1; i++) {
-            _data[i] = _data[i + 1];
-        }
-
-        _size--;
+        move_gap(index);
+        _gap_end++;
 
         // Check if the array can be resized to fit if less than 25% of the allocated capacity is used
-        if (_size < 0.25 * _capacity) {
+        if (length() < 0.25 * _capacity) {
             shrink_to_fit();
         }
     }
@@ -195,129 +2448,376 @@ public:
      * @brief removing an element at a given index
      *
      * @param index
-     * @return int the value at that index
+     * @return T the value at that index
      */
-
-    int pop(int index) {
-        if (index < 0 || index >= _size) {
+    T pop(int index) {
+        if (index < 0 || index >= length()) {
             throw std::out_of_range("Index is out of bounds");
         }
 
-        int old_value = _data[index];
-
-        // Move the elements to fill the gap left by the removed element
-        for (int i = index; i < _size - 1; i++) {
-            _data[i] = _data[i + 1];
-        }
-
-        _size--;
-
-        // Check if the array can be resized to fit if less than 25% of the allocated capacity is used
-        if (_size < 0.25 * _capacity) {
-            shrink_to_fit();
-        }
-
+        T old_value = std::move(_data[slot(index)]);
+        remove(index);
         return old_value;
     }
 
     /**
      * @brief removing the last element in the list
      *
-     * @return int the last element
+     * @return T the last element
      */
-    int pop() {
-        if (_size == 0) {
+    T pop() {
+        if (length() == 0) {
             throw std::underflow_error("List is empty, cannot pop");
         }
 
-        int old_value = _data[_size - 1];
-        _size--;
+        return pop(length() - 1);
+    }
 
-        // Check if the array can be resized to fit if less than 25% of the allocated capacity is used
-        if (_size < 0.25 * _capacity) {
-            shrink_to_fit();
+    T max() {
+        if (length() == 0) {
+            throw std::underflow_error("List is empty, cannot find max");
         }
 
-        return old_value;
+        return _data[slot(argmax())];
     }
 
-    int max() {
-        if (_size == 0) {
-            throw std::underflow_error("List is empty, cannot find max");
+    T min() {
+        if (length() == 0) {
+            throw std::underflow_error("List is empty, cannot find min");
         }
 
-        int max_value = _data[0];
+        return _data[slot(argmin())];
+    }
 
-        for (int i = 1; i < _size; i++) {
-            if (_data[i] > max_value) {
-                max_value = _data[i];
-            }
+    int argmax() {
+        if (length() == 0) {
+            throw std::underflow_error("List is empty, cannot find argmax");
         }
 
-        return max_value;
+        int tail = _capacity - _gap_end;
+        if (_gap_start == 0) {
+            return reduce::argmax_of(_data.get() + _gap_end, tail);
+        }
+        int max_index = reduce::argmax_of(_data.get(), _gap_start);
+        if (tail > 0) {
+            int after = reduce::argmax_of(_data.get() + _gap_end, tail);
+            if (_data[_gap_end + after] > _data[max_index]) {
+                max_index = _gap_start + after;
+            }
+        }
+        return max_index;
     }
 
-    int min() {
-        if (_size == 0) {
-            throw std::underflow_error("List is empty, cannot find min");
+    int argmin() {
+        if (length() == 0) {
+            throw std::underflow_error("List is empty, cannot find argmin");
         }
 
-        int min_value = _data[0];
-
-        for (int i = 1; i < _size; i++) {
-            if (_data[i] < min_value) {
-                min_value = _data[i];
+        int tail = _capacity - _gap_end;
+        if (_gap_start == 0) {
+            return reduce::argmin_of(_data.get() + _gap_end, tail);
+        }
+        int min_index = reduce::argmin_of(_data.get(), _gap_start);
+        if (tail > 0) {
+            int after = reduce::argmin_of(_data.get() + _gap_end, tail);
+            if (_data[_gap_end + after] < _data[min_index]) {
+                min_index = _gap_start + after;
             }
         }
+        return min_index;
+    }
 
-        return min_value;
+    int count(const T& value) {
+        return reduce::count_of(_data.get(), _gap_start, value)
+            + reduce::count_of(_data.get() + _gap_end, _capacity - _gap_end, value);
     }
+};
 
-    int argmax() {
-        if (_size == 0) {
-            throw std::underflow_error("List is empty, cannot find argmax");
-        }
 
-        int max_value = _data[0];
-        int max_index = 0;
+/**
+ * @brief A recorded sequence of list operations, kept small enough to
+ * capture real traffic.
+ *
+ * Every operation is one opcode byte followed by its arguments as LEB128
+ * varints, values zigzag encoded so that small negative numbers stay short:
+ * an append of a small value takes two bytes. A trace file is the magic
+ * "LTRC", a version byte and the encoded operations. Only operations that
+ * succeeded are recorded, so every index in a trace is valid when the trace
+ * is replayed in order.
+ */
+class OperationTrace {
+public:
+    enum Op : unsigned char {
+        append = 1, // value
+        insert,     // value, index
+        remove,     // index
+        pop,        //
+        pop_at,     // index
+        get,        // index
+        min,        //
+        max,        //
+        count,      // value
+    };
+
+    // One decoded operation; arguments an operation doesn't have are 0
+    struct Operation {
+        Op op;
+        int value;
+        int index;
+    };
+
+private:
+    static constexpr unsigned char version = 1;
+
+    std::vector<unsigned char> _bytes;
+    int _length = 0;
+
+    static bool has_value(Op op) {
+        return op == append || op == insert || op == count;
+    }
+
+    static bool has_index(Op op) {
+        return op == insert || op == remove || op == pop_at || op == get;
+    }
+
+    void put_varint(unsigned int n) {
+        while (n >= 0x80) {
+            _bytes.push_back((unsigned char)(n | 0x80));
+            n >>= 7;
+        }
+        _bytes.push_back((unsigned char)n);
+    }
 
-        for (int i = 1; i < _size; i++) {
-            if (_data[i] > max_value) {
-                max_value = _data[i];
-                max_index = i;
+    unsigned int get_varint(std::size_t& position) const {
+        unsigned int n = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (position >= _bytes.size()) {
+                throw std::runtime_error("Trace is truncated");
+            }
+            unsigned char byte = _bytes[position++];
+            n |= (unsigned int)(byte & 0x7f) << shift;
+            if (byte < 0x80) {
+                return n;
             }
         }
+        throw std::runtime_error("Trace has a malformed number");
+    }
 
-        return max_index;
+public:
+    // Number of operations
+    int length() const {
+        return _length;
     }
 
-    int argmin() {
-        if (_size == 0) {
-            throw std::underflow_error("List is empty, cannot find argmin");
-        }
+    std::size_t size_in_bytes() const {
+        return _bytes.size();
+    }
 
-        int min_value = _data[0];
-        int min_index = 0;
+    void record(Op op, int value = 0, int index = 0) {
+        _bytes.push_back(op);
+        if (has_value(op)) {
+            put_varint(((unsigned int)value << 1) ^ (unsigned int)(value >> 31));
+        }
+        if (has_index(op)) {
+            put_varint((unsigned int)index);
+        }
+        _length++;
+    }
 
-        for (int i = 1; i < _size; i++) {
-            if (_data[i] < min_value) {
-                min_value = _data[i];
-                min_index = i;
+    std::vector<Operation> decode() const {
+        std::vector<Operation> operations;
+        operations.reserve(_length);
+        std::size_t position = 0;
+        while (position < _bytes.size()) {
+            Op op = (Op)_bytes[position++];
+            if (op < append || op > count) {
+                throw std::runtime_error("Trace has an unknown operation");
             }
+            Operation operation{op, 0, 0};
+            if (has_value(op)) {
+                unsigned int n = get_varint(position);
+                operation.value = (int)(n >> 1) ^ -(int)(n & 1);
+            }
+            if (has_index(op)) {
+                operation.index = (int)get_varint(position);
+            }
+            operations.push_back(operation);
         }
+        return operations;
+    }
 
-        return min_index;
+    void save(const std::string& path) const {
+        std::ofstream ofs{path, std::ios::binary};
+        if (!ofs) {
+            throw std::runtime_error("Unable to open file");
+        }
+        ofs.write("LTRC", 4);
+        ofs.put((char)version);
+        ofs.write((const char*)_bytes.data(), _bytes.size());
     }
 
-    int count(int value) {
-        int count = 0;
+    static OperationTrace load(const std::string& path) {
+        std::ifstream ifs{path, std::ios::binary};
+        if (!ifs) {
+            throw std::runtime_error("Unable to open file");
+        }
+        char header[5] = {};
+        ifs.read(header, 5);
+        if (!ifs || std::string(header, 4) != "LTRC" || header[4] != (char)version) {
+            throw std::runtime_error("Not a trace file");
+        }
+        OperationTrace trace;
+        trace._bytes.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        // Decoding checks the whole trace and gives the count
+        trace._length = trace.decode().size();
+        return trace;
+    }
+};
 
-        for (int i = 0; i < _size; i++) {
-            if (_data[i] == value) {
-                count++;
-            }
+// Count a value in a list; lists without count() are counted through indexing
+template <typename List>
+auto trace_count(List& list, int value) -> decltype(list.count(value)) {
+    return list.count(value);
+}
+
+template <typename List, typename... Ignored>
+int trace_count(List& list, int value, Ignored...) {
+    int n = 0;
+    for (int i = 0, length = list.length(); i < length; i++) {
+        n += list[i] == value;
+    }
+    return n;
+}
+
+/**
+ * @brief Wraps a list of int and records every operation on it into an
+ * OperationTrace. It has the list methods a trace knows about; the list
+ * itself is there through list() for anything else, unrecorded.
+ */
+template <typename List>
+class TraceRecorder {
+private:
+    List _list;
+    OperationTrace _trace;
+
+public:
+    TraceRecorder() = default;
+
+    // Wrap a list that already has elements; they go in the trace as appends
+    // so that the trace replays from an empty list
+    explicit TraceRecorder(List list) : _list(std::move(list)) {
+        for (int i = 0, length = _list.length(); i < length; i++) {
+            _trace.record(OperationTrace::append, _list[i]);
         }
+    }
 
-        return count;
+    List& list() {
+        return _list;
+    }
+
+    const OperationTrace& trace() const {
+        return _trace;
+    }
+
+    int length() {
+        return _list.length();
+    }
+
+    void append(int value) {
+        _list.append(value);
+        _trace.record(OperationTrace::append, value);
+    }
+
+    void insert(int value, int index) {
+        _list.insert(value, index);
+        _trace.record(OperationTrace::insert, value, index);
+    }
+
+    void remove(int index) {
+        _list.remove(index);
+        _trace.record(OperationTrace::remove, 0, index);
+    }
+
+    int pop() {
+        int value = _list.pop();
+        _trace.record(OperationTrace::pop);
+        return value;
+    }
+
+    int pop(int index) {
+        int value = _list.pop(index);
+        _trace.record(OperationTrace::pop_at, 0, index);
+        return value;
+    }
+
+    int operator[](int index) {
+        int value = _list[index];
+        _trace.record(OperationTrace::get, 0, index);
+        return value;
+    }
+
+    int min() {
+        int value = _list.min();
+        _trace.record(OperationTrace::min);
+        return value;
+    }
+
+    int max() {
+        int value = _list.max();
+        _trace.record(OperationTrace::max);
+        return value;
+    }
+
+    int count(int value) {
+        int n = trace_count(_list, value);
+        _trace.record(OperationTrace::count, value);
+        return n;
     }
 };
+
+/**
+ * @brief Run decoded trace operations against a list, as fast as the list
+ * allows. The results of the reads are folded into a checksum, which keeps
+ * them from being optimized away and must come out the same for every list
+ * that replays the same trace.
+ *
+ * @param operations The trace, from OperationTrace::decode()
+ * @param list The list to replay against, normally empty
+ * @return unsigned long long The checksum
+ */
+template <typename List>
+unsigned long long replay(const std::vector<OperationTrace::Operation>& operations, List& list) {
+    unsigned long long checksum = 0;
+    for (const OperationTrace::Operation& operation : operations) {
+        switch (operation.op) {
+        case OperationTrace::append:
+            list.append(operation.value);
+            break;
+        case OperationTrace::insert:
+            list.insert(operation.value, operation.index);
+            break;
+        case OperationTrace::remove:
+            list.remove(operation.index);
+            break;
+        case OperationTrace::pop:
+            checksum = checksum * 31 + list.pop();
+            break;
+        case OperationTrace::pop_at:
+            checksum = checksum * 31 + list.pop(operation.index);
+            break;
+        case OperationTrace::get:
+            checksum = checksum * 31 + list[operation.index];
+            break;
+        case OperationTrace::min:
+            checksum = checksum * 31 + list.min();
+            break;
+        case OperationTrace::max:
+            checksum = checksum * 31 + list.max();
+            break;
+        case OperationTrace::count:
+            checksum = checksum * 31 + trace_count(list, operation.value);
+            break;
+        }
+    }
+    return checksum;
+}
@@ -2,811 +2,8556 @@
 #include <stdexcept>
 #include <vector>
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
-class ArrayList {
-private:
-    int* _data;
-    int _capacity = 1;
-    int _size = 0;
+/**
+ * @brief Decides how an ArrayList grows and shrinks its buffer.
+ *
+ * The buffer grows to grow(capacity) when it is full. Once fewer than
+ * shrink_threshold * capacity elements are in use it shrinks to the first
+ * capacity on the growth ladder (starting at min_capacity) that holds
+ * shrink_headroom * size elements. A headroom above one keeps a list that
+ * hovers around the threshold from shrinking and growing over and over.
+ */
+struct GrowthPolicy {
+    // Returns the next capacity when the buffer is full
+    int (*grow)(int capacity) = grow_double;
+    // Shrink when less than this fraction of the capacity is used
+    double shrink_threshold = 0.25;
+    // Keep room for this many times the current size after shrinking
+    double shrink_headroom = 1.0;
+    // The buffer never gets smaller than this
+    int min_capacity = 1;
+    // Keep the buffer at its largest size
+    bool never_shrink = false;
 
-    // Method for increasing the capacity of the array
-    void resize() {
-        int new_capacity = _capacity * 2;
-        int* new_data = new int[new_capacity];
+    static int grow_double(int capacity) {
+        return capacity * 2;
+    }
 
-        for (int i = 0; i < _size; i++)
-            new_data[i] = _data[i];
+    static int grow_one_and_a_half(int capacity) {
+        return capacity + capacity / 2;
+    }
 
-        delete[] _data;
+    // Double on growth, shrink to a tight fit below 25% usage
+    static GrowthPolicy doubling() {
+        return GrowthPolicy{};
+    }
 
-        _data = new_data;
-        _capacity = new_capacity;
+    // Grow by 1.5x, which lets freed blocks be reused by later growth
+    static GrowthPolicy one_and_a_half() {
+        GrowthPolicy policy;
+        policy.grow = grow_one_and_a_half;
+        return policy;
     }
 
-    void shrink_to_fit() {
-        int new_capacity = 1;
+    // Grow with a user supplied function
+    static GrowthPolicy custom(int (*grow)(int capacity)) {
+        GrowthPolicy policy;
+        policy.grow = grow;
+        return policy;
+    }
 
-        while (new_capacity < _size) {
-            new_capacity *= 2;
-        }
+    // Shrink below 25% usage, but only down to twice the current size
+    static GrowthPolicy hysteresis() {
+        GrowthPolicy policy;
+        policy.shrink_headroom = 2.0;
+        return policy;
+    }
 
-        if (new_capacity == _capacity) {
-            // No need to reduce, the capacity is already suitable.
-            return;
-        }
+    // Never give memory back
+    static GrowthPolicy no_shrink() {
+        GrowthPolicy policy;
+        policy.never_shrink = true;
+        return policy;
+    }
+};
 
-        int* new_data = new int[new_capacity];
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ARRAY_LIST_SIMD 1
+#include <immintrin.h>
+#endif
 
-        for (int i = 0; i < _size; i++) {
-            new_data[i] = _data[i];
+/**
+ * @brief Vectorized scans over int buffers for ArrayList::min, max, argmin,
+ * argmax and count.
+ *
+ * Every kernel exists as a scalar loop and, on x86 with GCC or Clang, as
+ * SSE4.1, AVX2 and AVX-512 versions compiled with target attributes. The
+ * best version the CPU supports is picked from cpuid the first time
+ * kernels() is called. argmin and argmax keep the best index per lane and
+ * only replace it on a strictly smaller/larger value, so ties still resolve
+ * to the first index like the scalar loops.
+ */
+namespace simd {
+
+enum class Isa { scalar, sse41, avx2, avx512 };
+
+// Function table for one instruction set. All functions require n > 0
+// except count.
+struct Kernels {
+    int (*min)(const int* data, int n);
+    int (*max)(const int* data, int n);
+    int (*argmin)(const int* data, int n);
+    int (*argmax)(const int* data, int n);
+    int (*count)(const int* data, int n, int value);
+};
+
+inline int min_scalar(const int* data, int n) {
+    int min_value = data[0];
+    for (int i = 1; i < n; i++) {
+        if (data[i] < min_value) {
+            min_value = data[i];
         }
+    }
+    return min_value;
+}
 
-        delete[] _data;
-        _data = new_data;
-        _capacity = new_capacity;
+inline int max_scalar(const int* data, int n) {
+    int max_value = data[0];
+    for (int i = 1; i < n; i++) {
+        if (data[i] > max_value) {
+            max_value = data[i];
+        }
     }
+    return max_value;
+}
 
-public:
-    // Default constructor
-    ArrayList() {
-        _data = new int[_capacity];
+inline int argmin_scalar(const int* data, int n) {
+    int min_index = 0;
+    for (int i = 1; i < n; i++) {
+        if (data[i] < data[min_index]) {
+            min_index = i;
+        }
     }
+    return min_index;
+}
 
-    // Constructor for a list of values
-    ArrayList(std::vector<int> values) {
-        // Set the capacity to match the input size
-        _capacity = values.size();
-        _size = 0;  // Initialize size to 0
+inline int argmax_scalar(const int* data, int n) {
+    int max_index = 0;
+    for (int i = 1; i < n; i++) {
+        if (data[i] > data[max_index]) {
+            max_index = i;
+        }
+    }
+    return max_index;
+}
 
-        // Allocate memory
-        _data = new int[_capacity];
+inline int count_scalar(const int* data, int n, int value) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        count += data[i] == value;
+    }
+    return count;
+}
 
-        // Copy elements from the vector
-        for (int value : values) {
-            append(value);
+// Pick the first index among the lanes holding the best value, then let the
+// scalar tail starting at from improve on it.
+template <bool Smaller>
+inline int reduce_lanes(const int* data, int n, int from, const int* values, const int* indices, int lanes) {
+    int best = 0;
+    for (int lane = 1; lane < lanes; lane++) {
+        bool better = Smaller ? values[lane] < values[best] : values[lane] > values[best];
+        if (better || (values[lane] == values[best] && indices[lane] < indices[best])) {
+            best = lane;
+        }
+    }
+    int best_index = indices[best];
+    for (int i = from; i < n; i++) {
+        if (Smaller ? data[i] < data[best_index] : data[i] > data[best_index]) {
+            best_index = i;
         }
     }
+    return best_index;
+}
 
-    // Destructor
-    ~ArrayList() {
-        delete[] _data;
+#ifdef ARRAY_LIST_SIMD
+
+__attribute__((target("sse4.1"))) inline int min_sse41(const int* data, int n) {
+    if (n < 4) {
+        return min_scalar(data, n);
+    }
+    __m128i best = _mm_loadu_si128((const __m128i*)data);
+    int i = 4;
+    for (; i + 4 <= n; i += 4) {
+        best = _mm_min_epi32(best, _mm_loadu_si128((const __m128i*)(data + i)));
     }
+    alignas(16) int lanes[4];
+    _mm_store_si128((__m128i*)lanes, best);
+    int min_value = min_scalar(lanes, 4);
+    for (; i < n; i++) {
+        min_value = std::min(min_value, data[i]);
+    }
+    return min_value;
+}
 
-    // Length of array
-    // Get the current size of the array
-    int length() {
-        return _size;
+__attribute__((target("sse4.1"))) inline int max_sse41(const int* data, int n) {
+    if (n < 4) {
+        return max_scalar(data, n);
     }
+    __m128i best = _mm_loadu_si128((const __m128i*)data);
+    int i = 4;
+    for (; i + 4 <= n; i += 4) {
+        best = _mm_max_epi32(best, _mm_loadu_si128((const __m128i*)(data + i)));
+    }
+    alignas(16) int lanes[4];
+    _mm_store_si128((__m128i*)lanes, best);
+    int max_value = max_scalar(lanes, 4);
+    for (; i < n; i++) {
+        max_value = std::max(max_value, data[i]);
+    }
+    return max_value;
+}
 
-    // Retrieve the array's maximum capacity
-    int capacity() {
-        return _capacity;
+template <bool Smaller>
+__attribute__((target("sse4.1"))) inline int arg_sse41(const int* data, int n) {
+    if (n < 4) {
+        return Smaller ? argmin_scalar(data, n) : argmax_scalar(data, n);
     }
+    __m128i best = _mm_loadu_si128((const __m128i*)data);
+    __m128i best_index = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i index = best_index;
+    const __m128i step = _mm_set1_epi32(4);
+    int i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+        index = _mm_add_epi32(index, step);
+        __m128i better = Smaller ? _mm_cmpgt_epi32(best, v) : _mm_cmpgt_epi32(v, best);
+        best = _mm_blendv_epi8(best, v, better);
+        best_index = _mm_blendv_epi8(best_index, index, better);
+    }
+    alignas(16) int values[4];
+    alignas(16) int indices[4];
+    _mm_store_si128((__m128i*)values, best);
+    _mm_store_si128((__m128i*)indices, best_index);
+    return reduce_lanes<Smaller>(data, n, i, values, indices, 4);
+}
 
-    /**
-     * @brief Append element to the end of the list
-     *
-     * @param n The value to be appended
-     */
-    void append(int value) {
-        if (_size >= _capacity) {
-            resize();
-        }
+__attribute__((target("sse4.1"))) inline int argmin_sse41(const int* data, int n) {
+    return arg_sse41<true>(data, n);
+}
+
+__attribute__((target("sse4.1"))) inline int argmax_sse41(const int* data, int n) {
+    return arg_sse41<false>(data, n);
+}
 
-        _data[_size++] = value;
+__attribute__((target("sse4.1"))) inline int count_sse41(const int* data, int n, int value) {
+    __m128i needle = _mm_set1_epi32(value);
+    __m128i total = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(data + i)), needle);
+        // Equal lanes are all ones, i.e. -1
+        total = _mm_sub_epi32(total, equal);
     }
+    alignas(16) int lanes[4];
+    _mm_store_si128((__m128i*)lanes, total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + count_scalar(data + i, n - i, value);
+}
 
-    /**
-     * @brief Get value at a given index.
-     * Throws a range error if the index is out of bounds
-     *
-     * @param index The index
-     * @return int The value at that index
-     */
-    int get(int index) {
-        if (index < 0 || index >= _size) {
-            throw std::out_of_range("Index is out of bounds");
-        }
-        return _data[index];
+__attribute__((target("avx2"))) inline int min_avx2(const int* data, int n) {
+    if (n < 8) {
+        return min_scalar(data, n);
     }
+    __m256i best = _mm256_loadu_si256((const __m256i*)data);
+    int i = 8;
+    for (; i + 8 <= n; i += 8) {
+        best = _mm256_min_epi32(best, _mm256_loadu_si256((const __m256i*)(data + i)));
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256((__m256i*)lanes, best);
+    int min_value = min_scalar(lanes, 8);
+    for (; i < n; i++) {
+        min_value = std::min(min_value, data[i]);
+    }
+    return min_value;
+}
 
-    /**
-     * @brief Prints the array
-     *
-     */
-    void print() {
-        std::cout << "[";
-        for (int i = 0; i < _size - 1; i++) {
-            std::cout << _data[i] << ", ";
-        }
-        std::cout << _data[_size - 1] << "]\n";
+__attribute__((target("avx2"))) inline int max_avx2(const int* data, int n) {
+    if (n < 8) {
+        return max_scalar(data, n);
     }
+    __m256i best = _mm256_loadu_si256((const __m256i*)data);
+    int i = 8;
+    for (; i + 8 <= n; i += 8) {
+        best = _mm256_max_epi32(best, _mm256_loadu_si256((const __m256i*)(data + i)));
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256((__m256i*)lanes, best);
+    int max_value = max_scalar(lanes, 8);
+    for (; i < n; i++) {
+        max_value = std::max(max_value, data[i]);
+    }
+    return max_value;
+}
 
-    /**
-     * @brief Get a reference to the value at a given index.
-     * Throws a range error if the index is out of bounds
-     *
-     * @param index The index
-     * @return int The value at that index
-     */
-    int &operator[](int index) {
-        if (index < 0 || index >= _size) {
-            throw std::range_error("Index is out of bounds");
-        }
-        return _data[index];
+template <bool Smaller>
+__attribute__((target("avx2"))) inline int arg_avx2(const int* data, int n) {
+    if (n < 8) {
+        return Smaller ? argmin_scalar(data, n) : argmax_scalar(data, n);
     }
+    __m256i best = _mm256_loadu_si256((const __m256i*)data);
+    __m256i best_index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i index = best_index;
+    const __m256i step = _mm256_set1_epi32(8);
+    int i = 8;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+        index = _mm256_add_epi32(index, step);
+        __m256i better = Smaller ? _mm256_cmpgt_epi32(best, v) : _mm256_cmpgt_epi32(v, best);
+        best = _mm256_blendv_epi8(best, v, better);
+        best_index = _mm256_blendv_epi8(best_index, index, better);
+    }
+    alignas(32) int values[8];
+    alignas(32) int indices[8];
+    _mm256_store_si256((__m256i*)values, best);
+    _mm256_store_si256((__m256i*)indices, best_index);
+    return reduce_lanes<Smaller>(data, n, i, values, indices, 8);
+}
 
-    /**
-     * @brief get a value and an index.
-     * throw an error if the index is out of bounds
-     *
-     * increase size by 1
-     *
-     * move values to the right of the index by one index up.
-     *
-     * @param val the value
-     * @param index the index
-     *
-     */
-    void insert(int value, int index) {
-        if (index < 0 || index > _size) {
-            throw std::out_of_range("Index is out of bounds");
-        }
+__attribute__((target("avx2"))) inline int argmin_avx2(const int* data, int n) {
+    return arg_avx2<true>(data, n);
+}
 
-        if (_size >= _capacity) {
-            resize();
-        }
+__attribute__((target("avx2"))) inline int argmax_avx2(const int* data, int n) {
+    return arg_avx2<false>(data, n);
+}
 
-        if (index == _size) {
-            append(value);
-        } else {
-            for (int i = _size; i > index; i--) {
-                _data[i] = _data[i - 1];
-            }
-            _data[index] = value;
-            _size++;
-        }
+__attribute__((target("avx2"))) inline int count_avx2(const int* data, int n, int value) {
+    __m256i needle = _mm256_set1_epi32(value);
+    __m256i total = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(data + i)), needle);
+        total = _mm256_sub_epi32(total, equal);
     }
+    alignas(32) int lanes[8];
+    _mm256_store_si256((__m256i*)lanes, total);
+    int count = 0;
+    for (int lane = 0; lane < 8; lane++) {
+        count += lanes[lane];
+    }
+    return count + count_scalar(data + i, n - i, value);
+}
 
-    /**
-     * @brief deletes the element from the list.
-     *
-     * @param index the index
-     *
-     */
-    void remove(int index) {
-        if (index < 0 || index >= _size) {
-            throw std::out_of_range("Index is out of bounds");
-        }
-
-        for (int i = index; i < _size - 1; i++) {
-            _data[i] = _data[i + 1];
-        }
+// GCC 12's avx512fintrin.h starts the results of _mm512_min_epi32 and
+// friends from an undefined vector, which -Wmaybe-uninitialized then reports
+// once they are inlined here; the values are never read
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
 
-        _size--;
+__attribute__((target("avx512f"))) inline int min_avx512(const int* data, int n) {
+    if (n < 16) {
+        return min_scalar(data, n);
+    }
+    __m512i best = _mm512_loadu_si512(data);
+    int i = 16;
+    for (; i + 16 <= n; i += 16) {
+        best = _mm512_min_epi32(best, _mm512_loadu_si512(data + i));
+    }
+    int min_value = _mm512_reduce_min_epi32(best);
+    for (; i < n; i++) {
+        min_value = std::min(min_value, data[i]);
+    }
+    return min_value;
+}
 
-        // Check if the array can be resized to fit if less than 25% of the allocated capacity is used
-        if (_size < 0.25 * _capacity) {
-            shrink_to_fit();
-        }
+__attribute__((target("avx512f"))) inline int max_avx512(const int* data, int n) {
+    if (n < 16) {
+        return max_scalar(data, n);
+    }
+    __m512i best = _mm512_loadu_si512(data);
+    int i = 16;
+    for (; i + 16 <= n; i += 16) {
+        best = _mm512_max_epi32(best, _mm512_loadu_si512(data + i));
     }
+    int max_value = _mm512_reduce_max_epi32(best);
+    for (; i < n; i++) {
+        max_value = std::max(max_value, data[i]);
+    }
+    return max_value;
+}
 
-    /***
-     * @brief removing an element at a given index
-     *
-     * @param index
-     * @return int the value at that index
-     */
+template <bool Smaller>
+__attribute__((target("avx512f"))) inline int arg_avx512(const int* data, int n) {
+    if (n < 16) {
+        return Smaller ? argmin_scalar(data, n) : argmax_scalar(data, n);
+    }
+    __m512i best = _mm512_loadu_si512(data);
+    __m512i best_index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512i index = best_index;
+    const __m512i step = _mm512_set1_epi32(16);
+    int i = 16;
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_loadu_si512(data + i);
+        index = _mm512_add_epi32(index, step);
+        __mmask16 better = Smaller ? _mm512_cmplt_epi32_mask(v, best) : _mm512_cmpgt_epi32_mask(v, best);
+        best = _mm512_mask_mov_epi32(best, better, v);
+        best_index = _mm512_mask_mov_epi32(best_index, better, index);
+    }
+    alignas(64) int values[16];
+    alignas(64) int indices[16];
+    _mm512_store_si512(values, best);
+    _mm512_store_si512(indices, best_index);
+    return reduce_lanes<Smaller>(data, n, i, values, indices, 16);
+}
 
-    int pop(int index) {
-        if (index < 0 || index >= _size) {
-            throw std::out_of_range("Index is out of bounds");
-        }
+__attribute__((target("avx512f"))) inline int argmin_avx512(const int* data, int n) {
+    return arg_avx512<true>(data, n);
+}
 
-        int old_value = _data[index];
+__attribute__((target("avx512f"))) inline int argmax_avx512(const int* data, int n) {
+    return arg_avx512<false>(data, n);
+}
 
-        // Move the elements to fill the gap left by the removed element
-        for (int i = index; i < _size - 1; i++) {
-            _data[i] = _data[i + 1];
-        }
+__attribute__((target("avx512f"))) inline int count_avx512(const int* data, int n, int value) {
+    __m512i needle = _mm512_set1_epi32(value);
+    int count = 0;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        count += __builtin_popcount(_mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i), needle));
+    }
+    return count + count_scalar(data + i, n - i, value);
+}
 
-        _size--;
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
-        // Check if the array can be resized to fit if less than 25% of the allocated capacity is used
-        if (_size < 0.25 * _capacity) {
-            shrink_to_fit();
-        }
+#endif
 
-        return old_value;
+// Check whether this CPU can run the kernels of the given instruction set
+inline bool supported(Isa isa) {
+#ifdef ARRAY_LIST_SIMD
+    switch (isa) {
+    case Isa::sse41:
+        return __builtin_cpu_supports("sse4.1");
+    case Isa::avx2:
+        return __builtin_cpu_supports("avx2");
+    case Isa::avx512:
+        return __builtin_cpu_supports("avx512f");
+    default:
+        return true;
     }
+#else
+    return isa == Isa::scalar;
+#endif
+}
 
-    /**
-     * @brief removing the last element in the list
-     *
-     * @return int the last element
-     */
-    int pop() {
-        if (_size == 0) {
-            throw std::underflow_error("List is empty, cannot pop");
-        }
-
-        int old_value = _data[_size - 1];
-        _size--;
+inline const char* isa_name(Isa isa) {
+    switch (isa) {
+    case Isa::sse41:
+        return "sse4.1";
+    case Isa::avx2:
+        return "avx2";
+    case Isa::avx512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
 
-        // Check if the array can be resized to fit if less than 25% of the allocated capacity is used
-        if (_size < 0.25 * _capacity) {
-            shrink_to_fit();
+// The best instruction set this CPU supports
+inline Isa detect_isa() {
+    for (Isa isa : {Isa::avx512, Isa::avx2, Isa::sse41}) {
+        if (supported(isa)) {
+            return isa;
         }
+    }
+    return Isa::scalar;
+}
 
-        return old_value;
+/**
+ * @brief Get the kernels of an instruction set.
+ * Throws a runtime error if the CPU does not support it.
+ *
+ * @param isa The instruction set
+ * @return Kernels The function table
+ */
+inline Kernels kernels_for(Isa isa) {
+    if (!supported(isa)) {
+        throw std::runtime_error(std::string("CPU does not support ") + isa_name(isa));
     }
+    switch (isa) {
+#ifdef ARRAY_LIST_SIMD
+    case Isa::sse41:
+        return Kernels{min_sse41, max_sse41, argmin_sse41, argmax_sse41, count_sse41};
+    case Isa::avx2:
+        return Kernels{min_avx2, max_avx2, argmin_avx2, argmax_avx2, count_avx2};
+    case Isa::avx512:
+        return Kernels{min_avx512, max_avx512, argmin_avx512, argmax_avx512, count_avx512};
+#endif
+    default:
+        return Kernels{min_scalar, max_scalar, argmin_scalar, argmax_scalar, count_scalar};
+    }
+}
 
-    int max() {
-        if (_size == 0) {
-            throw std::underflow_error("List is empty, cannot find max");
-        }
+// The kernels for the best instruction set, detected once
+inline const Kernels& kernels() {
+    static const Kernels best = kernels_for(detect_isa());
+    return best;
+}
 
-        int max_value = _data[0];
+} // namespace simd
 
-        for (int i = 1; i < _size; i++) {
-            if (_data[i] > max_value) {
-                max_value = _data[i];
-            }
-        }
+/**
+ * @brief Scans over n > 0 contiguous elements (count also takes n == 0),
+ * shared by the containers in this file. int buffers go through the
+ * dispatched simd kernels.
+ */
+namespace reduce {
 
-        return max_value;
+template <typename T>
+T max_of(const T* data, int n) {
+    if constexpr (std::is_same<T, int>::value) {
+        return simd::kernels().max(data, n);
     }
 
-    int min() {
-        if (_size == 0) {
-            throw std::underflow_error("List is empty, cannot find min");
-        }
-
-        int min_value = _data[0];
+    T max_value = data[0];
 
-        for (int i = 1; i < _size; i++) {
-            if (_data[i] < min_value) {
-                min_value = _data[i];
-            }
+    for (int i = 1; i < n; i++) {
+        if (data[i] > max_value) {
+            max_value = data[i];
         }
-
-        return min_value;
     }
 
-    int argmax() {
-        if (_size == 0) {
-            throw std::underflow_error("List is empty, cannot find argmax");
-        }
+    return max_value;
+}
+
+template <typename T>
+T min_of(const T* data, int n) {
+    if constexpr (std::is_same<T, int>::value) {
+        return simd::kernels().min(data, n);
+    }
 
-        int max_value = _data[0];
-        int max_index = 0;
+    T min_value = data[0];
 
-        for (int i = 1; i < _size; i++) {
-            if (_data[i] > max_value) {
-                max_value = _data[i];
-                max_index = i;
-            }
+    for (int i = 1; i < n; i++) {
+        if (data[i] < min_value) {
+            min_value = data[i];
         }
-
-        return max_index;
     }
 
-    int argmin() {
-        if (_size == 0) {
-            throw std::underflow_error("List is empty, cannot find argmin");
-        }
+    return min_value;
+}
+
+template <typename T>
+int argmax_of(const T* data, int n) {
+    if constexpr (std::is_same<T, int>::value) {
+        return simd::kernels().argmax(data, n);
+    }
 
-        int min_value = _data[0];
-        int min_index = 0;
+    T max_value = data[0];
+    int max_index = 0;
 
-        for (int i = 1; i < _size; i++) {
-            if (_data[i] < min_value) {
-                min_value = _data[i];
-                min_index = i;
-            }
+    for (int i = 1; i < n; i++) {
+        if (data[i] > max_value) {
+            max_value = data[i];
+            max_index = i;
         }
+    }
 
-        return min_index;
+    return max_index;
+}
+
+template <typename T>
+int argmin_of(const T* data, int n) {
+    if constexpr (std::is_same<T, int>::value) {
+        return simd::kernels().argmin(data, n);
+    }
+
+    T min_value = data[0];
+    int min_index = 0;
+
+    for (int i = 1; i < n; i++) {
+        if (data[i] < min_value) {
+            min_value = data[i];
+            min_index = i;
+        }
+    }
+
+    return min_index;
+}
+
+template <typename T>
+int count_of(const T* data, int n, const T& value) {
+    if constexpr (std::is_same<T, int>::value) {
+        return simd::kernels().count(data, n, value);
+    }
+
+    int count = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (data[i] == value) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+} // namespace reduce
+
+/**
+ * @brief A fixed set of worker threads that run the chunks of parallel scans.
+ *
+ * run() hands out task indices to the workers and to the calling thread and
+ * returns once every task is done. One job runs at a time, so a task must not
+ * call run() itself.
+ */
+class ThreadPool {
+private:
+    // One call to run(). Lives on the caller's stack until every worker that
+    // picked it up has let go of it.
+    struct Job {
+        const std::function<void(int)>* task;
+        int tasks;
+        std::atomic<int> next{0};
+        int finished = 0;
+        int active = 0;
+    };
+
+    std::vector<std::thread> _workers;
+    std::mutex _run_mutex;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    Job* _job = nullptr;
+    long _generation = 0;
+    bool _stop = false;
+
+    // Run tasks of the job until there are none left, returning how many ran
+    static int drain(Job& job) {
+        int done = 0;
+        for (int i = job.next++; i < job.tasks; i = job.next++) {
+            (*job.task)(i);
+            done++;
+        }
+        return done;
+    }
+
+    void work() {
+        long seen = 0;
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true) {
+            _wake.wait(lock, [&] { return _stop || (_job != nullptr && _generation != seen); });
+            if (_stop) {
+                return;
+            }
+            seen = _generation;
+            Job* job = _job;
+            job->active++;
+
+            lock.unlock();
+            int done = drain(*job);
+            lock.lock();
+
+            job->finished += done;
+            job->active--;
+            if (job->finished == job->tasks && job->active == 0) {
+                _done.notify_all();
+            }
+        }
+    }
+
+public:
+    // Start a pool where run() uses the given number of threads, the caller included
+    explicit ThreadPool(int threads) {
+        for (int i = 1; i < threads; i++) {
+            _workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (std::thread& worker : _workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads taking part in run(), the caller included
+    int size() {
+        return _workers.size() + 1;
+    }
+
+    /**
+     * @brief Run task(i) for every i in [0, tasks) and wait for all of them.
+     * A single task runs directly on the calling thread.
+     *
+     * @param tasks The number of tasks
+     * @param task The function to run for each task index
+     */
+    void run(int tasks, const std::function<void(int)>& task) {
+        if (tasks <= 0) {
+            return;
+        }
+        if (tasks == 1 || _workers.empty()) {
+            for (int i = 0; i < tasks; i++) {
+                task(i);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> run_lock(_run_mutex);
+        Job job;
+        job.task = &task;
+        job.tasks = tasks;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _job = &job;
+            _generation++;
+        }
+        _wake.notify_all();
+
+        int done = drain(job);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        job.finished += done;
+        _done.wait(lock, [&] { return job.finished == job.tasks && job.active == 0; });
+        _job = nullptr;
+    }
+
+    // The shared pool with one thread per hardware thread
+    static ThreadPool& instance() {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+        return pool;
+    }
+};
+
+/**
+ * @brief How to split a scan over an ArrayList between threads.
+ *
+ * The list is cut into at most threads chunks of at least min_chunk elements,
+ * so lists shorter than 2 * min_chunk are scanned serially by the caller.
+ * Partial results are always combined in chunk order, which makes the result
+ * independent of how the threads were scheduled.
+ */
+struct ParallelPolicy {
+    // Number of threads to use, 0 means every thread in the pool
+    int threads = 0;
+    // Smallest number of elements worth handing to a thread
+    int min_chunk = 1 << 16;
+    // Pool to run on, nullptr means the shared ThreadPool::instance()
+    ThreadPool* pool = nullptr;
+
+    ThreadPool& thread_pool() {
+        return pool != nullptr ? *pool : ThreadPool::instance();
+    }
+
+    // Number of chunks to split n elements into. Short lists are decided
+    // before looking at the pool, so they never start the shared one.
+    int chunks(int n) {
+        if (n / std::max(min_chunk, 1) < 2) {
+            return 1;
+        }
+        int pool_threads = thread_pool().size();
+        int max_threads = threads > 0 ? std::min(threads, pool_threads) : pool_threads;
+        return std::max(1, std::min(max_threads, n / std::max(min_chunk, 1)));
+    }
+};
+
+// Uninitialized room for the first N elements of a list, inside the list itself
+template <typename T, int N>
+struct InlineStorage {
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+
+    T* data() {
+        return reinterpret_cast<T*>(bytes);
+    }
+};
+
+template <typename T>
+struct InlineStorage<T, 0> {
+    T* data() {
+        return nullptr;
+    }
+};
+
+/**
+ * @brief Dynamic array of T.
+ *
+ * The first InlineCapacity elements are stored inside the list object, and
+ * the buffer only moves to the heap once they overflow. Without inline
+ * storage an empty list has no buffer at all; it is allocated on the first
+ * append.
+ */
+template <typename T = int, typename Allocator = std::allocator<T>, int InlineCapacity = 0>
+class ArrayList {
+public:
+    // The elements are contiguous, so plain pointers are random-access iterators
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    // Trivially copyable elements can be moved around with memcpy/memmove,
+    // everything else has to be move-constructed one element at a time.
+    static constexpr bool bitwise_movable = std::is_trivially_copyable<T>::value;
+    // Moving a list only moves elements one by one when they are inline
+    static constexpr bool nothrow_move = InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value;
+
+    Allocator _alloc;
+    GrowthPolicy _policy;
+    InlineStorage<T, InlineCapacity> _inline;
+    T* _data = _inline.data();
+    int _capacity = InlineCapacity;
+    int _size = 0;
+    // Owns the buffer when it was adopted from a std::vector
+    std::unique_ptr<std::vector<T>> _owner;
+
+    // Check if the elements live in a heap buffer
+    bool on_heap() {
+        return _data != nullptr && _data != _inline.data();
+    }
+
+    // Give the heap buffer back, if there is one
+    void release_buffer() {
+        if (_owner) {
+            _owner.reset();
+        } else if (on_heap()) {
+            alloc_traits::deallocate(_alloc, _data, _capacity);
+        }
+    }
+
+    // Destroy the elements, free the buffer and go back to an empty list
+    void clear_storage() {
+        destroy_elements(_size);
+        release_buffer();
+        _data = _inline.data();
+        _capacity = InlineCapacity;
+        _size = 0;
+    }
+
+    // Copy n elements into the (empty) buffer, which must have room for them
+    void copy_from(const T* src, int n) {
+        if constexpr (bitwise_movable) {
+            if (n > 0) {
+                std::memcpy(static_cast<void*>(_data), static_cast<const void*>(src), n * sizeof(T));
+            }
+        } else {
+            for (int i = 0; i < n; i++) {
+                alloc_traits::construct(_alloc, _data + i, src[i]);
+            }
+        }
+        _size = n;
+    }
+
+    // Take over the elements of an empty-handed other list: its heap buffer
+    // is stolen in O(1), inline elements are moved one by one. Without inline
+    // storage a list off the heap is empty, and its data may be null.
+    void take(ArrayList& other) {
+        if (other._owner || other.on_heap()) {
+            _data = other._data;
+            _capacity = other._capacity;
+            _owner = std::move(other._owner);
+        } else if constexpr (InlineCapacity > 0) {
+            relocate(_data, other._data, other._size);
+        }
+        _size = other._size;
+
+        other._data = other._inline.data();
+        other._capacity = InlineCapacity;
+        other._size = 0;
+    }
+
+    // Move n elements from src into the uninitialized memory at dst
+    void relocate(T* dst, T* src, int n) {
+        if constexpr (bitwise_movable) {
+            if (n > 0) {
+                std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+            }
+        } else {
+            for (int i = 0; i < n; i++) {
+                alloc_traits::construct(_alloc, dst + i, std::move(src[i]));
+                alloc_traits::destroy(_alloc, src + i);
+            }
+        }
+    }
+
+    // Destroy the n first elements of the buffer
+    void destroy_elements(int n) {
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            for (int i = 0; i < n; i++) {
+                alloc_traits::destroy(_alloc, _data + i);
+            }
+        }
+    }
+
+    // Move the elements over to a new buffer with the given capacity, which
+    // is the inline storage if they fit there
+    void reallocate(int new_capacity) {
+        T* new_data;
+        if (new_capacity <= InlineCapacity) {
+            new_data = _inline.data();
+            new_capacity = InlineCapacity;
+        } else {
+            new_data = alloc_traits::allocate(_alloc, new_capacity);
+        }
+
+        relocate(new_data, _data, _size);
+        release_buffer();
+
+        _data = new_data;
+        _capacity = new_capacity;
+    }
+
+    // Open a hole at index by moving [index, _size) one slot to the right.
+    // The slot at index is left holding a (moved-from) live element unless
+    // index == _size. Requires _size < _capacity.
+    void shift_right(int index) {
+        if constexpr (bitwise_movable) {
+            std::memmove(static_cast<void*>(_data + index + 1), static_cast<const void*>(_data + index),
+                         (_size - index) * sizeof(T));
+        } else if (index < _size) {
+            alloc_traits::construct(_alloc, _data + _size, std::move(_data[_size - 1]));
+            std::move_backward(_data + index, _data + _size - 1, _data + _size);
+        }
+    }
+
+    // Close the slot at index by moving (index, _size) one slot to the left
+    // and destroying the element that ends up past the end.
+    void shift_left(int index) {
+        if constexpr (bitwise_movable) {
+            std::memmove(static_cast<void*>(_data + index), static_cast<const void*>(_data + index + 1),
+                         (_size - index - 1) * sizeof(T));
+        } else {
+            std::move(_data + index + 1, _data + _size, _data + index);
+            alloc_traits::destroy(_alloc, _data + _size - 1);
+        }
+    }
+
+    // Method for increasing the capacity of the array
+    void resize() {
+        if (_capacity == 0) {
+            // First allocation of a list without inline storage
+            reallocate(std::max(_policy.min_capacity, 1));
+        } else {
+            reallocate(next_capacity(_capacity));
+        }
+    }
+
+    // The capacity after capacity on the growth ladder, always strictly larger
+    int next_capacity(int capacity) {
+        return std::max(capacity + 1, _policy.grow(capacity));
+    }
+
+    // Check if less of the capacity than the policy allows is used
+    bool should_shrink() {
+        return !_policy.never_shrink && _capacity > _policy.min_capacity
+            && _size < _policy.shrink_threshold * _capacity;
+    }
+
+    void shrink_to_fit() {
+        int new_capacity = std::max(_policy.min_capacity, 1);
+
+        while (new_capacity < _size * _policy.shrink_headroom) {
+            new_capacity = next_capacity(new_capacity);
+        }
+
+        if (std::max(new_capacity, InlineCapacity) >= _capacity) {
+            // No need to reduce, the capacity is already suitable.
+            return;
+        }
+
+        reallocate(new_capacity);
+    }
+
+    // Cut the buffer into chunks of almost equal size, run scan(data, n) on
+    // each of them in the thread pool and return the results in chunk order.
+    // A single chunk is scanned by the caller without touching the pool.
+    template <typename Result, typename Scan>
+    std::unique_ptr<Result[]> scan_chunks(ParallelPolicy& policy, int chunks, Scan scan) {
+        std::unique_ptr<Result[]> partial(new Result[chunks]);
+        if (chunks == 1) {
+            partial[0] = scan(_data, _size);
+            return partial;
+        }
+        int chunk_size = _size / chunks;
+        int remainder = _size % chunks;
+
+        policy.thread_pool().run(chunks, [&](int chunk) {
+            int begin = chunk * chunk_size + std::min(chunk, remainder);
+            int n = chunk_size + (chunk < remainder ? 1 : 0);
+            partial[chunk] = scan(_data + begin, n);
+        });
+        return partial;
+    }
+
+public:
+    // Default constructor
+    ArrayList() {
+    }
+
+    // Constructor for an empty list with a given growth policy. It is a
+    // template so that a braced list like {0, 1} never converts to a policy.
+    template <typename Policy, typename = std::enable_if_t<std::is_same<Policy, GrowthPolicy>::value>>
+    explicit ArrayList(Policy policy) : _policy(policy) {
+    }
+
+    // Constructor for a list of values
+    ArrayList(std::vector<T> values, GrowthPolicy policy = GrowthPolicy{}) : _policy(policy) {
+        _size = values.size();
+
+        // Allocate memory to match the input size, unless it fits inline
+        if (_size > InlineCapacity) {
+            _capacity = std::max(_size, _policy.min_capacity);
+            _data = alloc_traits::allocate(_alloc, _capacity);
+        }
+
+        // Copy elements from the vector
+        if constexpr (bitwise_movable) {
+            if (_size > 0) {
+                std::memcpy(static_cast<void*>(_data), static_cast<const void*>(values.data()), _size * sizeof(T));
+            }
+        } else {
+            for (int i = 0; i < _size; i++) {
+                alloc_traits::construct(_alloc, _data + i, std::move(values[i]));
+            }
+        }
+    }
+
+    // Copy constructor, trivially copyable elements are copied with one memcpy
+    ArrayList(const ArrayList& other)
+        : _alloc(alloc_traits::select_on_container_copy_construction(other._alloc)), _policy(other._policy) {
+        if (other._size > InlineCapacity) {
+            _capacity = std::max(other._size, _policy.min_capacity);
+            _data = alloc_traits::allocate(_alloc, _capacity);
+        }
+        copy_from(other._data, other._size);
+    }
+
+    // Move constructor, takes over the other list's buffer in O(1) and leaves
+    // it empty. Inline elements are moved one by one.
+    ArrayList(ArrayList&& other) noexcept(nothrow_move) : _alloc(std::move(other._alloc)), _policy(other._policy) {
+        take(other);
+    }
+
+    // Destructor
+    ~ArrayList() {
+        destroy_elements(_size);
+        release_buffer();
+    }
+
+    ArrayList& operator=(const ArrayList& other) {
+        if (this != &other) {
+            ArrayList copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    ArrayList& operator=(ArrayList&& other) noexcept(nothrow_move) {
+        if (this != &other) {
+            clear_storage();
+            _alloc = std::move(other._alloc);
+            _policy = other._policy;
+            take(other);
+        }
+        return *this;
+    }
+
+    // Exchange the contents of two lists, O(1) unless they use inline storage
+    void swap(ArrayList& other) noexcept(nothrow_move) {
+        ArrayList tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    /**
+     * @brief Make a list that takes over the buffer of a vector instead of
+     * copying it. Trivially copyable elements stay where they are and the
+     * whole capacity of the vector is used; other element types are moved
+     * into a new buffer.
+     *
+     * @param values The vector to take the buffer from
+     * @return ArrayList The list
+     */
+    static ArrayList adopt(std::vector<T>&& values) {
+        ArrayList list;
+        if constexpr (bitwise_movable && std::is_trivially_destructible<T>::value) {
+            if (values.capacity() > 0) {
+                list._owner.reset(new std::vector<T>(std::move(values)));
+                list._data = list._owner->data();
+                list._size = list._owner->size();
+                list._capacity = list._owner->capacity();
+            }
+        } else {
+            list = ArrayList(std::move(values));
+        }
+        return list;
+    }
+
+    /**
+     * @brief Make a list that takes ownership of a raw buffer.
+     *
+     * @param data Buffer from Allocator::allocate(capacity)
+     * @param size Number of constructed elements at the start of the buffer
+     * @param capacity Number of elements the buffer has room for
+     * @return ArrayList The list
+     */
+    static ArrayList adopt(T* data, int size, int capacity) {
+        if (size < 0 || size > capacity) {
+            throw std::invalid_argument("Size must be between 0 and the capacity");
+        }
+        ArrayList list;
+        if (data != nullptr) {
+            list._data = data;
+            list._size = size;
+            list._capacity = capacity;
+        }
+        return list;
+    }
+
+    // Length of array
+    // Get the current size of the array
+    int length() {
+        return _size;
+    }
+
+    // Retrieve the array's maximum capacity
+    int capacity() {
+        return _capacity;
+    }
+
+    // The policy used when growing and shrinking the buffer
+    GrowthPolicy growth_policy() {
+        return _policy;
+    }
+
+    /**
+     * @brief Change the growth policy. It takes effect the next time the
+     * buffer grows or shrinks.
+     *
+     * @param policy The new policy
+     */
+    void set_growth_policy(GrowthPolicy policy) {
+        _policy = policy;
+    }
+
+    // Check if the elements are stored inside the list object
+    bool is_inline() {
+        return InlineCapacity > 0 && _data == _inline.data();
+    }
+
+    // Iterators over the elements. Any insertion or removal may move the
+    // elements and invalidate them.
+    iterator begin() {
+        return _data;
+    }
+
+    iterator end() {
+        return _data + _size;
+    }
+
+    const_iterator begin() const {
+        return _data;
+    }
+
+    const_iterator end() const {
+        return _data + _size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param n The value to be appended
+     */
+    void append(T value) {
+        if (_size >= _capacity) {
+            resize();
+        }
+
+        alloc_traits::construct(_alloc, _data + _size, std::move(value));
+        _size++;
+    }
+
+    /**
+     * @brief Get value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T The value at that index
+     */
+    T get(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+        return _data[index];
+    }
+
+    /**
+     * @brief Prints the array
+     *
+     */
+    void print() {
+        std::cout << "[";
+        for (int i = 0; i < _size - 1; i++) {
+            std::cout << _data[i] << ", ";
+        }
+        if (_size > 0) {
+            std::cout << _data[_size - 1];
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get a reference to the value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T& The value at that index
+     */
+    T &operator[](int index) {
+        if (index < 0 || index >= _size) {
+            throw std::range_error("Index is out of bounds");
+        }
+        return _data[index];
+    }
+
+    /**
+     * @brief get a value and an index.
+     * throw an error if the index is out of bounds
+     *
+     * increase size by 1
+     *
+     * move values to the right of the index by one index up.
+     *
+     * @param val the value
+     * @param index the index
+     *
+     */
+    void insert(T value, int index) {
+        if (index < 0 || index > _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        if (_size >= _capacity) {
+            resize();
+        }
+
+        if (index == _size) {
+            append(std::move(value));
+        } else {
+            shift_right(index);
+            if constexpr (bitwise_movable) {
+                alloc_traits::construct(_alloc, _data + index, std::move(value));
+            } else {
+                _data[index] = std::move(value);
+            }
+            _size++;
+        }
+    }
+
+    /**
+     * @brief Insert a value in front of the element an iterator points to
+     *
+     * @param position The iterator, end() to append
+     * @param value The value
+     * @return iterator The inserted element
+     */
+    iterator insert_before(iterator position, T value) {
+        int index = position - _data;
+        insert(std::move(value), index);
+        return _data + index;
+    }
+
+    /**
+     * @brief Remove the element an iterator points to
+     *
+     * @param position The iterator
+     * @return iterator The element after the removed one
+     */
+    iterator erase(iterator position) {
+        int index = position - _data;
+        remove(index);
+        return _data + index;
+    }
+
+    /**
+     * @brief Remove the elements in [first, last) with a single shift of the
+     * elements after them, e.g. after std::remove_if
+     *
+     * @param first The first element to remove
+     * @param last The element after the last one to remove
+     * @return iterator The element after the removed ones
+     */
+    iterator erase(iterator first, iterator last) {
+        int index = first - _data;
+        int count = last - first;
+        if (index < 0 || count < 0 || index + count > _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+        if (count == 0) {
+            return first;
+        }
+
+        if constexpr (bitwise_movable) {
+            std::memmove(static_cast<void*>(first), static_cast<const void*>(last),
+                         (_size - index - count) * sizeof(T));
+        } else {
+            std::move(last, end(), first);
+            for (int i = _size - count; i < _size; i++) {
+                alloc_traits::destroy(_alloc, _data + i);
+            }
+        }
+        _size -= count;
+
+        if (should_shrink()) {
+            shrink_to_fit();
+        }
+        return _data + index;
+    }
+
+    /**
+     * @brief deletes the element from the list.
+     *
+     * @param index the index
+     *
+     */
+    void remove(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        shift_left(index);
+        _size--;
+
+        // Check if the array can be resized to fit if less of the allocated capacity is used than the policy allows
+        if (should_shrink()) {
+            shrink_to_fit();
+        }
+    }
+
+    /***
+     * @brief removing an element at a given index
+     *
+     * @param index
+     * @return T the value at that index
+     */
+
+    T pop(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        T old_value = std::move(_data[index]);
+
+        // Move the elements to fill the gap left by the removed element
+        shift_left(index);
+        _size--;
+
+        // Check if the array can be resized to fit if less of the allocated capacity is used than the policy allows
+        if (should_shrink()) {
+            shrink_to_fit();
+        }
+
+        return old_value;
+    }
+
+    /**
+     * @brief removing the last element in the list
+     *
+     * @return T the last element
+     */
+    T pop() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot pop");
+        }
+
+        T old_value = std::move(_data[_size - 1]);
+        alloc_traits::destroy(_alloc, _data + _size - 1);
+        _size--;
+
+        // Check if the array can be resized to fit if less of the allocated capacity is used than the policy allows
+        if (should_shrink()) {
+            shrink_to_fit();
+        }
+
+        return old_value;
+    }
+
+    T max() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find max");
+        }
+
+        return reduce::max_of(_data, _size);
+    }
+
+    T min() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find min");
+        }
+
+        return reduce::min_of(_data, _size);
+    }
+
+    int argmax() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmax");
+        }
+
+        return reduce::argmax_of(_data, _size);
+    }
+
+    int argmin() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmin");
+        }
+
+        return reduce::argmin_of(_data, _size);
+    }
+
+    int count(const T& value) {
+        return reduce::count_of(_data, _size, value);
+    }
+
+    /**
+     * @brief Find the largest value with the work split between threads
+     *
+     * @param policy How to split the list into chunks
+     * @return T The largest value
+     */
+    T max(ParallelPolicy policy) {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find max");
+        }
+
+        int chunks = policy.chunks(_size);
+        std::unique_ptr<T[]> partial = scan_chunks<T>(policy, chunks, [](const T* data, int n) { return reduce::max_of(data, n); });
+        return reduce::max_of(partial.get(), chunks);
+    }
+
+    /**
+     * @brief Find the smallest value with the work split between threads
+     *
+     * @param policy How to split the list into chunks
+     * @return T The smallest value
+     */
+    T min(ParallelPolicy policy) {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find min");
+        }
+
+        int chunks = policy.chunks(_size);
+        std::unique_ptr<T[]> partial = scan_chunks<T>(policy, chunks, [](const T* data, int n) { return reduce::min_of(data, n); });
+        return reduce::min_of(partial.get(), chunks);
+    }
+
+    /**
+     * @brief Find the first index of the largest value with the work split
+     * between threads
+     *
+     * @param policy How to split the list into chunks
+     * @return int The index
+     */
+    int argmax(ParallelPolicy policy) {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmax");
+        }
+
+        int chunks = policy.chunks(_size);
+        std::unique_ptr<int[]> partial = scan_chunks<int>(policy, chunks, [this](const T* data, int n) {
+            return (int)(data - _data) + reduce::argmax_of(data, n);
+        });
+
+        // Earlier chunks win ties
+        int max_index = partial[0];
+        for (int chunk = 1; chunk < chunks; chunk++) {
+            if (_data[partial[chunk]] > _data[max_index]) {
+                max_index = partial[chunk];
+            }
+        }
+        return max_index;
+    }
+
+    /**
+     * @brief Find the first index of the smallest value with the work split
+     * between threads
+     *
+     * @param policy How to split the list into chunks
+     * @return int The index
+     */
+    int argmin(ParallelPolicy policy) {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmin");
+        }
+
+        int chunks = policy.chunks(_size);
+        std::unique_ptr<int[]> partial = scan_chunks<int>(policy, chunks, [this](const T* data, int n) {
+            return (int)(data - _data) + reduce::argmin_of(data, n);
+        });
+
+        // Earlier chunks win ties
+        int min_index = partial[0];
+        for (int chunk = 1; chunk < chunks; chunk++) {
+            if (_data[partial[chunk]] < _data[min_index]) {
+                min_index = partial[chunk];
+            }
+        }
+        return min_index;
+    }
+
+    /**
+     * @brief Count the occurrences of a value with the work split between
+     * threads
+     *
+     * @param value The value to count
+     * @param policy How to split the list into chunks
+     * @return int The number of occurrences
+     */
+    int count(const T& value, ParallelPolicy policy) {
+        int chunks = policy.chunks(_size);
+        std::unique_ptr<int[]> partial = scan_chunks<int>(policy, chunks, [&value](const T* data, int n) {
+            return reduce::count_of(data, n, value);
+        });
+
+        int count = 0;
+        for (int chunk = 0; chunk < chunks; chunk++) {
+            count += partial[chunk];
+        }
+        return count;
+    }
+};
+
+
+/**
+ * @brief ArrayList variant that keeps its elements in a ring buffer.
+ *
+ * The elements start at a movable head offset and wrap around the end of the
+ * buffer, so adding or removing at the front is O(1) amortized just like at
+ * the back, while indexing stays O(1). Inserting or removing in the middle
+ * moves whichever side of the index is shorter. The capacity is always a
+ * power of two so that wrapping an index is a single mask.
+ */
+template <typename T = int, typename Allocator = std::allocator<T>>
+class CircularArrayList {
+private:
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+    static constexpr bool bitwise_movable = std::is_trivially_copyable<T>::value;
+
+    Allocator _alloc;
+    T* _data;
+    int _capacity = 1;
+    int _head = 0;
+    int _size = 0;
+
+    // Position in the buffer of the element at the given index
+    int slot(int index) {
+        return (_head + index) & (_capacity - 1);
+    }
+
+    // Move n elements from src into the uninitialized memory at dst
+    void relocate(T* dst, T* src, int n) {
+        if constexpr (bitwise_movable) {
+            if (n > 0) {
+                std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+            }
+        } else {
+            for (int i = 0; i < n; i++) {
+                alloc_traits::construct(_alloc, dst + i, std::move(src[i]));
+                alloc_traits::destroy(_alloc, src + i);
+            }
+        }
+    }
+
+    // Move the elements to a new buffer with the given capacity, unwrapping
+    // them so that the head ends up at the start of the buffer
+    void reallocate(int new_capacity) {
+        T* new_data = alloc_traits::allocate(_alloc, new_capacity);
+
+        int first = std::min(_size, _capacity - _head);
+        relocate(new_data, _data + _head, first);
+        relocate(new_data + first, _data, _size - first);
+        alloc_traits::deallocate(_alloc, _data, _capacity);
+
+        _data = new_data;
+        _capacity = new_capacity;
+        _head = 0;
+    }
+
+    // Method for increasing the capacity of the array
+    void resize() {
+        reallocate(_capacity * 2);
+    }
+
+    void shrink_to_fit() {
+        int new_capacity = 1;
+
+        while (new_capacity < _size) {
+            new_capacity *= 2;
+        }
+
+        if (new_capacity == _capacity) {
+            // No need to reduce, the capacity is already suitable.
+            return;
+        }
+
+        reallocate(new_capacity);
+    }
+
+    // The elements as at most two contiguous runs: [_data + _head, first) and
+    // [_data, _size - first)
+    int first_run() {
+        return std::min(_size, _capacity - _head);
+    }
+
+public:
+    // Default constructor
+    CircularArrayList() {
+        _data = alloc_traits::allocate(_alloc, _capacity);
+    }
+
+    // Constructor for a list of values
+    CircularArrayList(std::vector<T> values) {
+        while (_capacity < (int)values.size()) {
+            _capacity *= 2;
+        }
+        _data = alloc_traits::allocate(_alloc, _capacity);
+        for (T& value : values) {
+            alloc_traits::construct(_alloc, _data + _size, std::move(value));
+            _size++;
+        }
+    }
+
+    // Destructor
+    ~CircularArrayList() {
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            for (int i = 0; i < _size; i++) {
+                alloc_traits::destroy(_alloc, _data + slot(i));
+            }
+        }
+        alloc_traits::deallocate(_alloc, _data, _capacity);
+    }
+
+    CircularArrayList(const CircularArrayList&) = delete;
+    CircularArrayList& operator=(const CircularArrayList&) = delete;
+
+    // Get the current size of the array
+    int length() {
+        return _size;
+    }
+
+    // Retrieve the array's maximum capacity
+    int capacity() {
+        return _capacity;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param value The value to be appended
+     */
+    void append(T value) {
+        if (_size >= _capacity) {
+            resize();
+        }
+
+        alloc_traits::construct(_alloc, _data + slot(_size), std::move(value));
+        _size++;
+    }
+
+    /**
+     * @brief Add element to the beginning of the list
+     *
+     * @param value The value to be added
+     */
+    void push_front(T value) {
+        if (_size >= _capacity) {
+            resize();
+        }
+
+        _head = (_head - 1) & (_capacity - 1);
+        alloc_traits::construct(_alloc, _data + _head, std::move(value));
+        _size++;
+    }
+
+    /**
+     * @brief Get value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T The value at that index
+     */
+    T get(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+        return _data[slot(index)];
+    }
+
+    /**
+     * @brief Prints the array
+     *
+     */
+    void print() {
+        std::cout << "[";
+        for (int i = 0; i < _size; i++) {
+            std::cout << _data[slot(i)];
+            if (i < _size - 1) {
+                std::cout << ", ";
+            }
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get a reference to the value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T& The value at that index
+     */
+    T &operator[](int index) {
+        if (index < 0 || index >= _size) {
+            throw std::range_error("Index is out of bounds");
+        }
+        return _data[slot(index)];
+    }
+
+    /**
+     * @brief Insert a value before the given index, moving the shorter side
+     * of the list one step out of the way.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param value the value
+     * @param index the index
+     */
+    void insert(T value, int index) {
+        if (index < 0 || index > _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        if (index == 0) {
+            push_front(std::move(value));
+            return;
+        }
+        if (index == _size) {
+            append(std::move(value));
+            return;
+        }
+
+        if (_size >= _capacity) {
+            resize();
+        }
+
+        if (index < _size / 2) {
+            // Move the elements before index one step towards the front
+            int new_head = (_head - 1) & (_capacity - 1);
+            alloc_traits::construct(_alloc, _data + new_head, std::move(_data[_head]));
+            for (int i = 0; i < index - 1; i++) {
+                _data[slot(i)] = std::move(_data[slot(i + 1)]);
+            }
+            _data[slot(index - 1)] = std::move(value);
+            _head = new_head;
+        } else {
+            // Move the elements from index one step towards the back
+            alloc_traits::construct(_alloc, _data + slot(_size), std::move(_data[slot(_size - 1)]));
+            for (int i = _size - 1; i > index; i--) {
+                _data[slot(i)] = std::move(_data[slot(i - 1)]);
+            }
+            _data[slot(index)] = std::move(value);
+        }
+        _size++;
+    }
+
+    /**
+     * @brief deletes the element from the list, closing the gap from the
+     * shorter side.
+     *
+     * @param index the index
+     */
+    void remove(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        if (index < _size / 2) {
+            for (int i = index; i > 0; i--) {
+                _data[slot(i)] = std::move(_data[slot(i - 1)]);
+            }
+            alloc_traits::destroy(_alloc, _data + _head);
+            _head = (_head + 1) & (_capacity - 1);
+        } else {
+            for (int i = index; i < _size - 1; i++) {
+                _data[slot(i)] = std::move(_data[slot(i + 1)]);
+            }
+            alloc_traits::destroy(_alloc, _data + slot(_size - 1));
+        }
+        _size--;
+
+        // Check if the array can be resized to fit if less than 25% of the allocated capacity is used
+        if (_size < 0.25 * _capacity) {
+            shrink_to_fit();
+        }
+    }
+
+    /***
+     * @brief removing an element at a given index
+     *
+     * @param index
+     * @return T the value at that index
+     */
+    T pop(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        T old_value = std::move(_data[slot(index)]);
+        remove(index);
+        return old_value;
+    }
+
+    /**
+     * @brief removing the last element in the list
+     *
+     * @return T the last element
+     */
+    T pop() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot pop");
+        }
+
+        return pop(_size - 1);
+    }
+
+    T max() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find max");
+        }
+
+        int first = first_run();
+        T max_value = reduce::max_of(_data + _head, first);
+        if (first < _size) {
+            max_value = std::max(max_value, reduce::max_of(_data, _size - first));
+        }
+        return max_value;
+    }
+
+    T min() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find min");
+        }
+
+        int first = first_run();
+        T min_value = reduce::min_of(_data + _head, first);
+        if (first < _size) {
+            min_value = std::min(min_value, reduce::min_of(_data, _size - first));
+        }
+        return min_value;
+    }
+
+    int argmax() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmax");
+        }
+
+        int first = first_run();
+        int max_index = reduce::argmax_of(_data + _head, first);
+        if (first < _size) {
+            int wrapped = reduce::argmax_of(_data, _size - first);
+            if (_data[wrapped] > _data[_head + max_index]) {
+                max_index = first + wrapped;
+            }
+        }
+        return max_index;
+    }
+
+    int argmin() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmin");
+        }
+
+        int first = first_run();
+        int min_index = reduce::argmin_of(_data + _head, first);
+        if (first < _size) {
+            int wrapped = reduce::argmin_of(_data, _size - first);
+            if (_data[wrapped] < _data[_head + min_index]) {
+                min_index = first + wrapped;
+            }
+        }
+        return min_index;
+    }
+
+    int count(const T& value) {
+        int first = first_run();
+        return reduce::count_of(_data + _head, first, value) + reduce::count_of(_data, _size - first, value);
+    }
+};
+
+
+/**
+ * @brief List with the ArrayList interface stored as a tiered vector: a row
+ * of fixed-size circular blocks where every block but the last one is full.
+ *
+ * Indexing is one shift and one mask. Inserting or removing at an index
+ * shifts the elements inside one block and then passes a single element
+ * from block to block through their ring heads, so with blocks of about
+ * sqrt(N) elements every positional edit is O(sqrt N). The block size is
+ * doubled or halved (rebuilding the list) as the list grows or shrinks.
+ * T must be default constructible.
+ */
+template <typename T = int>
+class TieredVector {
+private:
+    // A ring of _block_size slots
+    struct Block {
+        std::unique_ptr<T[]> data;
+        int head = 0;
+        int size = 0;
+    };
+
+    std::vector<Block> _blocks;
+    int _shift = 4;
+    int _block_size = 1 << 4;
+    int _size = 0;
+
+    static constexpr int min_shift = 4;
+
+    T& at(Block& block, int offset) {
+        return block.data[(block.head + offset) & (_block_size - 1)];
+    }
+
+    Block new_block() {
+        Block block;
+        block.data.reset(new T[_block_size]);
+        return block;
+    }
+
+    void push_front(Block& block, T value) {
+        block.head = (block.head - 1) & (_block_size - 1);
+        block.data[block.head] = std::move(value);
+        block.size++;
+    }
+
+    void push_back(Block& block, T value) {
+        at(block, block.size) = std::move(value);
+        block.size++;
+    }
+
+    T pop_front(Block& block) {
+        T value = std::move(block.data[block.head]);
+        block.head = (block.head + 1) & (_block_size - 1);
+        block.size--;
+        return value;
+    }
+
+    T pop_back(Block& block) {
+        block.size--;
+        return std::move(at(block, block.size));
+    }
+
+    // Rebuild the list with blocks of 2^shift elements
+    void rebuild(int shift) {
+        std::vector<Block> old_blocks = std::move(_blocks);
+        int old_block_size = _block_size;
+        _blocks.clear();
+        _shift = shift;
+        _block_size = 1 << shift;
+        _size = 0;
+
+        for (Block& block : old_blocks) {
+            for (int i = 0; i < block.size; i++) {
+                append_element(std::move(block.data[(block.head + i) & (old_block_size - 1)]));
+            }
+        }
+    }
+
+    // Keep the number of blocks between a quarter of and twice the block size
+    void rebalance() {
+        int blocks = _blocks.size();
+        if (blocks > 2 * _block_size) {
+            rebuild(_shift + 1);
+        } else if (_shift > min_shift && blocks < _block_size / 4) {
+            rebuild(_shift - 1);
+        }
+    }
+
+    void append_element(T value) {
+        if (_blocks.empty() || _blocks.back().size == _block_size) {
+            _blocks.push_back(new_block());
+        }
+        push_back(_blocks.back(), std::move(value));
+        _size++;
+    }
+
+    // Find the smallest or largest element's index, earlier blocks winning ties
+    template <bool Smaller>
+    int arg_best() {
+        int best_index = 0;
+        int index = 0;
+        for (Block& block : _blocks) {
+            int first = std::min(block.size, _block_size - block.head);
+            const T* runs[2] = {block.data.get() + block.head, block.data.get()};
+            int lengths[2] = {first, block.size - first};
+            for (int run = 0; run < 2; run++) {
+                if (lengths[run] == 0) {
+                    continue;
+                }
+                int i = Smaller ? reduce::argmin_of(runs[run], lengths[run]) : reduce::argmax_of(runs[run], lengths[run]);
+                const T& candidate = runs[run][i];
+                const T& best = (*this)[best_index];
+                if (Smaller ? candidate < best : candidate > best) {
+                    best_index = index + i;
+                }
+                index += lengths[run];
+            }
+        }
+        return best_index;
+    }
+
+public:
+    // Default constructor
+    TieredVector() {
+    }
+
+    // Constructor for a list of values
+    TieredVector(std::vector<T> values) {
+        while ((1 << (2 * _shift)) < (int)values.size()) {
+            _shift++;
+        }
+        _block_size = 1 << _shift;
+        for (T& value : values) {
+            append_element(std::move(value));
+        }
+    }
+
+    // Length of array
+    int length() {
+        return _size;
+    }
+
+    // Number of elements that fit in the allocated blocks
+    int capacity() {
+        return _blocks.size() * _block_size;
+    }
+
+    // Number of elements per block
+    int block_size() {
+        return _block_size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param value The value to be appended
+     */
+    void append(T value) {
+        append_element(std::move(value));
+        rebalance();
+    }
+
+    /**
+     * @brief Get value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T The value at that index
+     */
+    T get(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+        return at(_blocks[index >> _shift], index & (_block_size - 1));
+    }
+
+    /**
+     * @brief Prints the array
+     *
+     */
+    void print() {
+        std::cout << "[";
+        for (int i = 0; i < _size; i++) {
+            std::cout << (*this)[i];
+            if (i < _size - 1) {
+                std::cout << ", ";
+            }
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get a reference to the value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T& The value at that index
+     */
+    T &operator[](int index) {
+        if (index < 0 || index >= _size) {
+            throw std::range_error("Index is out of bounds");
+        }
+        return at(_blocks[index >> _shift], index & (_block_size - 1));
+    }
+
+    /**
+     * @brief Insert a value before the given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param value the value
+     * @param index the index
+     */
+    void insert(T value, int index) {
+        if (index < 0 || index > _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        if (index == _size) {
+            append(std::move(value));
+            return;
+        }
+
+        if (_blocks.back().size == _block_size) {
+            _blocks.push_back(new_block());
+        }
+
+        // Make room in the target block by passing one element on from
+        // every block after it
+        int target = index >> _shift;
+        for (int b = _blocks.size() - 1; b > target; b--) {
+            push_front(_blocks[b], pop_back(_blocks[b - 1]));
+        }
+
+        Block& block = _blocks[target];
+        int offset = index & (_block_size - 1);
+        for (int i = block.size; i > offset; i--) {
+            at(block, i) = std::move(at(block, i - 1));
+        }
+        at(block, offset) = std::move(value);
+        block.size++;
+        _size++;
+
+        rebalance();
+    }
+
+    /**
+     * @brief deletes the element from the list.
+     *
+     * @param index the index
+     */
+    void remove(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        int target = index >> _shift;
+        Block& block = _blocks[target];
+        for (int i = index & (_block_size - 1); i < block.size - 1; i++) {
+            at(block, i) = std::move(at(block, i + 1));
+        }
+        block.size--;
+
+        // Fill the hole by pulling one element back from every later block
+        for (int b = target + 1; b < (int)_blocks.size(); b++) {
+            push_back(_blocks[b - 1], pop_front(_blocks[b]));
+        }
+        if (_blocks.back().size == 0) {
+            _blocks.pop_back();
+        }
+        _size--;
+
+        rebalance();
+    }
+
+    /***
+     * @brief removing an element at a given index
+     *
+     * @param index
+     * @return T the value at that index
+     */
+    T pop(int index) {
+        if (index < 0 || index >= _size) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        T old_value = std::move((*this)[index]);
+        remove(index);
+        return old_value;
+    }
+
+    /**
+     * @brief removing the last element in the list
+     *
+     * @return T the last element
+     */
+    T pop() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot pop");
+        }
+
+        return pop(_size - 1);
+    }
+
+    T max() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find max");
+        }
+
+        return (*this)[arg_best<false>()];
+    }
+
+    T min() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find min");
+        }
+
+        return (*this)[arg_best<true>()];
+    }
+
+    int argmax() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmax");
+        }
+
+        return arg_best<false>();
+    }
+
+    int argmin() {
+        if (_size == 0) {
+            throw std::underflow_error("List is empty, cannot find argmin");
+        }
+
+        return arg_best<true>();
+    }
+
+    int count(const T& value) {
+        int count = 0;
+        for (Block& block : _blocks) {
+            int first = std::min(block.size, _block_size - block.head);
+            count += reduce::count_of(block.data.get() + block.head, first, value);
+            count += reduce::count_of(block.data.get(), block.size - first, value);
+        }
+        return count;
+    }
+};
+
+
+/**
+ * @brief ArrayList variant for editing around a moving cursor, stored as a
+ * gap buffer.
+ *
+ * The free slots of the buffer form one gap, and the gap is moved to where
+ * the list is edited. Inserting or removing right at the gap is O(1);
+ * moving the gap to another index costs O(distance). A run of edits around
+ * the same cursor therefore never shifts the whole tail of the list the way
+ * ArrayList::insert does. T must be default constructible.
+ */
+template <typename T = int>
+class GapBuffer {
+private:
+    std::unique_ptr<T[]> _data;
+    int _capacity = 1;
+    // The gap is [_gap_start, _gap_end), elements live on both sides of it
+    int _gap_start = 0;
+    int _gap_end = 1;
+
+    int gap_length() {
+        return _gap_end - _gap_start;
+    }
+
+    // Position in the buffer of the element at the given index
+    int slot(int index) {
+        return index < _gap_start ? index : index + gap_length();
+    }
+
+    // Move the gap so that it starts at the given index
+    void move_gap(int index) {
+        if (index < _gap_start) {
+            std::move_backward(_data.get() + index, _data.get() + _gap_start, _data.get() + _gap_end);
+        } else if (index > _gap_start) {
+            std::move(_data.get() + _gap_end, _data.get() + _gap_end + (index - _gap_start), _data.get() + _gap_start);
+        }
+        _gap_end += index - _gap_start;
+        _gap_start = index;
+    }
+
+    // Move the elements to a new buffer, keeping the gap where it is
+    void reallocate(int new_capacity) {
+        std::unique_ptr<T[]> new_data(new T[new_capacity]);
+        int tail = _capacity - _gap_end;
+
+        std::move(_data.get(), _data.get() + _gap_start, new_data.get());
+        std::move(_data.get() + _gap_end, _data.get() + _capacity, new_data.get() + new_capacity - tail);
+
+        _data = std::move(new_data);
+        _capacity = new_capacity;
+        _gap_end = new_capacity - tail;
+    }
+
+    // Method for increasing the capacity of the array
+    void resize() {
+        reallocate(_capacity * 2);
+    }
+
+    void shrink_to_fit() {
+        int new_capacity = 1;
+
+        while (new_capacity < length()) {
+            new_capacity *= 2;
+        }
+
+        if (new_capacity == _capacity) {
+            // No need to reduce, the capacity is already suitable.
+            return;
+        }
+
+        reallocate(new_capacity);
+    }
+
+public:
+    // Default constructor
+    GapBuffer() : _data(new T[1]) {
+    }
+
+    // Constructor for a list of values
+    GapBuffer(std::vector<T> values) {
+        while (_capacity < (int)values.size()) {
+            _capacity *= 2;
+        }
+        _data.reset(new T[_capacity]);
+        std::move(values.begin(), values.end(), _data.get());
+        _gap_start = values.size();
+        _gap_end = _capacity;
+    }
+
+    // Length of array
+    int length() {
+        return _capacity - gap_length();
+    }
+
+    // Retrieve the array's maximum capacity
+    int capacity() {
+        return _capacity;
+    }
+
+    // Index where the gap sits, i.e. where the last edit happened
+    int cursor() {
+        return _gap_start;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param value The value to be appended
+     */
+    void append(T value) {
+        insert(std::move(value), length());
+    }
+
+    /**
+     * @brief Get value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T The value at that index
+     */
+    T get(int index) {
+        if (index < 0 || index >= length()) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+        return _data[slot(index)];
+    }
+
+    /**
+     * @brief Prints the array
+     *
+     */
+    void print() {
+        std::cout << "[";
+        for (int i = 0; i < length(); i++) {
+            std::cout << _data[slot(i)];
+            if (i < length() - 1) {
+                std::cout << ", ";
+            }
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get a reference to the value at a given index.
+     * Throws a range error if the index is out of bounds
+     *
+     * @param index The index
+     * @return T& The value at that index
+     */
+    T &operator[](int index) {
+        if (index < 0 || index >= length()) {
+            throw std::range_error("Index is out of bounds");
+        }
+        return _data[slot(index)];
+    }
+
+    /**
+     * @brief Insert a value before the given index, moving the gap there first
+     * Throws a range error if the index is out of bounds
+     *
+     * @param value the value
+     * @param index the index
+     */
+    void insert(T value, int index) {
+        if (index < 0 || index > length()) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        if (gap_length() == 0) {
+            resize();
+        }
+
+        move_gap(index);
+        _data[_gap_start++] = std::move(value);
+    }
+
+    /**
+     * @brief deletes the element from the list, moving the gap there first
+     *
+     * @param index the index
+     */
+    void remove(int index) {
+        if (index < 0 || index >= length()) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        move_gap(index);
+        _gap_end++;
+
+        // Check if the array can be resized to fit if less than 25% of the allocated capacity is used
+        if (length() < 0.25 * _capacity) {
+            shrink_to_fit();
+        }
+    }
+
+    /***
+     * @brief removing an element at a given index
+     *
+     * @param index
+     * @return T the value at that index
+     */
+    T pop(int index) {
+        if (index < 0 || index >= length()) {
+            throw std::out_of_range("Index is out of bounds");
+        }
+
+        T old_value = std::move(_data[slot(index)]);
+        remove(index);
+        return old_value;
+    }
+
+    /**
+     * @brief removing the last element in the list
+     *
+     * @return T the last element
+     */
+    T pop() {
+        if (length() == 0) {
+            throw std::underflow_error("List is empty, cannot pop");
+        }
+
+        return pop(length() - 1);
+    }
+
+    T max() {
+        if (length() == 0) {
+            throw std::underflow_error("List is empty, cannot find max");
+        }
+
+        return _data[slot(argmax())];
+    }
+
+    T min() {
+        if (length() == 0) {
+            throw std::underflow_error("List is empty, cannot find min");
+        }
+
+        return _data[slot(argmin())];
+    }
+
+    int argmax() {
+        if (length() == 0) {
+            throw std::underflow_error("List is empty, cannot find argmax");
+        }
+
+        int tail = _capacity - _gap_end;
+        if (_gap_start == 0) {
+            return reduce::argmax_of(_data.get() + _gap_end, tail);
+        }
+        int max_index = reduce::argmax_of(_data.get(), _gap_start);
+        if (tail > 0) {
+            int after = reduce::argmax_of(_data.get() + _gap_end, tail);
+            if (_data[_gap_end + after] > _data[max_index]) {
+                max_index = _gap_start + after;
+            }
+        }
+        return max_index;
+    }
+
+    int argmin() {
+        if (length() == 0) {
+            throw std::underflow_error("List is empty, cannot find argmin");
+        }
+
+        int tail = _capacity - _gap_end;
+        if (_gap_start == 0) {
+            return reduce::argmin_of(_data.get() + _gap_end, tail);
+        }
+        int min_index = reduce::argmin_of(_data.get(), _gap_start);
+        if (tail > 0) {
+            int after = reduce::argmin_of(_data.get() + _gap_end, tail);
+            if (_data[_gap_end + after] < _data[min_index]) {
+                min_index = _gap_start + after;
+            }
+        }
+        return min_index;
+    }
+
+    int count(const T& value) {
+        return reduce::count_of(_data.get(), _gap_start, value)
+            + reduce::count_of(_data.get() + _gap_end, _capacity - _gap_end, value);
+    }
+};
+
+
+/**
+ * @brief A recorded sequence of list operations, kept small enough to
+ * capture real traffic.
+ *
+ * Every operation is one opcode byte followed by its arguments as LEB128
+ * varints, values zigzag encoded so that small negative numbers stay short:
+ * an append of a small value takes two bytes. A trace file is the magic
+ * "LTRC", a version byte and the encoded operations. Only operations that
+ * succeeded are recorded, so every index in a trace is valid when the trace
+ * is replayed in order.
+ */
+class OperationTrace {
+public:
+    enum Op : unsigned char {
+        append = 1, // value
+        insert,     // value, index
+        remove,     // index
+        pop,        //
+        pop_at,     // index
+        get,        // index
+        min,        //
+        max,        //
+        count,      // value
+    };
+
+    // One decoded operation; arguments an operation doesn't have are 0
+    struct Operation {
+        Op op;
+        int value;
+        int index;
+    };
+
+private:
+    static constexpr unsigned char version = 1;
+
+    std::vector<unsigned char> _bytes;
+    int _length = 0;
+
+    static bool has_value(Op op) {
+        return op == append || op == insert || op == count;
+    }
+
+    static bool has_index(Op op) {
+        return op == insert || op == remove || op == pop_at || op == get;
+    }
+
+    void put_varint(unsigned int n) {
+        while (n >= 0x80) {
+            _bytes.push_back((unsigned char)(n | 0x80));
+            n >>= 7;
+        }
+        _bytes.push_back((unsigned char)n);
+    }
+
+    unsigned int get_varint(std::size_t& position) const {
+        unsigned int n = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (position >= _bytes.size()) {
+                throw std::runtime_error("Trace is truncated");
+            }
+            unsigned char byte = _bytes[position++];
+            n |= (unsigned int)(byte & 0x7f) << shift;
+            if (byte < 0x80) {
+                return n;
+            }
+        }
+        throw std::runtime_error("Trace has a malformed number");
+    }
+
+public:
+    // Number of operations
+    int length() const {
+        return _length;
+    }
+
+    std::size_t size_in_bytes() const {
+        return _bytes.size();
+    }
+
+    void record(Op op, int value = 0, int index = 0) {
+        _bytes.push_back(op);
+        if (has_value(op)) {
+            put_varint(((unsigned int)value << 1) ^ (unsigned int)(value >> 31));
+        }
+        if (has_index(op)) {
+            put_varint((unsigned int)index);
+        }
+        _length++;
+    }
+
+    std::vector<Operation> decode() const {
+        std::vector<Operation> operations;
+        operations.reserve(_length);
+        std::size_t position = 0;
+        while (position < _bytes.size()) {
+            Op op = (Op)_bytes[position++];
+            if (op < append || op > count) {
+                throw std::runtime_error("Trace has an unknown operation");
+            }
+            Operation operation{op, 0, 0};
+            if (has_value(op)) {
+                unsigned int n = get_varint(position);
+                operation.value = (int)(n >> 1) ^ -(int)(n & 1);
+            }
+            if (has_index(op)) {
+                operation.index = (int)get_varint(position);
+            }
+            operations.push_back(operation);
+        }
+        return operations;
+    }
+
+    void save(const std::string& path) const {
+        std::ofstream ofs{path, std::ios::binary};
+        if (!ofs) {
+            throw std::runtime_error("Unable to open file");
+        }
+        ofs.write("LTRC", 4);
+        ofs.put((char)version);
+        ofs.write((const char*)_bytes.data(), _bytes.size());
+    }
+
+    static OperationTrace load(const std::string& path) {
+        std::ifstream ifs{path, std::ios::binary};
+        if (!ifs) {
+            throw std::runtime_error("Unable to open file");
+        }
+        char header[5] = {};
+        ifs.read(header, 5);
+        if (!ifs || std::string(header, 4) != "LTRC" || header[4] != (char)version) {
+            throw std::runtime_error("Not a trace file");
+        }
+        OperationTrace trace;
+        trace._bytes.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        // Decoding checks the whole trace and gives the count
+        trace._length = trace.decode().size();
+        return trace;
+    }
+};
+
+// Count a value in a list; lists without count() are counted through indexing
+template <typename List>
+auto trace_count(List& list, int value) -> decltype(list.count(value)) {
+    return list.count(value);
+}
+
+template <typename List, typename... Ignored>
+int trace_count(List& list, int value, Ignored...) {
+    int n = 0;
+    for (int i = 0, length = list.length(); i < length; i++) {
+        n += list[i] == value;
+    }
+    return n;
+}
+
+/**
+ * @brief Wraps a list of int and records every operation on it into an
+ * OperationTrace. It has the list methods a trace knows about; the list
+ * itself is there through list() for anything else, unrecorded.
+ */
+template <typename List>
+class TraceRecorder {
+private:
+    List _list;
+    OperationTrace _trace;
+
+public:
+    TraceRecorder() = default;
+
+    // Wrap a list that already has elements; they go in the trace as appends
+    // so that the trace replays from an empty list
+    explicit TraceRecorder(List list) : _list(std::move(list)) {
+        for (int i = 0, length = _list.length(); i < length; i++) {
+            _trace.record(OperationTrace::append, _list[i]);
+        }
+    }
+
+    List& list() {
+        return _list;
+    }
+
+    const OperationTrace& trace() const {
+        return _trace;
+    }
+
+    int length() {
+        return _list.length();
+    }
+
+    void append(int value) {
+        _list.append(value);
+        _trace.record(OperationTrace::append, value);
+    }
+
+    void insert(int value, int index) {
+        _list.insert(value, index);
+        _trace.record(OperationTrace::insert, value, index);
+    }
+
+    void remove(int index) {
+        _list.remove(index);
+        _trace.record(OperationTrace::remove, 0, index);
+    }
+
+    int pop() {
+        int value = _list.pop();
+        _trace.record(OperationTrace::pop);
+        return value;
+    }
+
+    int pop(int index) {
+        int value = _list.pop(index);
+        _trace.record(OperationTrace::pop_at, 0, index);
+        return value;
+    }
+
+    int operator[](int index) {
+        int value = _list[index];
+        _trace.record(OperationTrace::get, 0, index);
+        return value;
+    }
+
+    int min() {
+        int value = _list.min();
+        _trace.record(OperationTrace::min);
+        return value;
+    }
+
+    int max() {
+        int value = _list.max();
+        _trace.record(OperationTrace::max);
+        return value;
     }
 
     int count(int value) {
-        int count = 0;
+        int n = trace_count(_list, value);
+        _trace.record(OperationTrace::count, value);
+        return n;
+    }
+};
+
+/**
+ * @brief Run decoded trace operations against a list, as fast as the list
+ * allows. The results of the reads are folded into a checksum, which keeps
+ * them from being optimized away and must come out the same for every list
+ * that replays the same trace.
+ *
+ * @param operations The trace, from OperationTrace::decode()
+ * @param list The list to replay against, normally empty
+ * @return unsigned long long The checksum
+ */
+template <typename List>
+unsigned long long replay(const std::vector<OperationTrace::Operation>& operations, List& list) {
+    unsigned long long checksum = 0;
+    for (const OperationTrace::Operation& operation : operations) {
+        switch (operation.op) {
+        case OperationTrace::append:
+            list.append(operation.value);
+            break;
+        case OperationTrace::insert:
+            list.insert(operation.value, operation.index);
+            break;
+        case OperationTrace::remove:
+            list.remove(operation.index);
+            break;
+        case OperationTrace::pop:
+            checksum = checksum * 31 + list.pop();
+            break;
+        case OperationTrace::pop_at:
+            checksum = checksum * 31 + list.pop(operation.index);
+            break;
+        case OperationTrace::get:
+            checksum = checksum * 31 + list[operation.index];
+            break;
+        case OperationTrace::min:
+            checksum = checksum * 31 + list.min();
+            break;
+        case OperationTrace::max:
+            checksum = checksum * 31 + list.max();
+            break;
+        case OperationTrace::count:
+            checksum = checksum * 31 + trace_count(list, operation.value);
+            break;
+        }
+    }
+    return checksum;
+}
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+struct Node
+{
+    // The value at the node
+    int value;
+    // Pointer to the previous node; here default value nullpointer
+    Node *prev = nullptr; 
+    // Pointer to the next node; here default value nullpointer
+    Node *next = nullptr; 
+};
+
+/**
+ * @brief Slab allocator for nodes. Nodes are carved out of large chunks and
+ * removed nodes are recycled through a free list, so a list only goes to the
+ * heap once per chunk. All chunks are freed together when the pool dies.
+ * A pool can be shared between several lists.
+ *
+ */
+class NodePool
+{
+  private:
+    /**
+     * @brief Keeps chunks alive. A link owns one chunk or joins in everything
+     * another pool keeps alive, and points only to links that existed before
+     * it, so the links form a graph without cycles that pools share instead
+     * of copying. Adopting a pool is then one new link.
+     *
+     */
+    struct ChunkLink
+    {
+        std::unique_ptr<Node[]> chunk;
+        std::shared_ptr<ChunkLink> older;
+        std::shared_ptr<ChunkLink> adopted;
+
+        ~ChunkLink()
+        {
+            // Free links only this one holds in a loop, so a long history of
+            // chunks and adoptions doesn't recurse once per link
+            std::vector<std::shared_ptr<ChunkLink>> pending;
+            pending.push_back(std::move(older));
+            pending.push_back(std::move(adopted));
+            while (!pending.empty())
+            {
+                std::shared_ptr<ChunkLink> link = std::move(pending.back());
+                pending.pop_back();
+                if (link && link.use_count() == 1)
+                {
+                    pending.push_back(std::move(link->older));
+                    pending.push_back(std::move(link->adopted));
+                }
+            }
+        }
+    };
+
+    // The newest link; it owns the chunk new nodes come from, unless a pool
+    // was adopted since
+    std::shared_ptr<ChunkLink> chunks;
+    // The chunk new nodes come from, its size and how many of its nodes are
+    // handed out
+    Node *current = nullptr;
+    int chunk_size = 0;
+    int used = 0;
+    int own_chunks = 0;
+    // Released nodes, linked through their next pointer
+    Node *free_list = nullptr;
+    // Statistics
+    long long acquired = 0;
+    long long recycled = 0;
+
+    static constexpr int first_chunk_size = 64;
+    static constexpr int max_chunk_size = 1 << 16;
+
+    void add_chunk()
+    {
+        chunk_size = chunk_size == 0 ? first_chunk_size : std::min(chunk_size * 2, max_chunk_size);
+        std::shared_ptr<ChunkLink> link = std::make_shared<ChunkLink>();
+        link->chunk.reset(new Node[chunk_size]);
+        link->older = std::move(chunks);
+        chunks = std::move(link);
+        current = chunks->chunk.get();
+        own_chunks++;
+        used = 0;
+    }
+
+  public:
+    NodePool()
+    {
+    }
+
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    /**
+     * @brief Get a node from the pool
+     *
+     * @param val The value of the node
+     * @param prev The previous node
+     * @param next The next node
+     * @return Node* The node
+     */
+    Node *acquire(int val, Node *prev, Node *next)
+    {
+        acquired++;
+        Node *node;
+        if (free_list != nullptr)
+        {
+            node = free_list;
+            free_list = node->next;
+            recycled++;
+        }
+        else
+        {
+            if (used == chunk_size)
+                add_chunk();
+            node = &current[used++];
+        }
+        node->value = val;
+        node->prev = prev;
+        node->next = next;
+        return node;
+    }
+
+    /**
+     * @brief Give a node back to the pool so it can be reused
+     *
+     * @param node The node, which must come from this pool
+     */
+    void release(Node *node)
+    {
+        node->next = free_list;
+        free_list = node;
+    }
+
+    /**
+     * @brief Keep the chunks of another pool alive as long as this one, so
+     * that nodes taken over from a list using that pool stay valid. Takes
+     * O(1), whatever the number of chunks.
+     *
+     * @param other The other pool
+     */
+    void adopt(const NodePool &other)
+    {
+        if (!other.chunks || other.chunks == chunks || (chunks && chunks->adopted == other.chunks))
+            return;
+        std::shared_ptr<ChunkLink> link = std::make_shared<ChunkLink>();
+        link->older = std::move(chunks);
+        link->adopted = other.chunks;
+        chunks = std::move(link);
+    }
+
+    // Number of chunks this pool carved nodes from, not counting adopted ones
+    int chunk_count()
+    {
+        return own_chunks;
+    }
+
+    // Number of nodes handed out, and how many of those were recycled
+    long long acquire_count()
+    {
+        return acquired;
+    }
+
+    long long recycle_count()
+    {
+        return recycled;
+    }
+};
+
+class LinkedList
+{
+  private:
+    // Pointer to the first and last element in the list
+    Node *head = nullptr;
+    Node *tail = nullptr;
+    // Size of the list
+    int _size = 0;
+    // Where the nodes come from, created on the first insertion
+    std::shared_ptr<NodePool> _pool;
+    // The last node looked up by index, so that nearby lookups can start
+    // there instead of at the head; null when there is none
+    Node *finger = nullptr;
+    int finger_index = 0;
+
+    // Give the nodes up. A pool of our own is freed in bulk when it dies;
+    // a shared one gets the nodes back.
+    void release_nodes()
+    {
+        if (_pool.use_count() > 1)
+        {
+            Node *current = head;
+            while (current != nullptr)
+            {
+                Node *next = current->next;
+                _pool->release(current);
+                current = next;
+            }
+        }
+        _pool.reset();
+        head = tail = finger = nullptr;
+        _size = 0;
+    }
+
+    // Take over the nodes and pool of another list and leave it empty
+    void take(LinkedList &other)
+    {
+        head = other.head;
+        tail = other.tail;
+        _size = other._size;
+        _pool = std::move(other._pool);
+        finger = other.finger;
+        finger_index = other.finger_index;
+        other.head = other.tail = other.finger = nullptr;
+        other._size = 0;
+    }
+
+    // Make sure nodes coming from another list stay alive with this list
+    void share_nodes_of(LinkedList &other)
+    {
+        if (other._pool == _pool)
+            return;
+        if (!_pool)
+            _pool = std::make_shared<NodePool>();
+        _pool->adopt(*other._pool);
+    }
+
+    /**
+     * @brief Merge two sorted chains linked through next. On equal values
+     * the node from the first chain comes first.
+     *
+     * @return Node* The first node of the merged chain
+     */
+    static Node *merge_chains(Node *a, Node *b)
+    {
+        Node before;
+        Node *last = &before;
+        while (a != nullptr && b != nullptr)
+        {
+            if (b->value < a->value)
+            {
+                last->next = b;
+                b = b->next;
+            }
+            else
+            {
+                last->next = a;
+                a = a->next;
+            }
+            last = last->next;
+        }
+        last->next = a != nullptr ? a : b;
+        return before.next;
+    }
+
+    // Make head the start of a chain linked through next, and set the prev
+    // pointers and tail to match
+    void relink_from(Node *first)
+    {
+        head = first;
+        tail = nullptr;
+        for (Node *current = first; current != nullptr; current = current->next)
+        {
+            current->prev = tail;
+            tail = current;
+        }
+        finger = nullptr;
+    }
+
+    Node *new_node(int val, Node *prev, Node *next)
+    {
+        if (!_pool)
+            _pool = std::make_shared<NodePool>();
+        return _pool->acquire(val, prev, next);
+    }
+
+    /**
+     * @brief Check wheter the given index if out of
+     * bound and throw a range error if it is
+     *
+     * @param index The index to be checked
+     */
+    void check_index_out_of_bounds(int index)
+    {
+        if ((index < 0) || (index >= length()))
+            throw std::range_error("Index out of bounds");
+    }
+
+    /**
+     * @brief Find the node at the given index, walking from the nearest of
+     * the head, the tail and the finger, and move the finger there
+     *
+     * @param index The index where you want the node
+     * @return Node* A pointer to the node at the index
+     */
+    Node *find_node_at_index(int index)
+    {
+        Node *current = head;
+        int position = 0;
+        int distance = index;
+        if (_size - 1 - index < distance)
+        {
+            current = tail;
+            position = _size - 1;
+            distance = _size - 1 - index;
+        }
+        if (finger != nullptr && std::abs(index - finger_index) < distance)
+        {
+            current = finger;
+            position = finger_index;
+        }
+        for (; position < index; position++)
+            current = current->next;
+        for (; position > index; position--)
+            current = current->prev;
+
+        finger = current;
+        finger_index = index;
+        return current;
+    }
+
+    /**
+     * @brief Unlink the node at the given index and give it back to the pool
+     *
+     * @param current The node
+     * @param index Its index
+     */
+    void erase_node(Node *current, int index)
+    {
+        if (current->prev != nullptr)
+            current->prev->next = current->next;
+        else
+            head = current->next;
+        if (current->next != nullptr)
+            current->next->prev = current->prev;
+        else
+            tail = current->prev;
+
+        // Keep the finger on a live node
+        if (finger == current)
+        {
+            finger = current->next != nullptr ? current->next : current->prev;
+            finger_index = current->next != nullptr ? index : index - 1;
+        }
+        else if (finger != nullptr && finger_index > index)
+        {
+            finger_index--;
+        }
+        _pool->release(current);
+        _size--;
+    }
+
+  public:
+    // Default constructor
+    LinkedList()
+    {
+    }
+
+    // Constructor for a list of values
+    LinkedList(std::vector<int> values)
+    {
+        for (int v : values)
+            append(v);
+    }
+
+    // Constructor for a list that takes its nodes from a shared pool. It is a
+    // template so that a braced list like {0} never converts to a pool.
+    template <typename Pool, typename = std::enable_if_t<std::is_same<Pool, std::shared_ptr<NodePool>>::value>>
+    explicit LinkedList(Pool pool) : _pool(std::move(pool))
+    {
+    }
+
+    LinkedList(const LinkedList &) = delete;
+    LinkedList &operator=(const LinkedList &) = delete;
+
+    // Move constructor, takes over the nodes and leaves the other list empty
+    LinkedList(LinkedList &&other) noexcept
+    {
+        take(other);
+    }
+
+    LinkedList &operator=(LinkedList &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release_nodes();
+            take(other);
+        }
+        return *this;
+    }
+
+~LinkedList()
+{
+    release_nodes();
+}
+
+    /**
+     * @brief Return the pool the nodes come from
+     *
+     * @return std::shared_ptr<NodePool> The pool, null before the first insertion
+     */
+    std::shared_ptr<NodePool> pool()
+    {
+        return _pool;
+    }
+
+    /**
+     * @brief Bidirectional iterator over the values. It stays valid until
+     * the node it points to is removed.
+     *
+     */
+    template <typename Value>
+    class basic_iterator
+    {
+        friend class LinkedList;
+        template <typename> friend class basic_iterator;
+
+        Node *node = nullptr;
+        // Needed to step back from end()
+        const LinkedList *list = nullptr;
+
+        basic_iterator(Node *node, const LinkedList *list) : node(node), list(list)
+        {
+        }
+
+      public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value *;
+        using reference = Value &;
+
+        basic_iterator()
+        {
+        }
+
+        // An iterator converts to a const_iterator
+        operator basic_iterator<const int>() const
+        {
+            return basic_iterator<const int>(node, list);
+        }
+
+        reference operator*() const
+        {
+            return node->value;
+        }
+
+        pointer operator->() const
+        {
+            return &node->value;
+        }
+
+        basic_iterator &operator++()
+        {
+            node = node->next;
+            return *this;
+        }
+
+        basic_iterator operator++(int)
+        {
+            basic_iterator old = *this;
+            node = node->next;
+            return old;
+        }
+
+        basic_iterator &operator--()
+        {
+            node = node == nullptr ? list->tail : node->prev;
+            return *this;
+        }
+
+        basic_iterator operator--(int)
+        {
+            basic_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        friend bool operator==(const basic_iterator &a, const basic_iterator &b)
+        {
+            return a.node == b.node;
+        }
+
+        friend bool operator!=(const basic_iterator &a, const basic_iterator &b)
+        {
+            return a.node != b.node;
+        }
+    };
+
+    using iterator = basic_iterator<int>;
+    using const_iterator = basic_iterator<const int>;
+
+    iterator begin()
+    {
+        return iterator(head, this);
+    }
+
+    iterator end()
+    {
+        return iterator(nullptr, this);
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(head, this);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(nullptr, this);
+    }
+
+    /**
+     * @brief Insert a value in front of the node an iterator points to,
+     * without walking the list
+     *
+     * @param position The iterator, end() to append
+     * @param val The value to be added
+     * @return iterator The new node
+     */
+    iterator insert_before(iterator position, int val)
+    {
+        if (position.node == nullptr)
+        {
+            append(val);
+            return iterator(tail, this);
+        }
+        if (position.node == head)
+        {
+            push_front(val);
+            return begin();
+        }
+        Node *current = position.node;
+        Node *newNode = new_node(val, current->prev, current);
+        current->prev->next = newNode;
+        current->prev = newNode;
+        // The index of the new node is unknown, so the finger can't be kept
+        finger = nullptr;
+        _size++;
+        return iterator(newNode, this);
+    }
+
+    /**
+     * @brief Move all nodes of another list in front of the node an iterator
+     * points to. Nothing is copied or allocated; the other list is left empty.
+     *
+     * @param position The iterator, end() to add the nodes at the end
+     * @param other The list to take the nodes from
+     */
+    void splice(iterator position, LinkedList &other)
+    {
+        if (&other == this || other._size == 0)
+            return;
+        share_nodes_of(other);
+
+        Node *next = position.node;
+        Node *prev = next == nullptr ? tail : next->prev;
+        other.head->prev = prev;
+        other.tail->next = next;
+        if (prev != nullptr)
+            prev->next = other.head;
+        else
+            head = other.head;
+        if (next != nullptr)
+            next->prev = other.tail;
+        else
+            tail = other.tail;
+
+        // The finger keeps its node; only its index can move
+        if (finger != nullptr && next != nullptr)
+        {
+            if (prev == nullptr)
+                finger_index += other._size;
+            else
+                finger = nullptr;
+        }
+        _size += other._size;
+
+        other.head = other.tail = other.finger = nullptr;
+        other._size = 0;
+    }
+
+    /**
+     * @brief Move all nodes of another list to the end of this one
+     *
+     * @param other The list to take the nodes from, left empty
+     */
+    void concat(LinkedList &other)
+    {
+        splice(end(), other);
+    }
+
+    /**
+     * @brief Cut the list in two at an index. The nodes from the index on
+     * move to a new list that shares this list's pool; nothing is copied.
+     *
+     * @param index The first index of the new list, between 0 and length()
+     * @return LinkedList The list of the elements from the index on
+     */
+    LinkedList split_at(int index)
+    {
+        if (index < 0 || index > _size)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        LinkedList rest{_pool};
+        if (index == _size)
+            return rest;
+
+        Node *first = find_node_at_index(index);
+        rest.head = first;
+        rest.tail = tail;
+        rest._size = _size - index;
+
+        tail = first->prev;
+        if (tail != nullptr)
+            tail->next = nullptr;
+        else
+            head = nullptr;
+        first->prev = nullptr;
+        _size = index;
+        finger = tail;
+        finger_index = index - 1;
+        return rest;
+    }
+
+    /**
+     * @brief Sort the list in place with a bottom-up merge sort on the links.
+     * O(N log N), stable, and no allocation.
+     *
+     */
+    void sort()
+    {
+        if (_size < 2)
+            return;
+
+        // runs[i] holds a sorted run of 2^i nodes, or nothing. Each node is
+        // added as a run of one and equal runs are merged, like a binary
+        // counter; earlier nodes are always in the first chain of a merge.
+        Node *runs[32] = {};
+        Node *current = head;
+        while (current != nullptr)
+        {
+            Node *run = current;
+            current = current->next;
+            run->next = nullptr;
+            int i = 0;
+            for (; runs[i] != nullptr; i++)
+            {
+                run = merge_chains(runs[i], run);
+                runs[i] = nullptr;
+            }
+            runs[i] = run;
+        }
+
+        Node *sorted = nullptr;
+        for (Node *run : runs)
+        {
+            if (run != nullptr)
+                sorted = merge_chains(run, sorted);
+        }
+        relink_from(sorted);
+    }
+
+    /**
+     * @brief Merge another sorted list into this sorted list in linear time,
+     * by relinking the nodes. On equal values the elements of this list come
+     * first. The other list is left empty.
+     *
+     * @param other The list to take the nodes from
+     */
+    void merge(LinkedList &other)
+    {
+        if (&other == this || other._size == 0)
+            return;
+        share_nodes_of(other);
+        relink_from(merge_chains(head, other.head));
+        _size += other._size;
+
+        other.head = other.tail = other.finger = nullptr;
+        other._size = 0;
+    }
+
+    /**
+     * @brief Remove the node an iterator points to, without walking the list
+     *
+     * @param position The iterator
+     * @return iterator The node after the removed one
+     */
+    iterator erase(iterator position)
+    {
+        if (position.node == nullptr)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        Node *next = position.node->next;
+        // The index of the node is unknown, so the finger can't be kept
+        finger = nullptr;
+        erase_node(position.node, 0);
+        return iterator(next, this);
+    }
+
+
+    /**
+     * @brief Return the length of the list
+     *
+     * @return int The length
+     */
+    int length()
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param val The value to be appended
+     */
+void append(int val)
+{
+    _size++;
+    Node *newNode = new_node(val, tail, nullptr);
+    if (head == nullptr)
+    {
+        // Hvis listen er tom, setter både hodet og halen til den nye noden.
+        head = newNode;
+        tail = newNode;
+    }
+    else
+    {
+        // Hvis listen ikke er tom, legger den nye noden til som "neste" for halen og oppdaterer halen til den nye noden.
+        tail->next = newNode;
+        tail = newNode;
+    }
+}
+
+
+    /**
+     * @brief Print values in the list
+     *
+     */
+void print()
+{
+    std::cout << "[";
+    Node *current = head;
+    while (current != nullptr)
+    {
+        std::cout << current->value;
+        if (current->next != nullptr)
+        {
+            std::cout << ", ";
+        }
+        current = current->next;
+    }
+    std::cout << "]\n";
+}
+
+    /**
+     * @brief Get value at a given index
+     *
+     * @param index The index
+     * @return int& Reference to the value at that index
+     */
+    int &operator[](int index)
+    {
+        check_index_out_of_bounds(index);
+        Node *current = find_node_at_index(index);
+        return current->value;
+    }
+
+    /**
+     * @brief Add element to the beginning of the list
+     *
+     * @param val The value to be added
+     */
+void push_front(int val)
+{
+    Node *newNode = new_node(val, nullptr, head);
+    if (head != nullptr) {
+        head->prev = newNode;
+    }
+    head = newNode;
+    if (finger != nullptr) {
+        finger_index++;
+    }
+
+    if (tail == nullptr) {
+        // Hvis listen er tom, oppdaterer vi også halen til å være den nye noden.
+        tail = newNode;
+    }
+
+    _size++;
+}
+
+
+
+    /***
+     * @brief Add element to index chosen
+     * 
+     * @param val The value to be added
+     * @param index The index
+    */
+void insert(int val, int index)
+{
+    if (index <= 0)
+    {
+        push_front(val);
+        return;
+    }
+
+    if (index >= _size)
+    {
+        append(val);
+        return;
+    }
+
+    // Finn den gjeldende noden ved den valgte indeksen
+    Node *current = find_node_at_index(index);
+
+    // Opprett en ny node med de riktige pekerne
+    Node *newNode = new_node(val, current->prev, current);
+
+    // Oppdater pekerne for de omkringliggende noder
+    current->prev->next = newNode;
+    current->prev = newNode;
+
+    // Fingeren peker nå på den nye noden
+    finger = newNode;
+    _size++;
+}
+
+
+     /**
+     * @brief deletes the element at given index from the Linked list.
+     * 
+     * @param index The index.
+     *  
+    */
+void remove(int index)
+{
+    if (index < 0 || index >= _size)
+    {
+        throw std::out_of_range("Index out of bounds");
+    }
+
+    // Finn den gjeldende noden ved den valgte indeksen og fjern den
+    Node *current = find_node_at_index(index);
+    erase_node(current, index);
+}
+
+
+    /***
+     * @brief removing element at index given
+     * 
+     * @param index
+     * @return int the value at that index
+    */
+int pop(int index)
+{
+    if (index < 0 || index >= _size)
+    {
+        throw std::out_of_range("Index out of bounds");
+    }
+
+    Node *current = find_node_at_index(index);
+    int value = current->value;
+    erase_node(current, index);
+    return value;
+}
+
+int pop()
+{
+    if (_size == 0)
+    {
+        throw std::out_of_range("List is empty");
+    }
+
+    int value = tail->value;
+    erase_node(tail, _size - 1);
+    return value;
+}
+
+
+    int min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+
+        int minimum = head->value;
+        Node *current = head->next;
+
+        while (current != nullptr)
+        {
+            if (current->value < minimum)
+            {
+                minimum = current->value;
+            }
+            current = current->next;
+        }
+
+        return minimum;
+    }
+
+    int max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+
+        int maximum = head->value;
+        Node *current = head->next;
+
+        while (current != nullptr)
+        {
+            if (current->value > maximum)
+            {
+                maximum = current->value;
+            }
+            current = current->next;
+        }
+
+        return maximum;
+    }
+
+    // Test functions
+    void test_min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+
+        int minValue = min();
+        std::cout << "The minimum value in the list is: " << minValue << " - Success!\n";
+    }
+
+    void test_max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+
+        int maxValue = max();
+        std::cout << "The maximum value in the list is: " << maxValue << " - Success!\n";
+    }
+
+};
+
+struct UnrolledNode
+{
+    // Number of values that fit when a node fills two cache lines
+    static constexpr int capacity = (128 - 2 * sizeof(void *) - sizeof(int)) / sizeof(int);
+
+    // Number of values in use, packed at the start of the array
+    int count = 0;
+    int values[capacity];
+    UnrolledNode *prev = nullptr;
+    UnrolledNode *next = nullptr;
+};
+
+/**
+ * @brief Linked list that keeps a small packed array of values in each node,
+ * so traversals touch one node per UnrolledNode::capacity values instead of
+ * one per value. Has the same interface as LinkedList.
+ *
+ */
+class UnrolledLinkedList
+{
+  private:
+    UnrolledNode *head = nullptr;
+    UnrolledNode *tail = nullptr;
+    // Number of values in the list
+    int _size = 0;
+
+    void check_index_out_of_bounds(int index)
+    {
+        if ((index < 0) || (index >= length()))
+            throw std::range_error("Index out of bounds");
+    }
+
+    /**
+     * @brief Find the node holding the given index, walking from whichever
+     * end is closer
+     *
+     * @param index The index, between 0 and length() - 1
+     * @param offset Set to the position of the index inside the node
+     * @return UnrolledNode* The node
+     */
+    UnrolledNode *find_node_at_index(int index, int &offset)
+    {
+        if (index < _size / 2)
+        {
+            UnrolledNode *current = head;
+            while (index >= current->count)
+            {
+                index -= current->count;
+                current = current->next;
+            }
+            offset = index;
+            return current;
+        }
+        UnrolledNode *current = tail;
+        int start = _size - current->count;
+        while (index < start)
+        {
+            current = current->prev;
+            start -= current->count;
+        }
+        offset = index - start;
+        return current;
+    }
+
+    // Link a new, empty node in after the given one (or at the front if null)
+    UnrolledNode *add_node_after(UnrolledNode *node)
+    {
+        UnrolledNode *newNode = new UnrolledNode{};
+        newNode->prev = node;
+        newNode->next = node == nullptr ? head : node->next;
+        if (newNode->next != nullptr)
+            newNode->next->prev = newNode;
+        else
+            tail = newNode;
+        if (node != nullptr)
+            node->next = newNode;
+        else
+            head = newNode;
+        return newNode;
+    }
+
+    void unlink_node(UnrolledNode *node)
+    {
+        if (node->prev != nullptr)
+            node->prev->next = node->next;
+        else
+            head = node->next;
+        if (node->next != nullptr)
+            node->next->prev = node->prev;
+        else
+            tail = node->prev;
+        delete node;
+    }
+
+    /**
+     * @brief Put a value at the given position inside a node, splitting the
+     * node in two halves first if it is full
+     */
+    void insert_into_node(UnrolledNode *node, int offset, int val)
+    {
+        if (node->count == UnrolledNode::capacity)
+        {
+            UnrolledNode *second = add_node_after(node);
+            int half = node->count / 2;
+            second->count = node->count - half;
+            std::copy(node->values + half, node->values + node->count, second->values);
+            node->count = half;
+            if (offset > half)
+            {
+                node = second;
+                offset -= half;
+            }
+        }
+        std::copy_backward(node->values + offset, node->values + node->count, node->values + node->count + 1);
+        node->values[offset] = val;
+        node->count++;
+        _size++;
+    }
+
+    /**
+     * @brief Take the value at the given position out of a node, and keep
+     * nodes at least half full by merging with or borrowing from the next one
+     */
+    void remove_from_node(UnrolledNode *node, int offset)
+    {
+        std::copy(node->values + offset + 1, node->values + node->count, node->values + offset);
+        node->count--;
+        _size--;
+
+        UnrolledNode *next = node->next;
+        if (node->count >= UnrolledNode::capacity / 2 || next == nullptr)
+        {
+            if (node->count == 0)
+                unlink_node(node);
+            return;
+        }
+        if (node->count + next->count <= UnrolledNode::capacity)
+        {
+            std::copy(next->values, next->values + next->count, node->values + node->count);
+            node->count += next->count;
+            unlink_node(next);
+        }
+        else
+        {
+            int moved = (next->count - node->count) / 2;
+            std::copy(next->values, next->values + moved, node->values + node->count);
+            std::copy(next->values + moved, next->values + next->count, next->values);
+            node->count += moved;
+            next->count -= moved;
+        }
+    }
+
+  public:
+    // Default constructor
+    UnrolledLinkedList()
+    {
+    }
+
+    // Constructor for a list of values
+    UnrolledLinkedList(std::vector<int> values)
+    {
+        for (int v : values)
+            append(v);
+    }
+
+    UnrolledLinkedList(const UnrolledLinkedList &) = delete;
+    UnrolledLinkedList &operator=(const UnrolledLinkedList &) = delete;
+
+    ~UnrolledLinkedList()
+    {
+        UnrolledNode *current = head;
+        while (current != nullptr)
+        {
+            UnrolledNode *next = current->next;
+            delete current;
+            current = next;
+        }
+    }
+
+    /**
+     * @brief Return the length of the list
+     *
+     * @return int The length
+     */
+    int length()
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param val The value to be appended
+     */
+    void append(int val)
+    {
+        if (tail == nullptr || tail->count == UnrolledNode::capacity)
+            add_node_after(tail);
+        tail->values[tail->count++] = val;
+        _size++;
+    }
+
+    /**
+     * @brief Print values in the list
+     *
+     */
+    void print()
+    {
+        std::cout << "[";
+        for (UnrolledNode *current = head; current != nullptr; current = current->next)
+        {
+            for (int i = 0; i < current->count; i++)
+            {
+                std::cout << current->values[i];
+                if (i + 1 < current->count || current->next != nullptr)
+                    std::cout << ", ";
+            }
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get value at a given index
+     *
+     * @param index The index
+     * @return int& Reference to the value at that index
+     */
+    int &operator[](int index)
+    {
+        check_index_out_of_bounds(index);
+        int offset;
+        UnrolledNode *current = find_node_at_index(index, offset);
+        return current->values[offset];
+    }
+
+    /**
+     * @brief Add element to the beginning of the list
+     *
+     * @param val The value to be added
+     */
+    void push_front(int val)
+    {
+        if (head == nullptr)
+            add_node_after(nullptr);
+        insert_into_node(head, 0, val);
+    }
+
+    /***
+     * @brief Add element to index chosen
+     *
+     * @param val The value to be added
+     * @param index The index
+     */
+    void insert(int val, int index)
+    {
+        if (index <= 0)
+        {
+            push_front(val);
+            return;
+        }
+        if (index >= _size)
+        {
+            append(val);
+            return;
+        }
+        int offset;
+        UnrolledNode *current = find_node_at_index(index, offset);
+        insert_into_node(current, offset, val);
+    }
+
+    /**
+     * @brief deletes the element at given index from the list.
+     *
+     * @param index The index.
+     */
+    void remove(int index)
+    {
+        pop(index);
+    }
+
+    /***
+     * @brief removing element at index given
+     *
+     * @param index
+     * @return int the value at that index
+     */
+    int pop(int index)
+    {
+        if (index < 0 || index >= _size)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        int offset;
+        UnrolledNode *current = find_node_at_index(index, offset);
+        int value = current->values[offset];
+        remove_from_node(current, offset);
+        return value;
+    }
+
+    int pop()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        return pop(_size - 1);
+    }
+
+    int min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int minimum = head->values[0];
+        for (UnrolledNode *current = head; current != nullptr; current = current->next)
+        {
+            for (int i = 0; i < current->count; i++)
+            {
+                if (current->values[i] < minimum)
+                    minimum = current->values[i];
+            }
+        }
+        return minimum;
+    }
+
+    int max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int maximum = head->values[0];
+        for (UnrolledNode *current = head; current != nullptr; current = current->next)
+        {
+            for (int i = 0; i < current->count; i++)
+            {
+                if (current->values[i] > maximum)
+                    maximum = current->values[i];
+            }
+        }
+        return maximum;
+    }
+};
+
+struct SkipNode
+{
+    // Link to the next node on one level, and how many positions it skips
+    struct Link
+    {
+        SkipNode *next;
+        int width;
+    };
+
+    int value;
+    // Number of levels the node takes part in
+    int height;
+
+    // The links are allocated right after the node
+    Link *links()
+    {
+        return reinterpret_cast<Link *>(this + 1);
+    }
+
+    static SkipNode *create(int value, int height)
+    {
+        void *memory = ::operator new(sizeof(SkipNode) + height * sizeof(Link));
+        SkipNode *node = new (memory) SkipNode{value, height};
+        for (int l = 0; l < height; l++)
+            new (node->links() + l) Link{nullptr, 0};
+        return node;
+    }
+
+    static void destroy(SkipNode *node)
+    {
+        ::operator delete(node);
+    }
+};
+
+/**
+ * @brief Indexable skip list. Every link stores how many positions it skips,
+ * so operator[], insert, remove and pop take expected O(log N) steps. Has the
+ * same interface as LinkedList.
+ *
+ */
+class SkipList
+{
+  private:
+    static constexpr int max_height = 32;
+
+    // Sentinel before the first element, at position 0. Element i is at
+    // position i + 1, and a link to nullptr reaches position length() + 1.
+    SkipNode *head = SkipNode::create(0, max_height);
+    // Number of levels in use
+    int levels = 1;
+    int _size = 0;
+    // State of the random number generator for node heights
+    unsigned long long seed = 0x9E3779B97F4A7C15ULL;
+
+    void check_index_out_of_bounds(int index)
+    {
+        if ((index < 0) || (index >= length()))
+            throw std::range_error("Index out of bounds");
+    }
+
+    // Height for a new node, each extra level with probability 1/2
+    int random_height()
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        int height = 1;
+        unsigned long long bits = seed;
+        while ((bits & 1) && height < max_height)
+        {
+            height++;
+            bits >>= 1;
+        }
+        return height;
+    }
+
+    /**
+     * @brief Find the last node before the given position on every level
+     *
+     * @param position The position
+     * @param update Set to the node on each level
+     * @param update_position Set to the position of those nodes
+     */
+    void find_predecessors(int position, SkipNode **update, int *update_position)
+    {
+        SkipNode *current = head;
+        int current_position = 0;
+        for (int l = levels - 1; l >= 0; l--)
+        {
+            while (current_position + current->links()[l].width < position)
+            {
+                current_position += current->links()[l].width;
+                current = current->links()[l].next;
+            }
+            update[l] = current;
+            update_position[l] = current_position;
+        }
+    }
+
+    /**
+     * @brief Find the node at the given index
+     *
+     * @param index The index, between 0 and length() - 1
+     * @return SkipNode* The node
+     */
+    SkipNode *find_node_at_index(int index)
+    {
+        int position = index + 1;
+        SkipNode *current = head;
+        int current_position = 0;
+        for (int l = levels - 1; l >= 0; l--)
+        {
+            while (current_position + current->links()[l].width <= position)
+            {
+                current_position += current->links()[l].width;
+                current = current->links()[l].next;
+            }
+        }
+        return current;
+    }
+
+  public:
+    // Default constructor
+    SkipList()
+    {
+        head->links()[0].width = 1;
+    }
+
+    // Constructor for a list of values
+    SkipList(std::vector<int> values) : SkipList()
+    {
+        for (int v : values)
+            append(v);
+    }
+
+    SkipList(const SkipList &) = delete;
+    SkipList &operator=(const SkipList &) = delete;
+
+    ~SkipList()
+    {
+        SkipNode *current = head;
+        while (current != nullptr)
+        {
+            SkipNode *next = current->links()[0].next;
+            SkipNode::destroy(current);
+            current = next;
+        }
+    }
+
+    /**
+     * @brief Return the length of the list
+     *
+     * @return int The length
+     */
+    int length()
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param val The value to be appended
+     */
+    void append(int val)
+    {
+        insert(val, _size);
+    }
+
+    /**
+     * @brief Print values in the list
+     *
+     */
+    void print()
+    {
+        std::cout << "[";
+        SkipNode *current = head->links()[0].next;
+        while (current != nullptr)
+        {
+            std::cout << current->value;
+            current = current->links()[0].next;
+            if (current != nullptr)
+                std::cout << ", ";
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get value at a given index
+     *
+     * @param index The index
+     * @return int& Reference to the value at that index
+     */
+    int &operator[](int index)
+    {
+        check_index_out_of_bounds(index);
+        return find_node_at_index(index)->value;
+    }
+
+    /**
+     * @brief Add element to the beginning of the list
+     *
+     * @param val The value to be added
+     */
+    void push_front(int val)
+    {
+        insert(val, 0);
+    }
+
+    /***
+     * @brief Add element to index chosen
+     *
+     * @param val The value to be added
+     * @param index The index
+     */
+    void insert(int val, int index)
+    {
+        index = std::max(0, std::min(index, _size));
+        int position = index + 1;
+
+        int height = random_height();
+        while (levels < height)
+        {
+            // A new level starts with one link from the head past the end
+            head->links()[levels] = {nullptr, _size + 1};
+            levels++;
+        }
+
+        SkipNode *update[max_height] = {};
+        int update_position[max_height] = {};
+        find_predecessors(position, update, update_position);
+
+        SkipNode *newNode = SkipNode::create(val, height);
+        for (int l = 0; l < levels; l++)
+        {
+            SkipNode::Link &link = update[l]->links()[l];
+            if (l < height)
+            {
+                int end = update_position[l] + link.width + 1;
+                newNode->links()[l] = {link.next, end - position};
+                link = {newNode, position - update_position[l]};
+            }
+            else
+            {
+                link.width++;
+            }
+        }
+        _size++;
+    }
+
+    /**
+     * @brief deletes the element at given index from the list.
+     *
+     * @param index The index.
+     */
+    void remove(int index)
+    {
+        pop(index);
+    }
+
+    /***
+     * @brief removing element at index given
+     *
+     * @param index
+     * @return int the value at that index
+     */
+    int pop(int index)
+    {
+        if (index < 0 || index >= _size)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        SkipNode *update[max_height] = {};
+        int update_position[max_height] = {};
+        find_predecessors(index + 1, update, update_position);
+
+        SkipNode *current = update[0]->links()[0].next;
+        for (int l = 0; l < levels; l++)
+        {
+            SkipNode::Link &link = update[l]->links()[l];
+            if (l < current->height)
+                link = {current->links()[l].next, link.width + current->links()[l].width - 1};
+            else
+                link.width--;
+        }
+        while (levels > 1 && head->links()[levels - 1].next == nullptr)
+            levels--;
+
+        int value = current->value;
+        SkipNode::destroy(current);
+        _size--;
+        return value;
+    }
+
+    int pop()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        return pop(_size - 1);
+    }
+
+    int min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int minimum = head->links()[0].next->value;
+        for (SkipNode *current = head->links()[0].next; current != nullptr; current = current->links()[0].next)
+        {
+            if (current->value < minimum)
+                minimum = current->value;
+        }
+        return minimum;
+    }
+
+    int max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int maximum = head->links()[0].next->value;
+        for (SkipNode *current = head->links()[0].next; current != nullptr; current = current->links()[0].next)
+        {
+            if (current->value > maximum)
+                maximum = current->value;
+        }
+        return maximum;
+    }
+};
+
+struct BTreeNode
+{
+    bool leaf;
+    // Number of values in a leaf, or children in a branch
+    int count = 0;
+    // Smallest and largest value in the subtree
+    int min = 0;
+    int max = 0;
+
+    explicit BTreeNode(bool leaf) : leaf(leaf)
+    {
+    }
+};
+
+struct BTreeLeaf : BTreeNode
+{
+    static constexpr int capacity = 64;
+    // Room for one extra value before the leaf is split
+    int values[capacity + 1] = {};
+
+    BTreeLeaf() : BTreeNode(true)
+    {
+    }
+};
+
+struct BTreeBranch : BTreeNode
+{
+    static constexpr int capacity = 32;
+    // Number of values under each child; room for one extra child before
+    // the branch is split
+    int sizes[capacity + 1] = {};
+    BTreeNode *children[capacity + 1] = {};
+
+    BTreeBranch() : BTreeNode(false)
+    {
+    }
+};
+
+/**
+ * @brief Sequence stored as a counted B+tree. Leaves hold packed arrays of
+ * values and branches keep the number of values under each child, so
+ * operator[], insert, remove and pop take O(log N) steps in the worst case.
+ * Every node also keeps the minimum and maximum of its subtree, so min() and
+ * max() are O(1). Has the same interface as LinkedList.
+ *
+ */
+class CountedBTree
+{
+  private:
+    BTreeNode *root = nullptr;
+    int _size = 0;
+
+    void check_index_out_of_bounds(int index)
+    {
+        if ((index < 0) || (index >= length()))
+            throw std::range_error("Index out of bounds");
+    }
+
+    static void destroy(BTreeNode *node)
+    {
+        if (node->leaf)
+        {
+            delete static_cast<BTreeLeaf *>(node);
+            return;
+        }
+        BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+        for (int i = 0; i < branch->count; i++)
+            destroy(branch->children[i]);
+        delete branch;
+    }
+
+    static int capacity_of(BTreeNode *node)
+    {
+        return node->leaf ? BTreeLeaf::capacity : BTreeBranch::capacity;
+    }
+
+    // Recompute the minimum and maximum of a node from its values or children
+    static void refresh(BTreeNode *node)
+    {
+        if (node->leaf)
+        {
+            BTreeLeaf *leaf = static_cast<BTreeLeaf *>(node);
+            leaf->min = *std::min_element(leaf->values, leaf->values + leaf->count);
+            leaf->max = *std::max_element(leaf->values, leaf->values + leaf->count);
+            return;
+        }
+        BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+        branch->min = branch->children[0]->min;
+        branch->max = branch->children[0]->max;
+        for (int i = 1; i < branch->count; i++)
+        {
+            branch->min = std::min(branch->min, branch->children[i]->min);
+            branch->max = std::max(branch->max, branch->children[i]->max);
+        }
+    }
+
+    // Number of values in a subtree
+    static int subtree_size(BTreeNode *node)
+    {
+        if (node->leaf)
+            return node->count;
+        BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+        return std::accumulate(branch->sizes, branch->sizes + branch->count, 0);
+    }
+
+    // Find the child of a branch holding the given index, and the index
+    // inside it; an index one past the end goes to the last child
+    static int find_child(BTreeBranch *branch, int &index)
+    {
+        int i = 0;
+        while (i + 1 < branch->count && index >= branch->sizes[i])
+        {
+            index -= branch->sizes[i];
+            i++;
+        }
+        return i;
+    }
+
+    /**
+     * @brief Move the last entries of a node, starting at from, to the front
+     * of an empty or following sibling
+     *
+     * @return int The number of values that moved
+     */
+    static int move_tail(BTreeNode *node, int from, BTreeNode *sibling)
+    {
+        int moved = node->count - from;
+        int values = moved;
+        if (node->leaf)
+        {
+            BTreeLeaf *left = static_cast<BTreeLeaf *>(node);
+            BTreeLeaf *right = static_cast<BTreeLeaf *>(sibling);
+            std::copy_backward(right->values, right->values + right->count, right->values + right->count + moved);
+            std::copy(left->values + from, left->values + left->count, right->values);
+        }
+        else
+        {
+            BTreeBranch *left = static_cast<BTreeBranch *>(node);
+            BTreeBranch *right = static_cast<BTreeBranch *>(sibling);
+            std::copy_backward(right->sizes, right->sizes + right->count, right->sizes + right->count + moved);
+            std::copy_backward(right->children, right->children + right->count, right->children + right->count + moved);
+            std::copy(left->sizes + from, left->sizes + left->count, right->sizes);
+            std::copy(left->children + from, left->children + left->count, right->children);
+            values = std::accumulate(right->sizes, right->sizes + moved, 0);
+        }
+        node->count = from;
+        sibling->count += moved;
+        return values;
+    }
+
+    /**
+     * @brief Move the first entries of a node to the end of the preceding
+     * sibling
+     *
+     * @return int The number of values that moved
+     */
+    static int move_head(BTreeNode *node, int moved, BTreeNode *sibling)
+    {
+        int values = moved;
+        if (node->leaf)
+        {
+            BTreeLeaf *right = static_cast<BTreeLeaf *>(node);
+            BTreeLeaf *left = static_cast<BTreeLeaf *>(sibling);
+            std::copy(right->values, right->values + moved, left->values + left->count);
+            std::copy(right->values + moved, right->values + right->count, right->values);
+        }
+        else
+        {
+            BTreeBranch *right = static_cast<BTreeBranch *>(node);
+            BTreeBranch *left = static_cast<BTreeBranch *>(sibling);
+            values = std::accumulate(right->sizes, right->sizes + moved, 0);
+            std::copy(right->sizes, right->sizes + moved, left->sizes + left->count);
+            std::copy(right->children, right->children + moved, left->children + left->count);
+            std::copy(right->sizes + moved, right->sizes + right->count, right->sizes);
+            std::copy(right->children + moved, right->children + right->count, right->children);
+        }
+        node->count -= moved;
+        sibling->count += moved;
+        return values;
+    }
+
+    /**
+     * @brief Insert a value into a subtree
+     *
+     * @return BTreeNode* The new right half if the node was split, else null
+     */
+    BTreeNode *insert_into(BTreeNode *node, int index, int val)
+    {
+        if (node->leaf)
+        {
+            BTreeLeaf *leaf = static_cast<BTreeLeaf *>(node);
+            std::copy_backward(leaf->values + index, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+            leaf->values[index] = val;
+            leaf->count++;
+        }
+        else
+        {
+            BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+            int i = find_child(branch, index);
+            BTreeNode *split = insert_into(branch->children[i], index, val);
+            branch->sizes[i]++;
+            if (split != nullptr)
+            {
+                std::copy_backward(branch->sizes + i + 1, branch->sizes + branch->count, branch->sizes + branch->count + 1);
+                std::copy_backward(branch->children + i + 1, branch->children + branch->count, branch->children + branch->count + 1);
+                branch->children[i + 1] = split;
+                branch->count++;
+                int moved = subtree_size(split);
+                branch->sizes[i] -= moved;
+                branch->sizes[i + 1] = moved;
+            }
+        }
+        if (node->count == 1)
+        {
+            node->min = node->max = val;
+        }
+        else
+        {
+            node->min = std::min(node->min, val);
+            node->max = std::max(node->max, val);
+        }
+
+        if (node->count <= capacity_of(node))
+            return nullptr;
+        BTreeNode *sibling;
+        if (node->leaf)
+            sibling = new BTreeLeaf();
+        else
+            sibling = new BTreeBranch();
+        move_tail(node, node->count / 2, sibling);
+        refresh(node);
+        refresh(sibling);
+        return sibling;
+    }
+
+    /**
+     * @brief Join an underfull child of a branch with a neighbour, or move
+     * entries over from the neighbour if they don't fit in one node
+     */
+    void fix_underflow(BTreeBranch *branch, int i)
+    {
+        int left = i + 1 < branch->count ? i : i - 1;
+        int right = left + 1;
+        BTreeNode *a = branch->children[left];
+        BTreeNode *b = branch->children[right];
+        if (a->count + b->count <= capacity_of(a))
+        {
+            move_head(b, b->count, a);
+            branch->sizes[left] += branch->sizes[right];
+            a->min = std::min(a->min, b->min);
+            a->max = std::max(a->max, b->max);
+            destroy(b);
+            std::copy(branch->sizes + right + 1, branch->sizes + branch->count, branch->sizes + right);
+            std::copy(branch->children + right + 1, branch->children + branch->count, branch->children + right);
+            branch->count--;
+            return;
+        }
+        int target = (a->count + b->count) / 2;
+        int moved;
+        if (a->count < target)
+        {
+            moved = move_head(b, target - a->count, a);
+            branch->sizes[left] += moved;
+            branch->sizes[right] -= moved;
+        }
+        else
+        {
+            moved = move_tail(a, target, b);
+            branch->sizes[left] -= moved;
+            branch->sizes[right] += moved;
+        }
+        refresh(a);
+        refresh(b);
+    }
+
+    // Remove the value at an index of a subtree and return it
+    int remove_from(BTreeNode *node, int index)
+    {
+        int value;
+        if (node->leaf)
+        {
+            BTreeLeaf *leaf = static_cast<BTreeLeaf *>(node);
+            value = leaf->values[index];
+            std::copy(leaf->values + index + 1, leaf->values + leaf->count, leaf->values + index);
+            leaf->count--;
+        }
+        else
+        {
+            BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+            int i = find_child(branch, index);
+            BTreeNode *child = branch->children[i];
+            value = remove_from(child, index);
+            branch->sizes[i]--;
+            if (child->count < capacity_of(child) / 2)
+                fix_underflow(branch, i);
+        }
+        if (node->count > 0 && (value == node->min || value == node->max))
+            refresh(node);
+        return value;
+    }
+
+    // Write a value at an index of a subtree and return the value it replaced
+    static int set_in(BTreeNode *node, int index, int val)
+    {
+        int old;
+        if (node->leaf)
+        {
+            BTreeLeaf *leaf = static_cast<BTreeLeaf *>(node);
+            old = leaf->values[index];
+            leaf->values[index] = val;
+        }
+        else
+        {
+            BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+            int i = find_child(branch, index);
+            old = set_in(branch->children[i], index, val);
+        }
+        if (old == node->min || old == node->max)
+        {
+            refresh(node);
+        }
+        else
+        {
+            node->min = std::min(node->min, val);
+            node->max = std::max(node->max, val);
+        }
+        return old;
+    }
+
+    static void print_node(BTreeNode *node, bool &first)
+    {
+        if (node->leaf)
+        {
+            BTreeLeaf *leaf = static_cast<BTreeLeaf *>(node);
+            for (int i = 0; i < leaf->count; i++)
+            {
+                if (!first)
+                    std::cout << ", ";
+                std::cout << leaf->values[i];
+                first = false;
+            }
+            return;
+        }
+        BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+        for (int i = 0; i < branch->count; i++)
+            print_node(branch->children[i], first);
+    }
+
+  public:
+    // Default constructor
+    CountedBTree()
+    {
+    }
+
+    // Constructor for a list of values
+    CountedBTree(std::vector<int> values)
+    {
+        for (int v : values)
+            append(v);
+    }
+
+    CountedBTree(const CountedBTree &) = delete;
+    CountedBTree &operator=(const CountedBTree &) = delete;
+
+    ~CountedBTree()
+    {
+        if (root != nullptr)
+            destroy(root);
+    }
+
+    /**
+     * @brief Return the length of the list
+     *
+     * @return int The length
+     */
+    int length()
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param val The value to be appended
+     */
+    void append(int val)
+    {
+        insert(val, _size);
+    }
+
+    /**
+     * @brief Print values in the list
+     *
+     */
+    void print()
+    {
+        std::cout << "[";
+        bool first = true;
+        if (root != nullptr)
+            print_node(root, first);
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get value at a given index. It is returned by value, since a
+     * write through a reference would miss the cached minimum and maximum;
+     * use set() to change it.
+     *
+     * @param index The index
+     * @return int The value at that index
+     */
+    int operator[](int index)
+    {
+        check_index_out_of_bounds(index);
+        BTreeNode *node = root;
+        while (!node->leaf)
+        {
+            BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+            node = branch->children[find_child(branch, index)];
+        }
+        return static_cast<BTreeLeaf *>(node)->values[index];
+    }
+
+    /**
+     * @brief Replace the value at a given index, updating the minimum and
+     * maximum of the nodes on the way to it
+     *
+     * @param index The index
+     * @param val The new value
+     */
+    void set(int index, int val)
+    {
+        check_index_out_of_bounds(index);
+        set_in(root, index, val);
+    }
+
+    /**
+     * @brief Add element to the beginning of the list
+     *
+     * @param val The value to be added
+     */
+    void push_front(int val)
+    {
+        insert(val, 0);
+    }
+
+    /***
+     * @brief Add element to index chosen
+     *
+     * @param val The value to be added
+     * @param index The index
+     */
+    void insert(int val, int index)
+    {
+        index = std::max(0, std::min(index, _size));
+        if (root == nullptr)
+            root = new BTreeLeaf();
+
+        BTreeNode *split = insert_into(root, index, val);
+        _size++;
+        if (split != nullptr)
+        {
+            // The tree grows a level
+            BTreeBranch *branch = new BTreeBranch();
+            branch->count = 2;
+            branch->children[0] = root;
+            branch->children[1] = split;
+            branch->sizes[1] = subtree_size(split);
+            branch->sizes[0] = _size - branch->sizes[1];
+            refresh(branch);
+            root = branch;
+        }
+    }
+
+    /**
+     * @brief deletes the element at given index from the list.
+     *
+     * @param index The index.
+     */
+    void remove(int index)
+    {
+        pop(index);
+    }
+
+    /***
+     * @brief removing element at index given
+     *
+     * @param index
+     * @return int the value at that index
+     */
+    int pop(int index)
+    {
+        if (index < 0 || index >= _size)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        int value = remove_from(root, index);
+        _size--;
+
+        // The tree shrinks a level when the root has a single child
+        if (!root->leaf && root->count == 1)
+        {
+            BTreeBranch *branch = static_cast<BTreeBranch *>(root);
+            root = branch->children[0];
+            delete branch;
+        }
+        else if (root->count == 0)
+        {
+            destroy(root);
+            root = nullptr;
+        }
+        return value;
+    }
+
+    int pop()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        return pop(_size - 1);
+    }
+
+    int min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        return root->min;
+    }
+
+    int max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        return root->max;
+    }
+};
+
+struct CompactNode
+{
+    int value;
+    // Slots of the previous and next node in the node array
+    std::uint32_t prev;
+    std::uint32_t next;
+};
+
+/**
+ * @brief Linked list that keeps its nodes in one contiguous array and links
+ * them with 32-bit slot numbers instead of pointers, 12 bytes per element and
+ * no allocation per node. Slots of removed nodes are reused through a free
+ * list, and compact() renumbers the nodes into list order. Has the same
+ * interface as LinkedList.
+ *
+ */
+class CompactLinkedList
+{
+  private:
+    // Slot number that stands for "no node"
+    static constexpr std::uint32_t none = UINT32_MAX;
+
+    std::vector<CompactNode> nodes;
+    std::uint32_t head = none;
+    std::uint32_t tail = none;
+    // Free slots, linked through their next field
+    std::uint32_t free_list = none;
+    int _size = 0;
+
+    void check_index_out_of_bounds(int index)
+    {
+        if ((index < 0) || (index >= length()))
+            throw std::range_error("Index out of bounds");
+    }
+
+    // Find the slot of the node at the given index, walking from the closer end
+    std::uint32_t find_node_at_index(int index)
+    {
+        std::uint32_t current;
+        if (index < _size / 2)
+        {
+            current = head;
+            for (int i = 0; i < index; i++)
+                current = nodes[current].next;
+        }
+        else
+        {
+            current = tail;
+            for (int i = _size - 1; i > index; i--)
+                current = nodes[current].prev;
+        }
+        return current;
+    }
+
+    // Take a free slot, or a new one at the end of the array
+    std::uint32_t new_node(int val, std::uint32_t prev, std::uint32_t next)
+    {
+        std::uint32_t slot;
+        if (free_list != none)
+        {
+            slot = free_list;
+            free_list = nodes[slot].next;
+            nodes[slot] = {val, prev, next};
+        }
+        else
+        {
+            slot = nodes.size();
+            nodes.push_back({val, prev, next});
+        }
+        _size++;
+        return slot;
+    }
+
+    void erase_node(std::uint32_t slot)
+    {
+        CompactNode &node = nodes[slot];
+        if (node.prev != none)
+            nodes[node.prev].next = node.next;
+        else
+            head = node.next;
+        if (node.next != none)
+            nodes[node.next].prev = node.prev;
+        else
+            tail = node.prev;
+        node.next = free_list;
+        free_list = slot;
+        _size--;
+    }
+
+    // True when every slot of the array holds a node of the list
+    bool dense()
+    {
+        return free_list == none;
+    }
+
+  public:
+    // Default constructor
+    CompactLinkedList()
+    {
+    }
+
+    // Constructor for a list of values
+    CompactLinkedList(std::vector<int> values)
+    {
+        nodes.reserve(values.size());
+        for (int v : values)
+            append(v);
+    }
+
+    /**
+     * @brief Return the length of the list
+     *
+     * @return int The length
+     */
+    int length()
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param val The value to be appended
+     */
+    void append(int val)
+    {
+        std::uint32_t slot = new_node(val, tail, none);
+        if (tail != none)
+            nodes[tail].next = slot;
+        else
+            head = slot;
+        tail = slot;
+    }
+
+    /**
+     * @brief Print values in the list
+     *
+     */
+    void print()
+    {
+        std::cout << "[";
+        for (std::uint32_t current = head; current != none; current = nodes[current].next)
+        {
+            std::cout << nodes[current].value;
+            if (nodes[current].next != none)
+                std::cout << ", ";
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get value at a given index
+     *
+     * @param index The index
+     * @return int& Reference to the value at that index
+     */
+    int &operator[](int index)
+    {
+        check_index_out_of_bounds(index);
+        return nodes[find_node_at_index(index)].value;
+    }
+
+    /**
+     * @brief Add element to the beginning of the list
+     *
+     * @param val The value to be added
+     */
+    void push_front(int val)
+    {
+        std::uint32_t slot = new_node(val, none, head);
+        if (head != none)
+            nodes[head].prev = slot;
+        else
+            tail = slot;
+        head = slot;
+    }
+
+    /***
+     * @brief Add element to index chosen
+     *
+     * @param val The value to be added
+     * @param index The index
+     */
+    void insert(int val, int index)
+    {
+        if (index <= 0)
+        {
+            push_front(val);
+            return;
+        }
+        if (index >= _size)
+        {
+            append(val);
+            return;
+        }
+        std::uint32_t current = find_node_at_index(index);
+        std::uint32_t prev = nodes[current].prev;
+        std::uint32_t slot = new_node(val, prev, current);
+        nodes[prev].next = slot;
+        nodes[current].prev = slot;
+    }
+
+    /**
+     * @brief deletes the element at given index from the list.
+     *
+     * @param index The index.
+     */
+    void remove(int index)
+    {
+        pop(index);
+    }
+
+    /***
+     * @brief removing element at index given
+     *
+     * @param index
+     * @return int the value at that index
+     */
+    int pop(int index)
+    {
+        if (index < 0 || index >= _size)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        std::uint32_t current = find_node_at_index(index);
+        int value = nodes[current].value;
+        erase_node(current);
+        return value;
+    }
+
+    int pop()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int value = nodes[tail].value;
+        erase_node(tail);
+        return value;
+    }
+
+    // The order doesn't matter for min and max, so without free slots they
+    // read the node array front to back instead of following the links
+    int min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int minimum = nodes[head].value;
+        if (dense())
+        {
+            for (const CompactNode &node : nodes)
+                minimum = std::min(minimum, node.value);
+            return minimum;
+        }
+        for (std::uint32_t current = head; current != none; current = nodes[current].next)
+            minimum = std::min(minimum, nodes[current].value);
+        return minimum;
+    }
+
+    int max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int maximum = nodes[head].value;
+        if (dense())
+        {
+            for (const CompactNode &node : nodes)
+                maximum = std::max(maximum, node.value);
+            return maximum;
+        }
+        for (std::uint32_t current = head; current != none; current = nodes[current].next)
+            maximum = std::max(maximum, nodes[current].value);
+        return maximum;
+    }
+
+    /**
+     * @brief Renumber the nodes so that slot i holds element i and drop the
+     * free slots. Afterwards traversals walk the array front to back.
+     *
+     */
+    void compact()
+    {
+        std::vector<CompactNode> ordered;
+        ordered.reserve(_size);
+        std::uint32_t slot = 0;
+        for (std::uint32_t current = head; current != none; current = nodes[current].next)
+        {
+            ordered.push_back({nodes[current].value, slot == 0 ? none : slot - 1, slot + 1});
+            slot++;
+        }
+        if (_size > 0)
+            ordered.back().next = none;
+        nodes.swap(ordered);
+        head = _size > 0 ? 0 : none;
+        tail = _size > 0 ? _size - 1 : none;
+        free_list = none;
+    }
+
+    // Number of node slots, used and free
+    int slot_count()
+    {
+        return nodes.size();
+    }
+};
+
+/**
+ * @brief Epoch-based reclamation for lock-free structures. Threads enter the
+ * domain with a Guard for the length of one operation, and nodes unlinked
+ * during an operation are retired instead of deleted. A retired node is
+ * deleted once the global epoch has moved on twice, because by then every
+ * thread that could still see it has left the domain.
+ *
+ */
+class EpochDomain
+{
+  private:
+    static constexpr std::uint64_t idle = UINT64_MAX;
+    // How many retirements between attempts to move the epoch on
+    static constexpr int advance_interval = 64;
+
+    struct Retired
+    {
+        void *pointer;
+        // Called with the context and the pointer once it is safe
+        void (*reclaim)(void *, void *);
+        void *context;
+    };
+
+    // State of one thread in the domain. Records are never freed while the
+    // domain lives; a thread that exits hands its record to the next one.
+    struct Record
+    {
+        // The epoch the thread is in, or idle
+        std::atomic<std::uint64_t> epoch{idle};
+        std::atomic<bool> owned{true};
+        // Nodes retired by the thread, by epoch modulo 3
+        std::vector<Retired> limbo[3];
+        std::uint64_t limbo_epoch[3] = {0, 0, 0};
+        int retired = 0;
+        Record *next = nullptr;
+    };
+
+    // Shared with the threads that have a record here, so that a record
+    // outlives the domain for as long as its thread holds on to it
+    struct Registry
+    {
+        std::atomic<std::uint64_t> global{0};
+        std::atomic<Record *> records{nullptr};
+
+        ~Registry()
+        {
+            Record *record = records.load();
+            while (record != nullptr)
+            {
+                Record *next = record->next;
+                delete record;
+                record = next;
+            }
+        }
+    };
+
+    // A record held by the current thread, given back when the thread exits
+    struct Registration
+    {
+        std::shared_ptr<Registry> registry;
+        Record *record;
+
+        Registration(std::shared_ptr<Registry> registry, Record *record) : registry(std::move(registry)), record(record)
+        {
+        }
+
+        Registration(Registration &&other) noexcept : registry(std::move(other.registry)), record(other.record)
+        {
+            other.record = nullptr;
+        }
+
+        Registration &operator=(Registration &&other) noexcept
+        {
+            std::swap(registry, other.registry);
+            std::swap(record, other.record);
+            return *this;
+        }
+
+        ~Registration()
+        {
+            if (record != nullptr)
+                record->owned.store(false, std::memory_order_release);
+        }
+    };
+
+    std::shared_ptr<Registry> registry = std::make_shared<Registry>();
+
+    static void free_all(std::vector<Retired> &limbo)
+    {
+        for (Retired &retired : limbo)
+            retired.reclaim(retired.context, retired.pointer);
+        limbo.clear();
+    }
+
+    // The record of the current thread, claimed on its first visit
+    Record *record()
+    {
+        thread_local std::vector<Registration> registrations;
+        for (Registration &registration : registrations)
+        {
+            if (registration.registry == registry)
+                return registration.record;
+        }
+        // Forget domains that no longer exist
+        registrations.erase(std::remove_if(registrations.begin(), registrations.end(),
+                                           [](const Registration &r) { return r.registry.use_count() == 1; }),
+                            registrations.end());
+
+        Record *claimed = nullptr;
+        for (Record *r = registry->records.load(); r != nullptr && claimed == nullptr; r = r->next)
+        {
+            bool owned = false;
+            if (!r->owned.load(std::memory_order_relaxed) && r->owned.compare_exchange_strong(owned, true))
+                claimed = r;
+        }
+        if (claimed == nullptr)
+        {
+            claimed = new Record;
+            claimed->next = registry->records.load();
+            while (!registry->records.compare_exchange_weak(claimed->next, claimed))
+            {
+            }
+        }
+        registrations.emplace_back(registry, claimed);
+        return claimed;
+    }
+
+    // Move the global epoch on if every thread inside the domain has seen it
+    void try_advance()
+    {
+        std::uint64_t epoch = registry->global.load();
+        for (Record *r = registry->records.load(); r != nullptr; r = r->next)
+        {
+            std::uint64_t seen = r->epoch.load();
+            if (seen != idle && seen != epoch)
+                return;
+        }
+        registry->global.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+  public:
+    EpochDomain()
+    {
+    }
+
+    EpochDomain(const EpochDomain &) = delete;
+    EpochDomain &operator=(const EpochDomain &) = delete;
+
+    ~EpochDomain()
+    {
+        reclaim_all();
+    }
+
+    // Reclaim everything still waiting. No thread may be inside the domain.
+    void reclaim_all()
+    {
+        for (Record *r = registry->records.load(); r != nullptr; r = r->next)
+        {
+            for (std::vector<Retired> &limbo : r->limbo)
+                free_all(limbo);
+        }
+    }
+
+    /**
+     * @brief Marks the current thread as inside the domain while it lives.
+     * Nodes reachable while the guard is held are not deleted.
+     *
+     */
+    class Guard
+    {
+        EpochDomain &domain;
+        Record *record;
+
+      public:
+        explicit Guard(EpochDomain &domain) : domain(domain), record(domain.record())
+        {
+            // Announce an epoch that is still current after the announcement
+            std::uint64_t epoch = domain.registry->global.load();
+            while (true)
+            {
+                record->epoch.store(epoch);
+                std::uint64_t now = domain.registry->global.load();
+                if (now == epoch)
+                    break;
+                epoch = now;
+            }
+        }
+
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+        ~Guard()
+        {
+            record->epoch.store(idle, std::memory_order_release);
+        }
+
+        /**
+         * @brief Delete a node once no thread can see it any more
+         *
+         * @param node A node that has been unlinked and can't be reached
+         */
+        template <typename T>
+        void retire(T *node)
+        {
+            retire(node, [](void *, void *p) { delete static_cast<T *>(p); }, nullptr);
+        }
+
+        /**
+         * @brief Hand a node to a reclaim function once no thread can see it
+         * any more, e.g. to put it on a free list
+         *
+         * @param node A node that has been unlinked and can't be reached
+         * @param reclaim Called as reclaim(context, node)
+         * @param context Passed on to reclaim
+         */
+        void retire(void *node, void (*reclaim)(void *, void *), void *context)
+        {
+            std::uint64_t epoch = record->epoch.load(std::memory_order_relaxed);
+            int slot = epoch % 3;
+            // Whatever is in this slot was retired at least three epochs ago
+            if (record->limbo_epoch[slot] != epoch)
+            {
+                free_all(record->limbo[slot]);
+                record->limbo_epoch[slot] = epoch;
+            }
+            record->limbo[slot].push_back({node, reclaim, context});
+            if (++record->retired % advance_interval == 0)
+                domain.try_advance();
+        }
+    };
+};
+
+struct LockFreeNode
+{
+    int value;
+    // The lowest bit marks this node as removed
+    std::atomic<LockFreeNode *> next;
+};
+
+/**
+ * @brief Sorted set of ints that many threads can use at once without locks
+ * (Harris' list with Michael's unlinking). A node is removed by first
+ * marking its next pointer and then unlinking it; threads that find a marked
+ * node on their way help unlink it. Unlinked nodes are reclaimed through an
+ * EpochDomain.
+ *
+ */
+class LockFreeSortedList
+{
+  private:
+    // Sentinel in front of the first node
+    LockFreeNode head{0, {nullptr}};
+    EpochDomain epochs;
+
+    static bool is_marked(LockFreeNode *p)
+    {
+        return reinterpret_cast<std::uintptr_t>(p) & 1;
+    }
+
+    static LockFreeNode *marked(LockFreeNode *p)
+    {
+        return reinterpret_cast<LockFreeNode *>(reinterpret_cast<std::uintptr_t>(p) | 1);
+    }
+
+    static LockFreeNode *unmarked(LockFreeNode *p)
+    {
+        return reinterpret_cast<LockFreeNode *>(reinterpret_cast<std::uintptr_t>(p) & ~std::uintptr_t(1));
+    }
+
+    /**
+     * @brief Find the first node with a value not less than val, unlinking
+     * removed nodes on the way
+     *
+     * @param val The value
+     * @param prev Set to the link that points to the node
+     * @param current Set to the node, null at the end of the list
+     * @return bool True if the node holds val
+     */
+    bool find(int val, std::atomic<LockFreeNode *> *&prev, LockFreeNode *&current, EpochDomain::Guard &guard)
+    {
+    retry:
+        prev = &head.next;
+        current = prev->load();
+        while (current != nullptr)
+        {
+            LockFreeNode *next = current->next.load();
+            if (is_marked(next))
+            {
+                LockFreeNode *expected = current;
+                if (!prev->compare_exchange_strong(expected, unmarked(next)))
+                    goto retry;
+                guard.retire(current);
+                current = unmarked(next);
+                continue;
+            }
+            if (current->value >= val)
+                return current->value == val;
+            prev = &current->next;
+            current = next;
+        }
+        return false;
+    }
+
+  public:
+    LockFreeSortedList()
+    {
+    }
+
+    LockFreeSortedList(const LockFreeSortedList &) = delete;
+    LockFreeSortedList &operator=(const LockFreeSortedList &) = delete;
+
+    // No other thread may use the list any more
+    ~LockFreeSortedList()
+    {
+        LockFreeNode *current = unmarked(head.next.load());
+        while (current != nullptr)
+        {
+            LockFreeNode *next = unmarked(current->next.load());
+            delete current;
+            current = next;
+        }
+    }
+
+    /**
+     * @brief Add a value to the set
+     *
+     * @param val The value
+     * @return bool False if the value was already there
+     */
+    bool insert(int val)
+    {
+        EpochDomain::Guard guard(epochs);
+        LockFreeNode *node = nullptr;
+        while (true)
+        {
+            std::atomic<LockFreeNode *> *prev;
+            LockFreeNode *current;
+            if (find(val, prev, current, guard))
+            {
+                delete node;
+                return false;
+            }
+            if (node == nullptr)
+                node = new LockFreeNode{val, {current}};
+            else
+                node->next.store(current, std::memory_order_relaxed);
+            if (prev->compare_exchange_strong(current, node))
+                return true;
+        }
+    }
+
+    /**
+     * @brief Remove a value from the set
+     *
+     * @param val The value
+     * @return bool False if the value wasn't there
+     */
+    bool remove(int val)
+    {
+        EpochDomain::Guard guard(epochs);
+        while (true)
+        {
+            std::atomic<LockFreeNode *> *prev;
+            LockFreeNode *current;
+            if (!find(val, prev, current, guard))
+                return false;
+            LockFreeNode *next = current->next.load();
+            if (is_marked(next) || !current->next.compare_exchange_strong(next, marked(next)))
+                continue;
+            // The node is removed; unlink it now or leave it to find()
+            LockFreeNode *expected = current;
+            if (prev->compare_exchange_strong(expected, next))
+                guard.retire(current);
+            else
+                find(val, prev, current, guard);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Check if a value is in the set, without writing to the list
+     *
+     * @param val The value
+     * @return bool True if it is there
+     */
+    bool contains(int val)
+    {
+        EpochDomain::Guard guard(epochs);
+        LockFreeNode *current = unmarked(head.next.load());
+        while (current != nullptr && current->value < val)
+            current = unmarked(current->next.load());
+        return current != nullptr && current->value == val && !is_marked(current->next.load());
+    }
+};
+
+struct QueueNode
+{
+    int value;
+    std::atomic<QueueNode *> next;
+};
+
+/**
+ * @brief Queue of ints for many producers and consumers without locks
+ * (Michael and Scott). The head is a dummy node; enqueue links a node after
+ * the last one and swings the tail, dequeue swings the head to the next node
+ * and returns its value. Old dummies are recycled through a free list once
+ * the EpochDomain says no thread can see them.
+ *
+ * A queue made with the single_thread mode may only be used from one thread
+ * at a time and skips the compare-and-swaps and the epochs.
+ *
+ */
+class LockFreeQueue
+{
+  public:
+    enum Mode
+    {
+        concurrent,
+        single_thread
+    };
+
+  private:
+    // Head and tail on their own cache lines, so producers and consumers
+    // don't slow each other down
+    alignas(64) std::atomic<QueueNode *> head;
+    alignas(64) std::atomic<QueueNode *> tail;
+    // Nodes ready for reuse, a stack linked through next
+    alignas(64) std::atomic<QueueNode *> free_nodes{nullptr};
+    std::atomic<long long> allocations{0};
+    Mode mode;
+    EpochDomain epochs;
+
+    // Take a node from the free list, or a new one. In concurrent mode the
+    // caller holds a guard, so a node can't come back to the free list while
+    // another thread is looking at it.
+    QueueNode *new_node(int val)
+    {
+        QueueNode *node = free_nodes.load(std::memory_order_acquire);
+        while (node != nullptr &&
+               !free_nodes.compare_exchange_weak(node, node->next.load(std::memory_order_relaxed),
+                                                 std::memory_order_acquire))
+        {
+        }
+        if (node == nullptr)
+        {
+            node = new QueueNode;
+            allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        node->value = val;
+        node->next.store(nullptr, std::memory_order_relaxed);
+        return node;
+    }
+
+    static void recycle(void *queue, void *pointer)
+    {
+        LockFreeQueue *self = static_cast<LockFreeQueue *>(queue);
+        QueueNode *node = static_cast<QueueNode *>(pointer);
+        QueueNode *top = self->free_nodes.load(std::memory_order_relaxed);
+        do
+        {
+            node->next.store(top, std::memory_order_relaxed);
+        } while (!self->free_nodes.compare_exchange_weak(top, node, std::memory_order_release));
+    }
+
+    static void delete_chain(QueueNode *node)
+    {
+        while (node != nullptr)
+        {
+            QueueNode *next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+
+  public:
+    explicit LockFreeQueue(Mode mode = concurrent) : mode(mode)
+    {
+        QueueNode *dummy = new QueueNode{0, {nullptr}};
+        allocations.store(1);
+        head.store(dummy);
+        tail.store(dummy);
+    }
+
+    LockFreeQueue(const LockFreeQueue &) = delete;
+    LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+
+    // No other thread may use the queue any more
+    ~LockFreeQueue()
+    {
+        epochs.reclaim_all();
+        delete_chain(head.load());
+        delete_chain(free_nodes.load());
+    }
+
+    /**
+     * @brief Add a value at the back of the queue
+     *
+     * @param val The value
+     */
+    void enqueue(int val)
+    {
+        if (mode == single_thread)
+        {
+            QueueNode *node = new_node(val);
+            tail.load(std::memory_order_relaxed)->next.store(node, std::memory_order_relaxed);
+            tail.store(node, std::memory_order_relaxed);
+            return;
+        }
+
+        EpochDomain::Guard guard(epochs);
+        QueueNode *node = new_node(val);
+        while (true)
+        {
+            QueueNode *last = tail.load();
+            QueueNode *next = last->next.load();
+            if (last != tail.load())
+                continue;
+            if (next != nullptr)
+            {
+                // The tail is behind; help move it on
+                tail.compare_exchange_weak(last, next);
+                continue;
+            }
+            if (last->next.compare_exchange_weak(next, node))
+            {
+                tail.compare_exchange_strong(last, node);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Take the value at the front of the queue
+     *
+     * @param val Set to the value
+     * @return bool False if the queue was empty
+     */
+    bool dequeue(int &val)
+    {
+        if (mode == single_thread)
+        {
+            QueueNode *first = head.load(std::memory_order_relaxed);
+            QueueNode *next = first->next.load(std::memory_order_relaxed);
+            if (next == nullptr)
+                return false;
+            val = next->value;
+            head.store(next, std::memory_order_relaxed);
+            recycle(this, first);
+            return true;
+        }
+
+        EpochDomain::Guard guard(epochs);
+        while (true)
+        {
+            QueueNode *first = head.load();
+            QueueNode *last = tail.load();
+            QueueNode *next = first->next.load();
+            if (first != head.load())
+                continue;
+            if (first == last)
+            {
+                if (next == nullptr)
+                    return false;
+                tail.compare_exchange_weak(last, next);
+                continue;
+            }
+            // Read the value before another consumer can recycle the node
+            int value = next->value;
+            if (head.compare_exchange_weak(first, next))
+            {
+                val = value;
+                guard.retire(first, recycle, this);
+                return true;
+            }
+        }
+    }
+
+    // Check if the queue is empty; may be stale as soon as it returns
+    bool empty()
+    {
+        return head.load()->next.load() == nullptr;
+    }
+
+    // Number of nodes taken from the heap; the rest were recycled
+    long long node_allocations()
+    {
+        return allocations.load(std::memory_order_relaxed);
+    }
+};
+
+
+#include <chrono>    // for high_resolution_clock
+#include <cstdio>    // for popen, fgets
+#include <cstdlib>   // for malloc, aligned_alloc, free, atof
+#include <fstream>   // for ofstream
+#include <iomanip>   // for setprecision
+#include <iostream>  // for cout
+#include <new>       // for bad_alloc, align_val_t, nothrow_t
+#include <sstream>   // for ostringstream
+#include <stdexcept> // for runtime_error
+#include <string>    // for string
+
+#if defined(__linux__)
+#include <linux/perf_event.h> // for perf_event_attr
+#include <sys/ioctl.h>        // for ioctl
+#include <sys/syscall.h>      // for SYS_perf_event_open
+#include <unistd.h>           // for syscall, read, close
+#endif
+
+
+
+using namespace std::chrono;
+
+/**
+ * @brief Hardware performance counters through perf_event_open, for the
+ * measured regions of the benchmarks. Each counter is opened on its own, so
+ * the ones the machine has still work when others are missing; on systems
+ * without perf events, or when the kernel doesn't allow them, every counter
+ * reads as unavailable and the benchmarks only report time.
+ *
+ */
+namespace perf {
+
+enum Event
+{
+    cycles,
+    instructions,
+    l1d_misses,
+    llc_misses,
+    dtlb_misses,
+    branch_misses,
+    event_count
+};
+
+inline const char *event_name(int event)
+{
+    static const char *names[event_count] = {"cycles", "instructions", "l1d-misses",
+                                             "llc-misses", "dtlb-misses", "branch-misses"};
+    return names[event];
+}
+
+// Counter values, each with a flag telling whether the counter works
+struct Reading
+{
+    bool available[event_count] = {};
+    double value[event_count] = {};
+
+    bool any() const
+    {
+        for (bool a : available)
+        {
+            if (a)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Instructions per cycle, or a negative number if unknown
+    double ipc() const
+    {
+        if (!available[cycles] || !available[instructions] || value[cycles] == 0)
+        {
+            return -1;
+        }
+        return value[instructions] / value[cycles];
+    }
+
+    Reading per(double operations) const
+    {
+        Reading scaled = *this;
+        for (double &v : scaled.value)
+        {
+            v /= operations;
+        }
+        return scaled;
+    }
+};
+
+class Counters
+{
+  private:
+    int fds[event_count];
+    // Whether instructions is in a group led by cycles, so that both are
+    // counted over the same time and IPC compares like with like
+    bool grouped = false;
+
+#if defined(__linux__)
+    // Open a counter on its own, or as a member of the group led by leader
+    static int open_event(std::uint32_t type, std::uint64_t config, int leader = -1, bool group_format = false)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        // Members follow their leader
+        attr.disabled = leader < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        if (group_format)
+        {
+            attr.read_format |= PERF_FORMAT_GROUP;
+        }
+        return syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+    }
+
+    static std::uint64_t cache_event(std::uint64_t cache, std::uint64_t result)
+    {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+    }
+#endif
+
+    void control(unsigned long request)
+    {
+#if defined(__linux__)
+        for (int event = 0; event < event_count; event++)
+        {
+            if (fds[event] >= 0 && !(grouped && event == instructions))
+            {
+                ioctl(fds[event], request, event == cycles ? PERF_IOC_FLAG_GROUP : 0);
+            }
+        }
+#endif
+    }
+
+  public:
+    Counters()
+    {
+        for (int &fd : fds)
+        {
+            fd = -1;
+        }
+#if defined(__linux__)
+        // Cycles leads a group, read in one go, that instructions joins if
+        // the PMU can count both at once
+        fds[cycles] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1, true);
+        if (fds[cycles] >= 0)
+        {
+            fds[instructions] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, fds[cycles], true);
+            grouped = fds[instructions] >= 0;
+        }
+        if (!grouped)
+        {
+            fds[instructions] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        }
+        fds[l1d_misses] = open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS));
+        fds[llc_misses] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        fds[dtlb_misses] = open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS));
+        fds[branch_misses] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    }
+
+    Counters(const Counters &) = delete;
+    Counters &operator=(const Counters &) = delete;
+
+    ~Counters()
+    {
+#if defined(__linux__)
+        for (int fd : fds)
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    // Counters shared by all benchmarks
+    static Counters &instance()
+    {
+        static Counters counters;
+        static bool told = false;
+        if (!told && !counters.any_available())
+        {
+            std::cout << "Hardware counters are not available, reporting time only\n";
+        }
+        told = true;
+        return counters;
+    }
+
+    bool available(int event)
+    {
+        return fds[event] >= 0;
+    }
+
+    bool any_available()
+    {
+        for (int event = 0; event < event_count; event++)
+        {
+            if (available(event))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+#if defined(__linux__)
+    // Set all counters to zero
+    void reset()
+    {
+        control(PERF_EVENT_IOC_RESET);
+    }
+
+    // Count from here
+    void start()
+    {
+        control(PERF_EVENT_IOC_ENABLE);
+    }
+
+    // Stop counting; the counts stay until reset
+    void stop()
+    {
+        control(PERF_EVENT_IOC_DISABLE);
+    }
+#else
+    void reset()
+    {
+    }
+
+    void start()
+    {
+    }
+
+    void stop()
+    {
+    }
+#endif
+
+    /**
+     * @brief Read the counters, scaled up for the time a counter was
+     * multiplexed out. Cycles and instructions come from one group read,
+     * so they are scaled by the same time.
+     *
+     * @return Reading The counts since the last reset
+     */
+    Reading read()
+    {
+        Reading reading;
+#if defined(__linux__)
+        // Group format: number of counters, time enabled, time running, then
+        // one value per counter in the order they joined
+        std::uint64_t group[5];
+        int group_size = grouped ? 2 : 1;
+        if (fds[cycles] >= 0 && ::read(fds[cycles], group, (3 + group_size) * sizeof(std::uint64_t)) ==
+                                    (ssize_t)((3 + group_size) * sizeof(std::uint64_t)) &&
+            group[2] != 0)
+        {
+            for (int i = 0; i < group_size; i++)
+            {
+                int event = i == 0 ? cycles : instructions;
+                reading.available[event] = true;
+                reading.value[event] = (double)group[3 + i] * group[1] / group[2];
+            }
+        }
+        for (int event = 0; event < event_count; event++)
+        {
+            if (event == cycles || (grouped && event == instructions))
+            {
+                continue;
+            }
+            std::uint64_t data[3];
+            if (fds[event] < 0 || ::read(fds[event], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+            {
+                continue;
+            }
+            reading.available[event] = true;
+            reading.value[event] = (double)data[0] * data[1] / data[2];
+        }
+#endif
+        return reading;
+    }
+};
+
+} // namespace perf
+
+/**
+ * @brief Benchmark harness: runs a measured body a few times to warm up,
+ * then takes repeated samples with a nanosecond steady clock until it has
+ * enough of them or runs out of time, and summarises them.
+ *
+ */
+namespace harness {
+
+/**
+ * @brief Keep the compiler from optimizing away a value, or the work that
+ * produced it
+ *
+ * @param value The value
+ */
+template <typename T>
+inline void do_not_optimize(const T &value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+struct Options
+{
+    // Runs of the body that aren't measured
+    int warmup = 1;
+    // Samples to take at least and at most
+    int min_samples = 5;
+    int max_samples = 100;
+    // Stop taking samples once this much time went by and min_samples is reached
+    double time_budget_seconds = 0.25;
+};
+
+// Summary of the samples, in nanoseconds per operation
+struct Stats
+{
+    int samples = 0;
+    double mean = 0;
+    double median = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double min = 0;
+    double max = 0;
+    // 95% confidence interval for the median
+    double ci_low = 0;
+    double ci_high = 0;
+    // Hardware counters per operation, over all samples
+    perf::Reading counters;
+};
+
+/**
+ * @brief Summarise samples. Percentiles use the nearest rank, and the
+ * confidence interval for the median comes from the order statistics at
+ * n/2 -+ 1.96 sqrt(n)/2, which needs no assumption about the distribution.
+ *
+ * @param samples Nanoseconds per operation, one per sample
+ * @return Stats The summary
+ */
+inline Stats summarise(std::vector<double> samples)
+{
+    Stats stats;
+    int n = samples.size();
+    if (n == 0)
+    {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto rank = [&samples, n](double fraction) {
+        int i = (int)std::ceil(fraction * n) - 1;
+        return samples[std::max(0, std::min(n - 1, i))];
+    };
+    stats.samples = n;
+    double sum = 0;
+    for (double s : samples)
+    {
+        sum += s;
+    }
+    stats.mean = sum / n;
+    stats.median = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    stats.p90 = rank(0.90);
+    stats.p99 = rank(0.99);
+    stats.min = samples.front();
+    stats.max = samples.back();
+    double spread = 0.98 * std::sqrt((double)n);
+    stats.ci_low = samples[std::max(0, (int)std::floor(n / 2.0 - spread))];
+    stats.ci_high = samples[std::min(n - 1, (int)std::ceil(n / 2.0 + spread))];
+    return stats;
+}
+
+/**
+ * @brief Time a body that needs fresh state for every call, e.g. because it
+ * sorts or edits its input. setup runs before each call of body and is
+ * neither timed nor counted, but it does use up the time budget.
+ *
+ * @param setup Builds the state body works on
+ * @param body The measured work; it should pass its results to do_not_optimize
+ * @param operations Number of operations one call of body does
+ * @param options How much to warm up and sample
+ * @return Stats The time per operation
+ */
+template <typename Setup, typename Body>
+Stats measure(Setup setup, Body body, long long operations, Options options = Options{})
+{
+    for (int i = 0; i < options.warmup; i++)
+    {
+        setup();
+        body();
+    }
+    perf::Counters &counters = perf::Counters::instance();
+    counters.reset();
+    std::vector<double> samples;
+    auto begin = steady_clock::now();
+    while ((int)samples.size() < options.max_samples)
+    {
+        setup();
+        counters.start();
+        auto start = steady_clock::now();
+        body();
+        auto stop = steady_clock::now();
+        counters.stop();
+        samples.push_back(duration_cast<nanoseconds>(stop - start).count() / (double)operations);
+
+        double elapsed = duration_cast<nanoseconds>(stop - begin).count() / 1E9;
+        if ((int)samples.size() >= options.min_samples && elapsed > options.time_budget_seconds)
+        {
+            break;
+        }
+    }
+    Stats stats = summarise(samples);
+    stats.counters = counters.read().per((double)operations * samples.size());
+    return stats;
+}
+
+/**
+ * @brief Time a body that does a number of operations per call
+ *
+ * @param body The measured work; it should pass its results to do_not_optimize
+ * @param operations Number of operations one call of body does
+ * @param options How much to warm up and sample
+ * @return Stats The time per operation
+ */
+template <typename Body>
+Stats measure(Body body, long long operations = 1, Options options = Options{})
+{
+    return measure([] {}, body, operations, options);
+}
+
+/**
+ * @brief Write one result line: N median p90 p99 ci-low ci-high (ns per
+ * operation) to cout and to a file. When hardware counters work, the line
+ * goes on with IPC and L1D, LLC, dTLB and branch misses per operation, with
+ * "-" for a counter that is missing.
+ *
+ */
+inline void report(std::ostream &out, int N, const Stats &stats)
+{
+    std::ostringstream line;
+    line << N << " " << stats.median << " " << stats.p90 << " " << stats.p99 << " " << stats.ci_low << " "
+         << stats.ci_high;
+    const perf::Reading &c = stats.counters;
+    if (c.any())
+    {
+        if (c.ipc() >= 0)
+            line << " " << c.ipc();
+        else
+            line << " -";
+        for (int event : {perf::l1d_misses, perf::llc_misses, perf::dtlb_misses, perf::branch_misses})
+        {
+            if (c.available[event])
+                line << " " << c.value[event];
+            else
+                line << " -";
+        }
+    }
+    std::cout << line.str() << "\n";
+    out << line.str() << "\n";
+}
+
+} // namespace harness
+
+#if defined(BENCH_MEMORY)
+
+/**
+ * @brief Allocation accounting. The global operator new and delete below
+ * put a small header in front of every block so that frees know its size;
+ * while a Scope is open, allocations are counted along with the bytes asked
+ * for and the most bytes alive at one time. The header and the counting
+ * would change what the timing benchmarks measure, so all of this is only
+ * built with -DBENCH_MEMORY.
+ *
+ */
+namespace memory {
+
+// The open Scope, 0 when none is. Every Scope gets a larger id than the
+// ones before it, so a block belongs to the open Scope, or to one that has
+// closed into it, when its id is at least the open one's
+std::atomic<unsigned long long> open_scope{0};
+unsigned long long last_scope = 0;
+std::atomic<long long> allocations{0};
+std::atomic<long long> bytes_requested{0};
+std::atomic<long long> live_bytes{0};
+std::atomic<long long> peak_live_bytes{0};
+// Bytes of blocks from before the open Scope that were freed inside it
+std::atomic<long long> earlier_freed{0};
+
+struct alignas(std::max_align_t) Header
+{
+    std::size_t size;
+    // Distance from the start of the underlying block to the user pointer
+    std::size_t offset;
+    // The Scope the block was allocated in, 0 when it wasn't counted
+    unsigned long long scope;
+};
+
+inline void *allocate(std::size_t size, std::size_t alignment, bool nothrow)
+{
+    alignment = std::max(alignment, alignof(Header));
+    std::size_t offset = (sizeof(Header) + alignment - 1) / alignment * alignment;
+    void *raw;
+    if (alignment > alignof(std::max_align_t))
+        raw = std::aligned_alloc(alignment, (offset + size + alignment - 1) / alignment * alignment);
+    else
+        raw = std::malloc(offset + size);
+    if (raw == nullptr)
+    {
+        if (nothrow)
+            return nullptr;
+        throw std::bad_alloc();
+    }
+
+    char *pointer = static_cast<char *>(raw) + offset;
+    Header *header = reinterpret_cast<Header *>(pointer) - 1;
+    header->size = size;
+    header->offset = offset;
+    header->scope = open_scope.load(std::memory_order_relaxed);
+    if (header->scope != 0)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes_requested.fetch_add(size, std::memory_order_relaxed);
+        long long live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        long long peak = peak_live_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+    }
+    return pointer;
+}
+
+inline void release(void *pointer)
+{
+    if (pointer == nullptr)
+        return;
+    Header *header = static_cast<Header *>(pointer) - 1;
+    unsigned long long scope = open_scope.load(std::memory_order_relaxed);
+    if (header->scope != 0 && scope != 0)
+    {
+        if (header->scope >= scope)
+            live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+        else
+            earlier_freed.fetch_add(header->size, std::memory_order_relaxed);
+    }
+    std::free(static_cast<char *>(pointer) - header->offset);
+}
+
+struct Snapshot
+{
+    long long allocations;
+    long long bytes_requested;
+    long long live_bytes;
+    long long peak_live_bytes;
+};
+
+/**
+ * @brief Counts the allocations made while it lives, starting from zero.
+ * Blocks allocated before it are not counted, not even when they are freed.
+ * Scopes nest: when one closes, its counts are added to the one around it,
+ * and the earlier blocks it saw freed come off that one's live bytes. Those
+ * are taken to be the outer Scope's own, which holds for one level of
+ * nesting.
+ *
+ */
+class Scope
+{
+  private:
+    Snapshot outer;
+    long long outer_earlier_freed;
+    unsigned long long outer_scope;
+
+  public:
+    Scope()
+        : outer{allocations.load(), bytes_requested.load(), live_bytes.load(), peak_live_bytes.load()},
+          outer_earlier_freed(earlier_freed.load()), outer_scope(open_scope.load())
+    {
+        allocations = 0;
+        bytes_requested = 0;
+        live_bytes = 0;
+        peak_live_bytes = 0;
+        earlier_freed = 0;
+        open_scope = ++last_scope;
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    ~Scope()
+    {
+        Snapshot inner = read();
+        allocations = outer.allocations + inner.allocations;
+        bytes_requested = outer.bytes_requested + inner.bytes_requested;
+        live_bytes = outer.live_bytes + inner.live_bytes - earlier_freed.load();
+        peak_live_bytes = std::max(outer.peak_live_bytes, outer.live_bytes + inner.peak_live_bytes);
+        earlier_freed = outer_earlier_freed;
+        open_scope = outer_scope;
+    }
+
+    Snapshot read()
+    {
+        return {allocations.load(), bytes_requested.load(), live_bytes.load(), peak_live_bytes.load()};
+    }
+};
+
+} // namespace memory
+
+void *operator new(std::size_t size)
+{
+    return memory::allocate(size, alignof(std::max_align_t), false);
+}
+
+void *operator new[](std::size_t size)
+{
+    return memory::allocate(size, alignof(std::max_align_t), false);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return memory::allocate(size, alignof(std::max_align_t), true);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return memory::allocate(size, alignof(std::max_align_t), true);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return memory::allocate(size, static_cast<std::size_t>(alignment), false);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return memory::allocate(size, static_cast<std::size_t>(alignment), false);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return memory::allocate(size, static_cast<std::size_t>(alignment), true);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return memory::allocate(size, static_cast<std::size_t>(alignment), true);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    memory::release(pointer);
+}
 
-        for (int i = 0; i < _size; i++) {
-            if (_data[i] == value) {
-                count++;
+void operator delete[](void *pointer) noexcept
+{
+    memory::release(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    memory::release(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    memory::release(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+    memory::release(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+    memory::release(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept
+{
+    memory::release(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept
+{
+    memory::release(pointer);
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept
+{
+    memory::release(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept
+{
+    memory::release(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    memory::release(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    memory::release(pointer);
+}
+
+#endif // BENCH_MEMORY
+
+
+/**
+ * @brief Structured results. Benchmarks add their numbers here as well as to
+ * their text files, and main saves them together with the compiler, flags,
+ * CPU and commit as results.json and results.csv. A results.csv from an
+ * earlier run can be read back as the baseline to compare against.
+ *
+ */
+namespace results {
+
+// Which direction of change is an improvement
+enum Better
+{
+    lower,
+    higher
+};
+
+struct Record
+{
+    std::string container;
+    std::string operation;
+    // Size of the benchmark: elements, or threads for the throughput ones
+    long long n = 0;
+    std::string unit;
+    Better better = lower;
+    harness::Stats stats;
+};
+
+struct Metadata
+{
+    std::string compiler;
+    std::string flags;
+    std::string cpu;
+    std::string commit;
+};
+
+struct Run
+{
+    Metadata metadata;
+    std::vector<Record> records;
+};
+
+/**
+ * @brief The records added so far in this run
+ *
+ */
+inline std::vector<Record> &recorded()
+{
+    static std::vector<Record> records;
+    return records;
+}
+
+/**
+ * @brief Record a sampled measurement
+ *
+ */
+inline void add(const std::string &container, const std::string &operation, long long n,
+                const harness::Stats &stats, const std::string &unit = "ns/op", Better better = lower)
+{
+    recorded().push_back(Record{container, operation, n, unit, better, stats});
+}
+
+/**
+ * @brief Record a single value, like a byte or allocation count. compare
+ * shows how it changed but doesn't count it as a regression.
+ *
+ */
+inline void add(const std::string &container, const std::string &operation, long long n, double value,
+                const std::string &unit, Better better = lower)
+{
+    harness::Stats stats;
+    stats.samples = 1;
+    stats.mean = stats.median = stats.p90 = stats.p99 = value;
+    stats.min = stats.max = stats.ci_low = stats.ci_high = value;
+    add(container, operation, n, stats, unit, better);
+}
+
+inline std::string trim(const std::string &s)
+{
+    std::size_t first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos)
+    {
+        return "";
+    }
+    std::size_t last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+inline std::string compiler()
+{
+#if defined(__clang__)
+    return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+}
+
+/**
+ * @brief The compiler flags. There is no portable way to get them from
+ * inside the program, so build with -DBENCH_FLAGS="\"$CXXFLAGS\"" to record
+ * them exactly; otherwise they are described from what the compiler
+ * predefines.
+ *
+ */
+inline std::string flags()
+{
+#if defined(BENCH_FLAGS)
+    return BENCH_FLAGS;
+#else
+    std::string flags = "c++" + std::to_string(__cplusplus / 100 % 100);
+#if defined(__OPTIMIZE_SIZE__)
+    flags += " optimized-for-size";
+#elif defined(__OPTIMIZE__)
+    flags += " optimized";
+#else
+    flags += " unoptimized";
+#endif
+#if defined(NDEBUG)
+    flags += " NDEBUG";
+#endif
+#if defined(__AVX512F__)
+    flags += " avx512f";
+#elif defined(__AVX2__)
+    flags += " avx2";
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+    flags += " asan";
+#endif
+#if defined(__SANITIZE_THREAD__)
+    flags += " tsan";
+#endif
+    return flags;
+#endif
+}
+
+inline std::string cpu()
+{
+    std::ifstream cpuinfo{"/proc/cpuinfo"};
+    std::string line;
+    while (std::getline(cpuinfo, line))
+    {
+        if (line.compare(0, 10, "model name") == 0 && line.find(':') != std::string::npos)
+        {
+            return trim(line.substr(line.find(':') + 1));
+        }
+    }
+    return "unknown";
+}
+
+/**
+ * @brief The commit the benchmarks were built from, with -dirty when the
+ * tree has changes. Build with -DBENCH_COMMIT="\"...\"" where git isn't
+ * around when the benchmarks run.
+ *
+ */
+inline std::string commit()
+{
+#if defined(BENCH_COMMIT)
+    return BENCH_COMMIT;
+#elif defined(__unix__) || defined(__APPLE__)
+    std::string hash;
+    if (FILE *git = popen("git describe --always --dirty 2>/dev/null", "r"))
+    {
+        char buffer[128];
+        while (std::fgets(buffer, sizeof buffer, git) != nullptr)
+        {
+            hash += buffer;
+        }
+        if (pclose(git) != 0)
+        {
+            hash.clear();
+        }
+    }
+    hash = trim(hash);
+    return hash.empty() ? "unknown" : hash;
+#else
+    return "unknown";
+#endif
+}
+
+inline Metadata describe()
+{
+    return Metadata{compiler(), flags(), cpu(), commit()};
+}
+
+inline std::string json_string(const std::string &s)
+{
+    std::ostringstream out;
+    out << '"';
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (c == '\n')
+            out << "\\n";
+        else if ((unsigned char)c < 0x20)
+            out << "\\u00" << "0123456789abcdef"[c >> 4] << "0123456789abcdef"[c & 15];
+        else
+            out << c;
+    }
+    out << '"';
+    return out.str();
+}
+
+inline void write_json(const std::string &path, const Run &run)
+{
+    std::ofstream ofs{path};
+    if (!ofs)
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+    ofs << std::setprecision(12);
+    const Metadata &m = run.metadata;
+    ofs << "{\n  \"metadata\": {\"compiler\": " << json_string(m.compiler) << ", \"flags\": " << json_string(m.flags)
+        << ", \"cpu\": " << json_string(m.cpu) << ", \"commit\": " << json_string(m.commit) << "},\n";
+    ofs << "  \"results\": [";
+    for (std::size_t i = 0; i < run.records.size(); i++)
+    {
+        const Record &r = run.records[i];
+        const harness::Stats &s = r.stats;
+        ofs << (i == 0 ? "\n" : ",\n");
+        ofs << "    {\"container\": " << json_string(r.container) << ", \"operation\": " << json_string(r.operation)
+            << ", \"n\": " << r.n << ", \"unit\": " << json_string(r.unit)
+            << ", \"better\": " << (r.better == lower ? "\"lower\"" : "\"higher\"") << ", \"samples\": " << s.samples
+            << ", \"mean\": " << s.mean << ", \"median\": " << s.median << ", \"p90\": " << s.p90
+            << ", \"p99\": " << s.p99 << ", \"min\": " << s.min << ", \"max\": " << s.max
+            << ", \"ci_low\": " << s.ci_low << ", \"ci_high\": " << s.ci_high;
+        if (s.counters.any())
+        {
+            ofs << ", \"counters\": {";
+            const char *separator = "";
+            if (s.counters.ipc() >= 0)
+            {
+                ofs << "\"ipc\": " << s.counters.ipc();
+                separator = ", ";
+            }
+            for (int event : {perf::l1d_misses, perf::llc_misses, perf::dtlb_misses, perf::branch_misses})
+            {
+                if (s.counters.available[event])
+                {
+                    ofs << separator << json_string(perf::event_name(event)) << ": "
+                        << s.counters.value[event];
+                    separator = ", ";
+                }
+            }
+            ofs << "}";
+        }
+        ofs << "}";
+    }
+    ofs << "\n  ]\n}\n";
+}
+
+inline std::string csv_field(const std::string &s)
+{
+    if (s.find_first_of(",\"\n") == std::string::npos)
+    {
+        return s;
+    }
+    std::string quoted = "\"";
+    for (char c : s)
+    {
+        if (c == '"')
+            quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+inline std::vector<std::string> split_csv(const std::string &line)
+{
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (std::size_t i = 0; i < line.size(); i++)
+    {
+        char c = line[i];
+        if (quoted && c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+        {
+            fields.back() += '"';
+            i++;
+        }
+        else if (c == '"')
+            quoted = !quoted;
+        else if (c == ',' && !quoted)
+            fields.emplace_back();
+        else if (c != '\r')
+            fields.back() += c;
+    }
+    return fields;
+}
+
+const char *const csv_columns[] = {"compiler", "flags", "cpu", "commit", "container", "operation",
+                                   "n", "unit", "better", "samples", "mean", "median",
+                                   "p90", "p99", "min", "max", "ci_low", "ci_high",
+                                   "ipc", "l1d-misses", "llc-misses", "dtlb-misses", "branch-misses"};
+
+/**
+ * @brief Write one line per record, with the metadata repeated on every line
+ * so that the file can be filtered and concatenated with others. The counter
+ * columns are per operation and left empty when a counter is missing.
+ *
+ */
+inline void write_csv(const std::string &path, const Run &run)
+{
+    std::ofstream ofs{path};
+    if (!ofs)
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+    const char *separator = "";
+    for (const char *column : csv_columns)
+    {
+        ofs << separator << column;
+        separator = ",";
+    }
+    ofs << "\n" << std::setprecision(12);
+    const Metadata &m = run.metadata;
+    for (const Record &r : run.records)
+    {
+        const harness::Stats &s = r.stats;
+        ofs << csv_field(m.compiler) << "," << csv_field(m.flags) << "," << csv_field(m.cpu) << ","
+            << csv_field(m.commit) << "," << csv_field(r.container) << "," << csv_field(r.operation) << "," << r.n
+            << "," << csv_field(r.unit) << "," << (r.better == lower ? "lower" : "higher") << "," << s.samples << ","
+            << s.mean << "," << s.median << "," << s.p90 << "," << s.p99 << "," << s.min << "," << s.max << ","
+            << s.ci_low << "," << s.ci_high << ",";
+        if (s.counters.ipc() >= 0)
+        {
+            ofs << s.counters.ipc();
+        }
+        for (int event : {perf::l1d_misses, perf::llc_misses, perf::dtlb_misses, perf::branch_misses})
+        {
+            ofs << ",";
+            if (s.counters.available[event])
+            {
+                ofs << s.counters.value[event];
+            }
+        }
+        ofs << "\n";
+    }
+}
+
+/**
+ * @brief Read a file written by write_csv. Columns are found by the names
+ * in the header, so files from older versions with fewer columns still load.
+ *
+ */
+inline Run read_csv(const std::string &path)
+{
+    std::ifstream ifs{path};
+    if (!ifs)
+    {
+        throw std::runtime_error("Unable to open baseline " + path);
+    }
+    std::string line;
+    std::getline(ifs, line);
+    std::vector<std::string> header = split_csv(line);
+
+    Run run;
+    while (std::getline(ifs, line))
+    {
+        if (trim(line).empty())
+        {
+            continue;
+        }
+        std::vector<std::string> fields = split_csv(line);
+        auto field = [&header, &fields](const char *name) -> std::string {
+            for (std::size_t i = 0; i < header.size() && i < fields.size(); i++)
+            {
+                if (header[i] == name)
+                {
+                    return fields[i];
+                }
+            }
+            return "";
+        };
+        auto number = [&field](const char *name) { return std::atof(field(name).c_str()); };
+
+        run.metadata = Metadata{field("compiler"), field("flags"), field("cpu"), field("commit")};
+        Record r;
+        r.container = field("container");
+        r.operation = field("operation");
+        r.n = std::atoll(field("n").c_str());
+        r.unit = field("unit");
+        r.better = field("better") == "higher" ? higher : lower;
+        r.stats.samples = (int)number("samples");
+        r.stats.mean = number("mean");
+        r.stats.median = number("median");
+        r.stats.p90 = number("p90");
+        r.stats.p99 = number("p99");
+        r.stats.min = number("min");
+        r.stats.max = number("max");
+        r.stats.ci_low = number("ci_low");
+        r.stats.ci_high = number("ci_high");
+        run.records.push_back(r);
+    }
+    return run;
+}
+
+/**
+ * @brief Compare the medians of a run with a baseline, matching records on
+ * container, operation, n and unit. Writes one line per record that is in
+ * both: container operation n unit baseline current change-% and a verdict,
+ * and the records that only one of the two has. A record with a single
+ * sample on either side has no confidence interval to tell a change from
+ * noise, so its change is shown but not counted.
+ *
+ * @param threshold_percent How much worse a median may get before it counts
+ * as a regression
+ * @return int The number of regressions among the sampled records
+ */
+inline int compare(const Run &baseline, const Run &current, double threshold_percent, std::ostream &out)
+{
+    auto same = [](const Record &a, const Record &b) {
+        return a.container == b.container && a.operation == b.operation && a.n == b.n && a.unit == b.unit;
+    };
+    const Metadata &b = baseline.metadata;
+    const Metadata &c = current.metadata;
+    out << "\nCompare with baseline " << b.commit << " (threshold " << threshold_percent << "%) \n";
+    if (b.compiler != c.compiler || b.flags != c.flags || b.cpu != c.cpu)
+    {
+        out << "note: the baseline was built or run differently\n"
+            << "  baseline: " << b.compiler << " | " << b.flags << " | " << b.cpu << "\n"
+            << "  current:  " << c.compiler << " | " << c.flags << " | " << c.cpu << "\n";
+    }
+
+    int regressions = 0;
+    int improvements = 0;
+    int uncounted = 0;
+    std::vector<bool> matched(baseline.records.size(), false);
+    for (const Record &r : current.records)
+    {
+        std::size_t i = 0;
+        while (i < baseline.records.size() && !same(baseline.records[i], r))
+        {
+            i++;
+        }
+        if (i == baseline.records.size())
+        {
+            out << "new: " << r.container << " " << r.operation << " " << r.n << " " << r.unit << "\n";
+            continue;
+        }
+        matched[i] = true;
+        const harness::Stats &base = baseline.records[i].stats;
+        double before = base.median;
+        double after = r.stats.median;
+        // A change from zero, like allocations appearing where there were
+        // none, counts as infinitely large
+        double change = before != 0 ? (after - before) / before * 100 : (after == 0 ? 0 : after > 0 ? 1E9 : -1E9);
+        double worse = r.better == lower ? change : -change;
+        // With samples on both sides, a change only counts when the
+        // confidence intervals of the medians don't overlap
+        bool sampled = base.samples > 1 && r.stats.samples > 1;
+        bool noise = sampled && r.stats.ci_low <= base.ci_high && base.ci_low <= r.stats.ci_high;
+
+        out << r.container << " " << r.operation << " " << r.n << " " << r.unit << " " << before << " " << after
+            << " " << std::showpos << std::fixed << std::setprecision(1) << change << "%" << std::defaultfloat
+            << std::noshowpos << std::setprecision(6);
+        if (std::abs(worse) > threshold_percent && !sampled)
+        {
+            out << " single sample, not counted";
+            uncounted++;
+        }
+        else if (std::abs(worse) > threshold_percent && noise)
+        {
+            out << " noise";
+        }
+        else if (worse > threshold_percent)
+        {
+            out << " REGRESSION";
+            regressions++;
+        }
+        else if (-worse > threshold_percent)
+        {
+            out << " improved";
+            improvements++;
+        }
+        out << "\n";
+    }
+    for (std::size_t i = 0; i < baseline.records.size(); i++)
+    {
+        if (!matched[i])
+        {
+            const Record &r = baseline.records[i];
+            out << "missing: " << r.container << " " << r.operation << " " << r.n << " " << r.unit << "\n";
+        }
+    }
+    out << regressions << " regressions and " << improvements << " improvements beyond " << threshold_percent
+        << "%";
+    if (uncounted > 0)
+    {
+        out << ", " << uncounted << " single-sample changes not counted";
+    }
+    out << "\n";
+    return regressions;
+}
+
+} // namespace results
+
+#if defined(BENCH_MEMORY)
+
+namespace memory {
+
+// Where account_benchmark wants the passes of account_pass written while it
+// runs a benchmark; null the rest of the time
+std::ostream *pass_output = nullptr;
+
+/**
+ * @brief Write one line of memory use to cout and a file and record it:
+ * container scenario n bytes-per-element peak-bytes-per-element
+ * allocations-per-operation bytes-requested-per-operation
+ *
+ * @param n The size the benchmark reports the scenario under
+ * @param elements Elements the bytes are spread over; taken as 1 when there
+ * are none, so that an empty list shows its bytes as they are
+ * @param operations Operations the allocations are spread over
+ */
+inline void write(std::ostream &ofs, const std::string &name, const std::string &scenario, long long n,
+                  long long elements, const Snapshot &snapshot, double operations)
+{
+    double per_element = 1.0 / std::max(elements, 1LL);
+    std::ostringstream line;
+    line << name << " " << scenario << " " << n << " " << snapshot.live_bytes * per_element << " "
+         << snapshot.peak_live_bytes * per_element << " " << snapshot.allocations / operations << " "
+         << snapshot.bytes_requested / operations << "\n";
+    std::cout << line.str();
+    ofs << line.str();
+    results::add(name, scenario, n, snapshot.live_bytes * per_element, "bytes/element");
+    results::add(name, scenario, n, snapshot.peak_live_bytes * per_element, "peak_bytes/element");
+    results::add(name, scenario, n, snapshot.allocations / operations, "allocations/op");
+    results::add(name, scenario, n, snapshot.bytes_requested / operations, "bytes_requested/op");
+}
+
+} // namespace memory
+
+/**
+ * @brief While account_benchmark runs a benchmark, run one more, untimed pass
+ * of a workload in a memory::Scope and write what it allocated. Counting the
+ * timed samples instead would give totals that depend on how many samples
+ * the harness took. setup runs before the scope opens, like the setup of
+ * harness::measure. The bytes are the ones the pass leaves alive.
+ *
+ */
+template <typename Setup, typename Work>
+void account_pass(const std::string &name, const std::string &scenario, long long n, long long elements,
+                  double operations, Setup setup, Work work)
+{
+    if (memory::pass_output == nullptr)
+    {
+        return;
+    }
+    setup();
+    memory::Scope scope;
+    work();
+    memory::write(*memory::pass_output, name, scenario, n, elements, scope.read(), operations);
+}
+
+template <typename Work>
+void account_pass(const std::string &name, const std::string &scenario, long long n, long long elements,
+                  double operations, Work work)
+{
+    account_pass(name, scenario, n, elements, operations, [] {}, work);
+}
+
+#else
+
+template <typename Setup, typename Work>
+void account_pass(const std::string &, const std::string &, long long, long long, double, Setup, Work)
+{
+}
+
+template <typename Work>
+void account_pass(const std::string &, const std::string &, long long, long long, double, Work)
+{
+}
+
+#endif // BENCH_MEMORY
+
+// Number of buffers handed out by CountingAllocator
+long long counted_allocations = 0;
+
+/**
+ * @brief Allocator that counts how many buffers a container asks for.
+ *
+ */
+template <typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U> &)
+    {
+    }
+
+    T *allocate(std::size_t n)
+    {
+        counted_allocations++;
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, std::size_t)
+    {
+        ::operator delete(p);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const CountingAllocator<T> &, const CountingAllocator<U> &)
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const CountingAllocator<T> &, const CountingAllocator<U> &)
+{
+    return false;
+}
+
+void run_array_list_get()
+{
+    std::cout << "\nArray list - get (ns: median p90 p99 ci) \n";
+    std::ofstream ofs{"array_list_get.txt"};
+    if (!ofs)
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+    // Number of reads per sample
+    int runs = 1000;
+    for (int N = 100; N < 1E6; N *= 10)
+    {
+        ArrayList ll{};
+        for (int i = 0; i < N; i++)
+        {
+            ll.append(i);
+        }
+        // Get value in the middle
+        harness::Stats stats = harness::measure(
+            [&] {
+                for (int run = 0; run < runs; run++)
+                {
+                    harness::do_not_optimize(ll[N / 2]);
+                }
+            },
+            runs);
+        harness::report(ofs, N, stats);
+        results::add("array_list", "get", N, stats);
+    }
+}
+void run_array_list_insert_front()
+{
+    std::cout << "Array list - insert front (ns: median p90 p99 ci) \n";
+    std::ofstream ofs{"array_list_insert.txt"};
+    if (!ofs)
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+    for (int N = 100; N < 1E6; N *= 10)
+    {
+        harness::Stats stats = harness::measure(
+            [N] {
+                ArrayList a{};
+                for (int i = 0; i < N; i++)
+                {
+                    a.insert(i, 0);
+                }
+                harness::do_not_optimize(a[0]);
+            },
+            N);
+        harness::report(ofs, N, stats);
+        results::add("array_list", "insert_front", N, stats);
+    }
+
+    // Same workload with the ring buffer storage
+    std::cout << "Circular array list - insert front (ns: median p90 p99 ci) \n";
+    std::ofstream circular_ofs{"circular_array_list_insert.txt"};
+    if (!circular_ofs)
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+    for (int N = 100; N < 1E6; N *= 10)
+    {
+        harness::Stats stats = harness::measure(
+            [N] {
+                CircularArrayList a{};
+                for (int i = 0; i < N; i++)
+                {
+                    a.insert(i, 0);
+                }
+                harness::do_not_optimize(a[0]);
+            },
+            N);
+        harness::report(circular_ofs, N, stats);
+        results::add("circular_array_list", "insert_front", N, stats);
+    }
+}
+/**
+ * @brief Editor-like workload on a list that starts with N elements: type
+ * runs of values at a cursor that starts in the middle, delete behind it now
+ * and then, and move it a few steps every so often. Every sample starts
+ * from a freshly filled list.
+ *
+ * @return harness::Stats The time per edit in nanoseconds
+ */
+template <typename List>
+harness::Stats time_cursor_walk(const char *name, int N)
+{
+    int edits = 10000;
+    std::unique_ptr<List> list;
+    auto fill = [&] {
+        list.reset(new List{});
+        for (int i = 0; i < N; i++)
+        {
+            list->append(i);
+        }
+    };
+    auto walk = [&] {
+        int cursor = N / 2;
+        for (int i = 0; i < edits; i++)
+        {
+            if (i % 16 == 15)
+            {
+                cursor = std::max(0, std::min(list->length(), cursor + (i % 32) - 16));
+            }
+            else if (i % 4 == 3 && cursor > 0)
+            {
+                list->remove(--cursor);
+            }
+            else
+            {
+                list->insert(i, cursor++);
             }
         }
+        harness::do_not_optimize(list->length());
+    };
+    harness::Stats stats = harness::measure(fill, walk, edits);
+    account_pass(name, "cursor_walk", N, N, edits, [&] {
+        fill();
+        walk();
+    });
+    return stats;
+}
 
-        return count;
+void run_gap_buffer_cursor_walk()
+{
+    std::cout << "Array list / gap buffer - cursor walk (us per edit, median) \n";
+    std::ofstream ofs{"gap_buffer_cursor_walk.txt"};
+    if (!ofs)
+    {
+        throw std::runtime_error("Unable to open file");
     }
-};
-
+    for (int N = 100; N < 1E6; N *= 10)
+    {
+        harness::Stats array_list = time_cursor_walk<ArrayList<>>("array_list", N);
+        harness::Stats gap_buffer = time_cursor_walk<GapBuffer<>>("gap_buffer", N);
 
-#include <iostream>
-#include <stdexcept>
-#include <vector>
+        std::cout << N << " " << array_list.median / 1000 << " " << gap_buffer.median / 1000 << "\n";
+        ofs << N << " " << array_list.median / 1000 << " " << gap_buffer.median / 1000 << "\n";
+        results::add("array_list", "cursor_walk", N, array_list);
+        results::add("gap_buffer", "cursor_walk", N, gap_buffer);
+    }
+}
 
-struct Node
+/**
+ * @brief Create and destroy batches of a hundred thousand short-lived lists
+ * of a given length.
+ *
+ * @param allocations Set to the heap allocations per list
+ * @return harness::Stats The time per list in nanoseconds
+ */
+template <typename List>
+harness::Stats time_small_lists(const char *name, int elements, double &allocations)
 {
-    // The value at the node
-    int value;
-    // Pointer to the previous node; here default value nullpointer
-    Node *prev = nullptr; 
-    // Pointer to the next node; here default value nullpointer
-    Node *next = nullptr; 
-};
+    int lists = 100000;
+    long long batches = 0;
+    counted_allocations = 0;
+    auto batch = [&] {
+        for (int l = 0; l < lists; l++)
+        {
+            List list{};
+            for (int i = 0; i < elements; i++)
+            {
+                list.append(i);
+            }
+            harness::do_not_optimize(list.length());
+        }
+        batches++;
+    };
 
-class LinkedList
-{
-  private:
-    // Pointer to the first and last element in the list
-    Node *head = nullptr;
-    Node *tail = nullptr;
-    // Size of the list
-    int _size = 0;
+    harness::Stats stats = harness::measure(batch, lists);
+    allocations = counted_allocations / ((double)lists * batches);
+    account_pass(name, "small_list", elements, elements, lists, batch);
+    return stats;
+}
 
-    /**
-     * @brief Check wheter the given index if out of
-     * bound and throw a range error if it is
-     *
-     * @param index The index to be checked
-     */
-    void check_index_out_of_bounds(int index)
+void run_array_list_small_lists()
+{
+    std::cout << "\nArray list - small lists (elements, ns and allocations per list: heap, 8 inline) \n";
+    std::ofstream ofs{"array_list_small.txt"};
+    if (!ofs)
     {
-        if ((index < 0) || (index >= length()))
-            throw std::range_error("Index out of bounds");
+        throw std::runtime_error("Unable to open file");
     }
-
-    /**
-     * @brief Find the node at the given index
-     *
-     * @param index The index where you want the node
-     * @return Node* A pointer to the node at the index
-     */
-    Node *find_node_at_index(int index)
+    for (int elements : {0, 1, 4, 8, 16})
     {
-        Node *current = head;
-        for (int i = 0; i < index; i++)
-            current = current->next;
-        return current;
+        double heap_allocations;
+        double inline_allocations;
+        harness::Stats heap =
+            time_small_lists<ArrayList<int, CountingAllocator<int>>>("array_list", elements, heap_allocations);
+        harness::Stats in_place = time_small_lists<ArrayList<int, CountingAllocator<int>, 8>>(
+            "array_list_inline8", elements, inline_allocations);
+
+        std::cout << elements << " " << heap.median << " " << heap_allocations << " " << in_place.median << " "
+                  << inline_allocations << "\n";
+        ofs << elements << " " << heap.median << " " << heap_allocations << " " << in_place.median << " "
+            << inline_allocations << "\n";
+        results::add("array_list", "small_list", elements, heap, "ns/list");
+        results::add("array_list_inline8", "small_list", elements, in_place, "ns/list");
     }
+}
 
-  public:
-    // Default constructor
-    LinkedList()
+/**
+ * @brief Fill a list up to N and let it swing between N / 8 and N / 2 elements
+ * with a few growth policies. Every reallocation copies the whole buffer, so the
+ * number of capacity changes is written next to the time per operation. The
+ * swing is the same every time, so the counts come from one untimed run.
+ *
+ */
+void run_array_list_growth_thrash()
+{
+    std::cout << "\nArray list - grow/shrink thrash \n";
+    std::ofstream ofs{"array_list_thrash.txt"};
+    if (!ofs)
     {
+        throw std::runtime_error("Unable to open file");
     }
-
-    // Constructor for a list of values
-    LinkedList(std::vector<int> values)
+    const char *names[] = {"doubling", "hysteresis", "no_shrink"};
+    GrowthPolicy policies[] = {GrowthPolicy::doubling(), GrowthPolicy::hysteresis(), GrowthPolicy::no_shrink()};
+    int rounds = 20;
+    for (int N = 100; N < 1E6; N *= 10)
     {
-        for (int v : values)
-            append(v);
+        for (int p = 0; p < 3; p++)
+        {
+            std::unique_ptr<ArrayList<>> a;
+            auto fill = [&] {
+                a.reset(new ArrayList<>{policies[p]});
+                for (int i = 0; i < N; i++)
+                {
+                    a->append(i);
+                }
+            };
+            int operations = 0;
+            int reallocations = 0;
+            auto swing = [&] {
+                int capacity = a->capacity();
+                for (int round = 0; round < rounds; round++)
+                {
+                    while (a->length() > N / 8)
+                    {
+                        a->pop();
+                        operations++;
+                        reallocations += a->capacity() != capacity;
+                        capacity = a->capacity();
+                    }
+                    while (a->length() < N / 2)
+                    {
+                        a->append(round);
+                        operations++;
+                        reallocations += a->capacity() != capacity;
+                        capacity = a->capacity();
+                    }
+                }
+                harness::do_not_optimize(a->length());
+            };
+            fill();
+            swing();
+            int swing_operations = operations;
+            int swing_reallocations = reallocations;
+
+            harness::Stats stats = harness::measure(fill, swing, swing_operations);
+            account_pass(std::string("array_list_") + names[p], "grow_shrink_thrash", N, N / 2, swing_operations, [&] {
+                fill();
+                swing();
+            });
+            std::cout << N << " " << names[p] << " " << stats.median << " " << swing_reallocations << "\n";
+            ofs << N << " " << names[p] << " " << stats.median << " " << swing_reallocations << "\n";
+            results::add(std::string("array_list_") + names[p], "grow_shrink_thrash", N, stats);
+        }
     }
+}
 
-~LinkedList()
+/**
+ * @brief Throughput of the min, max, argmin, argmax and count kernels for
+ * every instruction set this CPU supports, in million elements per second.
+ * The file gets the median throughput; the results get the time per element.
+ *
+ */
+void run_array_list_simd_scan()
 {
-    Node *current = head;
-    while (current != nullptr)
+    std::cout << "\nArray list - simd scan (Melem/s: min max argmin argmax count) \n";
+    std::ofstream ofs{"array_list_simd.txt"};
+    if (!ofs)
     {
-        Node *next = current->next;
-        delete current;
-        current = next;
+        throw std::runtime_error("Unable to open file");
     }
-}
+    for (int N = 1000; N < 1E8; N *= 100)
+    {
+        std::vector<int> values(N);
+        for (int i = 0; i < N; i++)
+        {
+            values[i] = i * 7919LL % 100003;
+        }
+        const int *data = values.data();
+        // Scan about 10^6 elements per sample
+        int runs = std::max(1, (int)(1E6 / N));
 
+        for (simd::Isa isa : {simd::Isa::scalar, simd::Isa::sse41, simd::Isa::avx2, simd::Isa::avx512})
+        {
+            if (!simd::supported(isa))
+            {
+                continue;
+            }
+            simd::Kernels k = simd::kernels_for(isa);
+            auto time_per_element = [&](auto kernel) {
+                return harness::measure(
+                    [&] {
+                        for (int run = 0; run < runs; run++)
+                        {
+                            harness::do_not_optimize(kernel());
+                        }
+                    },
+                    (long long)N * runs);
+            };
+            harness::Stats min = time_per_element([&] { return k.min(data, N); });
+            harness::Stats max = time_per_element([&] { return k.max(data, N); });
+            harness::Stats argmin = time_per_element([&] { return k.argmin(data, N); });
+            harness::Stats argmax = time_per_element([&] { return k.argmax(data, N); });
+            harness::Stats count = time_per_element([&] { return k.count(data, N, 42); });
 
-    /**
-     * @brief Return the length of the list
-     *
-     * @return int The length
-     */
-    int length()
-    {
-        return _size;
+            std::cout << N << " " << simd::isa_name(isa) << " " << 1000 / min.median << " " << 1000 / max.median << " "
+                      << 1000 / argmin.median << " " << 1000 / argmax.median << " " << 1000 / count.median << "\n";
+            ofs << N << " " << simd::isa_name(isa) << " " << 1000 / min.median << " " << 1000 / max.median << " "
+                << 1000 / argmin.median << " " << 1000 / argmax.median << " " << 1000 / count.median << "\n";
+            std::string kernels = std::string("simd_") + simd::isa_name(isa);
+            results::add(kernels, "min", N, min, "ns/element");
+            results::add(kernels, "max", N, max, "ns/element");
+            results::add(kernels, "argmin", N, argmin, "ns/element");
+            results::add(kernels, "argmax", N, argmax, "ns/element");
+            results::add(kernels, "count", N, count, "ns/element");
+        }
     }
+}
 
-    /**
-     * @brief Append element to the end of the list
-     *
-     * @param val The value to be appended
-     */
-void append(int val)
+/**
+ * @brief Time count, min and argmax on a 10^8 element list with 1, 2, 4 ...
+ * threads, up to the number of hardware threads. Hardware counters only see
+ * the calling thread, so they are left out of this one.
+ *
+ */
+void run_array_list_parallel_scan()
 {
-    _size++;
-    Node *newNode = new Node{val, tail, nullptr};
-    if (head == nullptr)
+    std::cout << "\nArray list - parallel scan (ms: count min argmax) \n";
+    std::ofstream ofs{"array_list_parallel.txt"};
+    if (!ofs)
     {
-        // Hvis listen er tom, setter både hodet og halen til den nye noden.
-        head = newNode;
-        tail = newNode;
+        throw std::runtime_error("Unable to open file");
     }
-    else
+    int N = 1E8;
+    ArrayList a{};
+    for (int i = 0; i < N; i++)
     {
-        // Hvis listen ikke er tom, legger den nye noden til som "neste" for halen og oppdaterer halen til den nye noden.
-        tail->next = newNode;
-        tail = newNode;
+        a.append(i * 7919LL % 100003);
     }
-}
+    int max_threads = std::max(1u, std::thread::hardware_concurrency());
 
-
-    /**
-     * @brief Print values in the list
-     *
-     */
-void print()
-{
-    std::cout << "[";
-    Node *current = head;
-    while (current != nullptr)
+    for (int threads = 1;; threads = std::min(threads * 2, max_threads))
     {
-        std::cout << current->value;
-        if (current->next != nullptr)
+        ThreadPool pool(threads);
+        ParallelPolicy policy;
+        policy.pool = &pool;
+        auto time_per_scan = [&](auto scan) {
+            harness::Stats stats = harness::measure([&] { harness::do_not_optimize(scan()); });
+            stats.counters = perf::Reading{};
+            return stats;
+        };
+        harness::Stats count = time_per_scan([&] { return a.count(42, policy); });
+        harness::Stats min = time_per_scan([&] { return a.min(policy); });
+        harness::Stats argmax = time_per_scan([&] { return a.argmax(policy); });
+
+        std::cout << threads << " " << count.median / 1E6 << " " << min.median / 1E6 << " " << argmax.median / 1E6 << "\n";
+        ofs << threads << " " << count.median / 1E6 << " " << min.median / 1E6 << " " << argmax.median / 1E6 << "\n";
+        results::add("array_list", "parallel_count", threads, count, "ns/scan");
+        results::add("array_list", "parallel_min", threads, min, "ns/scan");
+        results::add("array_list", "parallel_argmax", threads, argmax, "ns/scan");
+        if (threads == max_threads)
         {
-            std::cout << ", ";
+            break;
         }
-        current = current->next;
     }
-    std::cout << "]\n";
 }
 
-    /**
-     * @brief Get value at a given index
-     *
-     * @param index The index
-     * @return int& Reference to the value at that index
-     */
-    int &operator[](int index)
+/**
+ * @brief Throughput of the lock-free sorted list with 1, 2, 4, ... threads,
+ * up to the number of hardware threads and at least 4, each doing a mix of
+ * 10% inserts, 10% removes and 80% lookups on a set of up to 4096 values.
+ * Writes: threads million-operations-per-second.
+ *
+ */
+void run_lock_free_list_throughput()
+{
+    std::cout << "\nLock-free sorted list - throughput (Mops/s) \n";
+    std::ofstream ofs{"lock_free_list.txt"};
+    if (!ofs)
     {
-        check_index_out_of_bounds(index);
-        Node *current = find_node_at_index(index);
-        return current->value;
+        throw std::runtime_error("Unable to open file");
     }
+    int range = 4096;
+    int operations = 50000;
+    int max_threads = std::max(4u, std::thread::hardware_concurrency());
 
-    /**
-     * @brief Add element to the beginning of the list
-     *
-     * @param val The value to be added
-     */
-void push_front(int val)
-{
-    Node *newNode = new Node{val, nullptr, head};
-    if (head != nullptr) {
-        head->prev = newNode;
+    for (int threads = 1;; threads = std::min(threads * 2, max_threads))
+    {
+        std::unique_ptr<LockFreeSortedList> set;
+        auto fill = [&] {
+            set.reset(new LockFreeSortedList{});
+            for (int i = 0; i < range; i += 2)
+            {
+                set->insert(i);
+            }
+        };
+        auto mix = [&] {
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++)
+            {
+                workers.emplace_back([&set, t, range, operations] {
+                    unsigned seed = t + 1;
+                    for (int i = 0; i < operations; i++)
+                    {
+                        seed = seed * 1103515245 + 12345;
+                        int value = (seed >> 8) % range;
+                        int kind = (seed >> 20) % 10;
+                        if (kind == 0)
+                            set->insert(value);
+                        else if (kind == 1)
+                            set->remove(value);
+                        else
+                            set->contains(value);
+                    }
+                });
+            }
+            for (std::thread &worker : workers)
+            {
+                worker.join();
+            }
+        };
+        harness::Stats stats = harness::measure(fill, mix, (long long)threads * operations);
+        // The counters only see this thread, not the workers
+        stats.counters = perf::Reading{};
+        account_pass("lock_free_sorted_list", "mixed", threads, range / 2, (double)threads * operations, fill, mix);
+
+        std::cout << threads << " " << 1000 / stats.median << "\n";
+        ofs << threads << " " << 1000 / stats.median << "\n";
+        results::add("lock_free_sorted_list", "mixed", threads, stats);
+        if (threads == max_threads)
+        {
+            break;
+        }
     }
-    head = newNode;
+}
 
-    if (tail == nullptr) {
-        // Hvis listen er tom, oppdaterer vi også halen til å være den nye noden.
-        tail = newNode;
+/**
+ * @brief Throughput of a work queue with 1, 2, 4, ... threads, up to the
+ * number of hardware threads and at least 4, each doing enqueue/dequeue
+ * pairs, for a LinkedList behind a mutex and for the lock-free queue, and
+ * for the lock-free queue's single-thread mode.
+ * Writes: threads mutex-list lock-free (million operations per second),
+ * then single_thread and its throughput.
+ *
+ */
+void run_lock_free_queue_throughput()
+{
+    std::cout << "\nWork queue - throughput (Mops/s) \n";
+    std::ofstream ofs{"lock_free_queue.txt"};
+    if (!ofs)
+    {
+        throw std::runtime_error("Unable to open file");
     }
+    int operations = 200000;
+    int max_threads = std::max(4u, std::thread::hardware_concurrency());
 
-    _size++;
-}
+    auto time_per_operation = [operations](const char *name, int threads, auto work) {
+        auto run_workers = [&] {
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++)
+            {
+                workers.emplace_back(work);
+            }
+            for (std::thread &worker : workers)
+            {
+                worker.join();
+            }
+        };
+        harness::Stats stats = harness::measure(run_workers, 2LL * threads * operations);
+        // The counters only see this thread, not the workers
+        stats.counters = perf::Reading{};
+        // The queue holds at most one value per thread
+        account_pass(name, "enqueue_dequeue", threads, threads, 2.0 * threads * operations, run_workers);
+        return stats;
+    };
 
+    for (int threads = 1;; threads = std::min(threads * 2, max_threads))
+    {
+        std::mutex mutex;
+        LinkedList list{};
+        harness::Stats locked = time_per_operation("locked_linked_list", threads, [&mutex, &list, operations] {
+            for (int i = 0; i < operations; i++)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    list.append(i);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                if (list.length() > 0)
+                    list.pop(0);
+            }
+        });
 
+        LockFreeQueue queue{};
+        harness::Stats lock_free = time_per_operation("lock_free_queue", threads, [&queue, operations] {
+            int value;
+            for (int i = 0; i < operations; i++)
+            {
+                queue.enqueue(i);
+                queue.dequeue(value);
+            }
+        });
 
-    /***
-     * @brief Add element to index chosen
-     * 
-     * @param val The value to be added
-     * @param index The index
-    */
-void insert(int val, int index)
+        std::cout << threads << " " << 1000 / locked.median << " " << 1000 / lock_free.median << "\n";
+        ofs << threads << " " << 1000 / locked.median << " " << 1000 / lock_free.median << "\n";
+        results::add("locked_linked_list", "enqueue_dequeue", threads, locked);
+        results::add("lock_free_queue", "enqueue_dequeue", threads, lock_free);
+        if (threads == max_threads)
+        {
+            break;
+        }
+    }
+
+    LockFreeQueue queue{LockFreeQueue::single_thread};
+    harness::Stats single = time_per_operation("lock_free_queue_single_thread", 1, [&queue, operations] {
+        int value;
+        for (int i = 0; i < operations; i++)
+        {
+            queue.enqueue(i);
+            queue.dequeue(value);
+        }
+    });
+    std::cout << "single_thread " << 1000 / single.median << "\n";
+    ofs << "single_thread " << 1000 / single.median << "\n";
+    results::add("lock_free_queue_single_thread", "enqueue_dequeue", 1, single);
+}
+
+void run_linked_list_get()
 {
-    if (index <= 0)
+    std::cout << "\nLinked list - get (ns: median p90 p99 ci) \n";
+    std::ofstream ofs{"linked_list_get.txt"};
+    if (!ofs)
     {
-        push_front(val);
-        return;
+        throw std::runtime_error("Unable to open file");
     }
+    // Number of reads per sample
+    int runs = 1000;
+    for (int N = 100; N < 1E6; N *= 10)
+    {
+        LinkedList ll{};
+        for (int i = 0; i < N; i++)
+        {
+            ll.append(i);
+        }
+        // Get value in the middle
+        harness::Stats stats = harness::measure(
+            [&] {
+                for (int run = 0; run < runs; run++)
+                {
+                    harness::do_not_optimize(ll[N / 2]);
+                }
+            },
+            runs);
+        harness::report(ofs, N, stats);
+        results::add("linked_list", "get", N, stats);
+    }
+}
+/**
+ * @brief Time reading every element of a linked list by index, first in
+ * order and then backwards with a small step forward after each read.
+ * Writes: N sequential near-sequential (ns per access).
+ *
+ */
+void run_linked_list_index_scan()
+{
+    std::cout << "\nLinked list - scan by index (ns) \n";
+    std::ofstream ofs{"linked_list_index_scan.txt"};
+    if (!ofs)
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+    for (int N = 100; N < 1E7; N *= 10)
+    {
+        LinkedList ll{};
+        for (int i = 0; i < N; i++)
+        {
+            ll.append(i);
+        }
 
-    if (index >= _size)
+        harness::Stats sequential = harness::measure(
+            [&] {
+                for (int i = 0; i < N; i++)
+                {
+                    harness::do_not_optimize(ll[i]);
+                }
+            },
+            N);
+
+        harness::Stats near_sequential = harness::measure(
+            [&] {
+                for (int i = N - 2; i >= 0; i--)
+                {
+                    harness::do_not_optimize(ll[i]);
+                    harness::do_not_optimize(ll[i + 1]);
+                }
+            },
+            2LL * N);
+
+        std::cout << N << " " << sequential.median << " " << near_sequential.median << "\n";
+        ofs << N << " " << sequential.median << " " << near_sequential.median << "\n";
+        results::add("linked_list", "index_scan", N, sequential);
+        results::add("linked_list", "index_scan_near_sequential", N, near_sequential);
+    }
+}
+
+/**
+ * @brief Time sorting a linked list of N random values by copying them out
+ * to a vector, sorting that and building a new list, against sorting the
+ * list in place, and merging two sorted lists of N / 2 values. The in-place
+ * sort and the merge get fresh lists for every sample.
+ * Writes: N copy-out in-place merge (ns per element).
+ *
+ */
+void run_linked_list_sort()
+{
+    std::cout << "\nLinked list - sort (ns) \n";
+    std::ofstream ofs{"linked_list_sort.txt"};
+    if (!ofs)
     {
-        append(val);
-        return;
+        throw std::runtime_error("Unable to open file");
     }
+    for (int N = 100; N < 1E7; N *= 10)
+    {
+        unsigned seed = 1;
+        std::vector<int> random(N);
+        for (int i = 0; i < N; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            random[i] = seed >> 8;
+        }
+        std::vector<int> sorted = random;
+        std::stable_sort(sorted.begin(), sorted.end());
 
-    // Finn den gjeldende noden ved den valgte indeksen
-    Node *current = find_node_at_index(index);
+        LinkedList copied{random};
+        auto copy_sort = [&] {
+            std::vector<int> values(copied.begin(), copied.end());
+            std::stable_sort(values.begin(), values.end());
+            LinkedList rebuilt{values};
+            harness::do_not_optimize(rebuilt.length());
+        };
+        harness::Stats copy_out = harness::measure(copy_sort, N);
+        account_pass("linked_list", "sort_copy_out", N, N, N, copy_sort);
 
-    // Opprett en ny node med de riktige pekerne
-    Node *newNode = new Node{val, current->prev, current};
+        std::unique_ptr<LinkedList> in_place;
+        auto unsorted = [&] { in_place.reset(new LinkedList{random}); };
+        auto sort_in_place = [&] {
+            in_place->sort();
+            harness::do_not_optimize(in_place->length());
+        };
+        harness::Stats sort = harness::measure(unsorted, sort_in_place, N);
+        account_pass("linked_list", "sort", N, N, N, unsorted, sort_in_place);
 
-    // Oppdater pekerne for de omkringliggende noder
-    current->prev->next = newNode;
-    current->prev = newNode;
+        std::unique_ptr<LinkedList> second;
+        auto halves = [&] {
+            in_place.reset(new LinkedList{sorted});
+            second.reset(new LinkedList{in_place->split_at(N / 2)});
+        };
+        auto merge_halves = [&] {
+            in_place->merge(*second);
+            harness::do_not_optimize(in_place->length());
+        };
+        harness::Stats merge = harness::measure(halves, merge_halves, N);
+        account_pass("linked_list", "merge", N, N, N, halves, merge_halves);
 
-    _size++;
+        std::cout << N << " " << copy_out.median << " " << sort.median << " " << merge.median << "\n";
+        ofs << N << " " << copy_out.median << " " << sort.median << " " << merge.median << "\n";
+        results::add("linked_list", "sort_copy_out", N, copy_out, "ns/element");
+        results::add("linked_list", "sort", N, sort, "ns/element");
+        results::add("linked_list", "merge", N, merge, "ns/element");
+    }
 }
 
-
-     /**
-     * @brief deletes the element at given index from the Linked list.
-     * 
-     * @param index The index.
-     *  
-    */
-void remove(int index)
+void run_linked_list_insert_front()
 {
-    if (index < 0 || index >= _size)
+    std::cout << "Linked list - insert front (ns: median p90 p99 ci) \n";
+    std::ofstream ofs{"linked_list_insert.txt"};
+    if (!ofs)
     {
-        throw std::out_of_range("Index out of bounds");
+        throw std::runtime_error("Unable to open file");
     }
-
-    // Finn den gjeldende noden ved den valgte indeksen
-    Node *current = find_node_at_index(index);
-
-    if (index == 0)
+    for (int N = 100; N < 1E6; N *= 10)
     {
-        // Hvis vi fjerner den første noden, oppdater hodet
-        head = current->next;
-        if (head != nullptr)
-        {
-            head->prev = nullptr;
-        }
-        else
-        {
-            // Hvis listen nå er tom, oppdater også halen
-            tail = nullptr;
-        }
+        harness::Stats stats = harness::measure(
+            [N] {
+                LinkedList a{};
+                for (int i = N - 1; i >= 0; i--)
+                {
+                    a.insert(i, 0);
+                }
+                harness::do_not_optimize(a[0]);
+            },
+            N);
+        harness::report(ofs, N, stats);
+        results::add("linked_list", "insert_front", N, stats);
+    }
+}
+/**
+ * @brief Time building a list of N elements with push_front and then
+ * emptying and refilling it, with one new/delete per node versus the node
+ * pool of LinkedList. Writes: N new/delete-time pool-time (median us per
+ * element) heap-allocations for new/delete and for the pool. The allocations
+ * are counted on one more, untimed run of each in builds with BENCH_MEMORY,
+ * and written as - otherwise.
+ *
+ */
+void run_linked_list_pool()
+{
+    std::cout << "Linked list - node allocation \n";
+    std::ofstream ofs{"linked_list_pool.txt"};
+    if (!ofs)
+    {
+        throw std::runtime_error("Unable to open file");
     }
-    else if (index == _size - 1)
+    for (int N = 100; N < 1E7; N *= 10)
     {
-        // Hvis vi fjerner den siste noden, oppdater halen
-        tail = current->prev;
-        if (tail != nullptr)
+        // One heap allocation per node, as the list used to do
+        auto new_delete = [&] {
+            Node *head = nullptr;
+            for (int round = 0; round < 2; round++)
+            {
+                for (int i = 0; i < N; i++)
+                {
+                    head = new Node{i, nullptr, head};
+                }
+                while (head != nullptr)
+                {
+                    Node *next = head->next;
+                    delete head;
+                    head = next;
+                }
+            }
+        };
+        auto pooled = [&] {
+            LinkedList a{};
+            for (int round = 0; round < 2; round++)
+            {
+                for (int i = 0; i < N; i++)
+                {
+                    a.push_front(i);
+                }
+                while (a.length() > 0)
+                {
+                    a.pop(0);
+                }
+            }
+        };
+        harness::Stats heap_time = harness::measure(new_delete, N);
+        harness::Stats pool_time = harness::measure(pooled, N);
+        // Two rounds of N pushes and N pops
+        account_pass("new_delete_nodes", "fill_and_empty", N, N, 4.0 * N, new_delete);
+        account_pass("linked_list", "fill_and_empty", N, N, 4.0 * N, pooled);
+
+        std::string heap_allocations = "-";
+        std::string pool_allocations = "-";
+#if defined(BENCH_MEMORY)
         {
-            tail->next = nullptr;
+            memory::Scope scope;
+            new_delete();
+            long long allocations = scope.read().allocations;
+            heap_allocations = std::to_string(allocations);
+            results::add("new_delete_nodes", "fill_and_empty", N, allocations, "allocations");
         }
-        else
         {
-            // Hvis listen nå er tom, oppdater også hodet
-            head = nullptr;
+            memory::Scope scope;
+            pooled();
+            long long allocations = scope.read().allocations;
+            pool_allocations = std::to_string(allocations);
+            results::add("linked_list", "fill_and_empty", N, allocations, "allocations");
         }
-    }
-    else
-    {
-        // Hvis vi fjerner en node i midten, oppdater pekerne for de omkringliggende nodene
-        current->prev->next = current->next;
-        current->next->prev = current->prev;
-    }
+#endif
 
-    // Slett den gjeldende noden
-    delete current;
-    _size--;
+        std::cout << N << " " << heap_time.median / 1000 << " " << pool_time.median / 1000 << " " << heap_allocations
+                  << " " << pool_allocations << "\n";
+        ofs << N << " " << heap_time.median / 1000 << " " << pool_time.median / 1000 << " " << heap_allocations << " "
+            << pool_allocations << "\n";
+        results::add("new_delete_nodes", "fill_and_empty", N, heap_time, "ns/element");
+        results::add("linked_list", "fill_and_empty", N, pool_time, "ns/element");
+    }
 }
 
-
-    /***
-     * @brief removing element at index given
-     * 
-     * @param index
-     * @return int the value at that index
-    */
-int pop(int index)
+/**
+ * @brief Time a full traversal (min and max) and reading the middle element
+ * of a list of N elements. Writes one line per container:
+ * N traversal-per-element get (ns).
+ *
+ */
+template <typename List>
+void time_traversal(List &list, int N, const char *name, std::ofstream &ofs)
 {
-    if (index < 0 || index >= _size)
+    int runs = 100;
+    // Traverse about 10^6 elements per sample
+    int traversals = std::max(1, (int)(1E6 / N));
+    for (int i = 0; i < N; i++)
     {
-        throw std::out_of_range("Index out of bounds");
+        list.append(i);
     }
 
-    Node *current = find_node_at_index(index);
-    int value = current->value;
-    remove(index);
-    return value;
+    harness::Stats traversal = harness::measure(
+        [&] {
+            for (int run = 0; run < traversals; run++)
+            {
+                harness::do_not_optimize(list.min() + list.max());
+            }
+        },
+        2LL * traversals * N);
+
+    harness::Stats get = harness::measure(
+        [&] {
+            for (int run = 0; run < runs; run++)
+            {
+                harness::do_not_optimize(list[N / 2]);
+            }
+        },
+        runs);
+
+    std::cout << name << " " << N << " " << traversal.median << " " << get.median << "\n";
+    ofs << name << " " << N << " " << traversal.median << " " << get.median << "\n";
+    results::add(name, "traversal.min_max", N, traversal, "ns/element");
+    results::add(name, "traversal.get_middle", N, get);
 }
 
-int pop()
+void run_unrolled_linked_list()
 {
-    if (_size == 0)
+    std::cout << "\nTraversal and get (ns) \n";
+    std::ofstream ofs{"unrolled_linked_list.txt"};
+    if (!ofs)
     {
-        throw std::out_of_range("List is empty");
+        throw std::runtime_error("Unable to open file");
+    }
+    for (int N = 100; N < 1E7; N *= 10)
+    {
+        LinkedList linked_list{};
+        time_traversal(linked_list, N, "linked_list", ofs);
+        UnrolledLinkedList unrolled{};
+        time_traversal(unrolled, N, "unrolled_linked_list", ofs);
+        CompactLinkedList compact{};
+        time_traversal(compact, N, "compact_linked_list", ofs);
     }
-
-    int value = tail->value;
-    remove(_size - 1);
-    return value;
 }
 
-
-    int min()
+/**
+ * @brief Time inserting into and removing from the middle of a list of N
+ * elements, and reading the middle element, for ArrayList, LinkedList,
+ * TieredVector and SkipList. Writes one line per container: N insert+remove get.
+ *
+ */
+template <typename List>
+void time_middle_edits(List &list, int N, const char *name, std::ofstream &ofs)
+{
+    int runs = 1000;
+    for (int i = 0; i < N; i++)
     {
-        if (_size == 0)
-        {
-            throw std::out_of_range("List is empty");
-        }
-
-        int minimum = head->value;
-        Node *current = head->next;
+        list.append(i);
+    }
 
-        while (current != nullptr)
-        {
-            if (current->value < minimum)
+    // Every insert is undone by a remove, so each sample sees the same list
+    harness::Stats edit = harness::measure(
+        [&] {
+            for (int run = 0; run < runs; run++)
             {
-                minimum = current->value;
+                list.insert(run, N / 2);
+                list.remove(N / 2);
             }
-            current = current->next;
-        }
-
-        return minimum;
-    }
-
-    int max()
-    {
-        if (_size == 0)
-        {
-            throw std::out_of_range("List is empty");
-        }
-
-        int maximum = head->value;
-        Node *current = head->next;
+        },
+        2 * runs);
 
-        while (current != nullptr)
-        {
-            if (current->value > maximum)
+    harness::Stats get = harness::measure(
+        [&] {
+            for (int run = 0; run < runs; run++)
             {
-                maximum = current->value;
+                harness::do_not_optimize(list[N / 2]);
             }
-            current = current->next;
-        }
+        },
+        runs);
 
-        return maximum;
-    }
+    std::cout << N << " " << name << " " << edit.median << " " << get.median << "\n";
+    ofs << N << " " << name << " " << edit.median << " " << get.median << "\n";
+    results::add(name, "middle_edit.insert_remove", N, edit);
+    results::add(name, "middle_edit.get_middle", N, get);
+}
 
-    // Test functions
-    void test_min()
+void run_tiered_vector_middle_edit()
+{
+    std::cout << "\nMiddle insert/remove and get (ns) \n";
+    std::ofstream ofs{"tiered_vector_middle.txt"};
+    if (!ofs)
     {
-        if (_size == 0)
-        {
-            throw std::out_of_range("List is empty");
-        }
-
-        int minValue = min();
-        std::cout << "The minimum value in the list is: " << minValue << " - Success!\n";
+        throw std::runtime_error("Unable to open file");
     }
-
-    void test_max()
+    for (int N = 100; N < 1E6; N *= 10)
     {
-        if (_size == 0)
-        {
-            throw std::out_of_range("List is empty");
-        }
-
-        int maxValue = max();
-        std::cout << "The maximum value in the list is: " << maxValue << " - Success!\n";
+        ArrayList array_list{};
+        time_middle_edits(array_list, N, "array_list", ofs);
+        LinkedList linked_list{};
+        time_middle_edits(linked_list, N, "linked_list", ofs);
+        TieredVector tiered_vector{};
+        time_middle_edits(tiered_vector, N, "tiered_vector", ofs);
+        SkipList skip_list{};
+        time_middle_edits(skip_list, N, "skip_list", ofs);
     }
+}
 
-};
+/**
+ * @brief Time inserting and removing at random positions, reading random
+ * positions, and min plus max, on a list of N elements. The reads run first,
+ * on a newly built list after one round of edits, and every edit sample
+ * starts from a newly built list, so every container is measured in the same
+ * state however many samples it takes. Writes one line per container:
+ * N insert+remove get min+max (ns).
+ *
+ */
+template <typename List>
+void time_random_edits(int N, const char *name, std::ofstream &ofs)
+{
+    int runs = 1000;
+    std::unique_ptr<List> owner;
+    unsigned seed = 1;
+    auto next_index = [&seed](int n) {
+        seed = seed * 1103515245 + 12345;
+        return (int)((seed >> 8) % n);
+    };
+    auto build = [&] {
+        owner.reset(new List{});
+        for (int i = 0; i < N; i++)
+        {
+            owner->append(i);
+        }
+        seed = 1;
+    };
+    auto random_edits = [&] {
+        for (int run = 0; run < runs; run++)
+        {
+            owner->insert(run, next_index(N));
+            owner->remove(next_index(N + 1));
+        }
+    };
 
+    build();
+    random_edits();
+    List &list = *owner;
 
-#include <chrono>    // for high_resolution_clock
-#include <fstream>   // for ofstream
-#include <iostream>  // for cout
-#include <stdexcept> // for runtime_error
+    harness::Stats get = harness::measure(
+        [&] {
+            for (int run = 0; run < runs; run++)
+            {
+                harness::do_not_optimize(list[next_index(N)]);
+            }
+        },
+        runs);
 
+    harness::Stats min_max = harness::measure(
+        [&] {
+            for (int run = 0; run < runs / 10; run++)
+            {
+                harness::do_not_optimize(list.min() + list.max());
+            }
+        },
+        runs / 10);
 
+    harness::Stats edit = harness::measure(build, random_edits, 2 * runs);
 
-using namespace std::chrono;
+    std::cout << N << " " << name << " " << edit.median << " " << get.median << " " << min_max.median << "\n";
+    ofs << N << " " << name << " " << edit.median << " " << get.median << " " << min_max.median << "\n";
+    results::add(name, "random_edit.insert_remove", N, edit);
+    results::add(name, "random_edit.get", N, get);
+    results::add(name, "random_edit.min_max", N, min_max);
+}
 
-void run_array_list_get()
+void run_counted_btree_random_access()
 {
-    std::cout << "\nArray list - get \n";
-    std::ofstream ofs{"array_list_get.txt"};
+    std::cout << "\nRandom insert/remove, get and min+max (ns) \n";
+    std::ofstream ofs{"counted_btree_random.txt"};
     if (!ofs)
     {
         throw std::runtime_error("Unable to open file");
     }
-    // Number of times we want to
-    int runs = 1000;
     for (int N = 100; N < 1E6; N *= 10)
     {
-
-        ArrayList ll{};
-for (int i = 0; i < N; i++) {
-    ll.append(i);
-}
-        auto start = high_resolution_clock::now();
-        // Get value in the middle. 
-for (int run = 0; run < runs; run++)
-{
-    auto middle_index = N / 2;
-    auto value = ll[middle_index];
-}
-        auto stop = high_resolution_clock::now();
-        auto duration = duration_cast<microseconds>(stop - start);
-        std::cout << N << " " << duration.count() / (double)runs << "\n";
-        ofs << N << " " << duration.count() / (double)runs << "\n";
+        time_random_edits<ArrayList<>>(N, "array_list", ofs);
+        time_random_edits<LinkedList>(N, "linked_list", ofs);
+        time_random_edits<SkipList>(N, "skip_list", ofs);
+        time_random_edits<CountedBTree>(N, "counted_btree", ofs);
     }
 }
 
-void run_array_list_insert_front()
+/**
+ * @brief Time replaying a decoded trace on an empty list. Writes one line per
+ * container: container operations ns-per-operation (median p90 p99 ci).
+ *
+ */
+template <typename List>
+void time_replay(const std::vector<OperationTrace::Operation> &operations, const std::string &trace_name,
+                 const char *name, bool &have_checksum, unsigned long long &checksum, std::ofstream &ofs)
 {
-    std::cout << "Array list - insert front \n";
-    std::ofstream ofs{"array_list_insert.txt"};
-    if (!ofs)
+    unsigned long long result = 0;
+    harness::Stats stats = harness::measure(
+        [&] {
+            List list{};
+            result = replay(operations, list);
+            harness::do_not_optimize(result);
+        },
+        operations.size());
+    std::cout << name << " ";
+    ofs << name << " ";
+    harness::report(ofs, operations.size(), stats);
+    results::add(name, "replay:" + trace_name, operations.size(), stats);
+
+    // Every container has to produce the same reads as the first one
+    if (!have_checksum)
     {
-        throw std::runtime_error("Unable to open file");
+        checksum = result;
+        have_checksum = true;
     }
-    for (int N = 100; N < 1E6; N *= 10)
+    else if (result != checksum)
     {
-        auto start = high_resolution_clock::now();
-        ArrayList a{};
-        for (int i = 0; i < N; i++)
-        {
-            a.insert(i, 0);
-        }
-
-        auto stop = high_resolution_clock::now();
-        auto duration = duration_cast<microseconds>(stop - start);
-        std::cout << N << " " << duration.count() / (double)N << "\n";
-        ofs << N << " " << duration.count() / (double)N << "\n";
+        std::cout << "warning: " << name << " replayed the trace with different results\n";
     }
 }
 
-void run_linked_list_get()
+/**
+ * @brief Replay a trace recorded with TraceRecorder against every container,
+ * to pick one by the traffic it really sees
+ *
+ * @param path The trace file
+ */
+void run_trace_replay(const std::string &path)
 {
-    std::cout << "\nLinked list - get \n";
-    std::ofstream ofs{"linked_list_get.txt"};
+    OperationTrace trace = OperationTrace::load(path);
+    std::vector<OperationTrace::Operation> operations = trace.decode();
+    std::string trace_name = path.substr(path.find_last_of('/') + 1);
+    std::cout << "\nReplay " << trace_name << ", " << trace.length() << " operations in " << trace.size_in_bytes()
+              << " bytes (container ns: median p90 p99 ci) \n";
+    std::ofstream ofs{"trace_replay.txt"};
     if (!ofs)
     {
         throw std::runtime_error("Unable to open file");
     }
-    // Number of times we want to
+    bool have_checksum = false;
+    unsigned long long checksum = 0;
+    time_replay<ArrayList<int>>(operations, trace_name, "array_list", have_checksum, checksum, ofs);
+    time_replay<CircularArrayList<int>>(operations, trace_name, "circular_array_list", have_checksum, checksum, ofs);
+    time_replay<TieredVector<int>>(operations, trace_name, "tiered_vector", have_checksum, checksum, ofs);
+    time_replay<GapBuffer<int>>(operations, trace_name, "gap_buffer", have_checksum, checksum, ofs);
+    time_replay<LinkedList>(operations, trace_name, "linked_list", have_checksum, checksum, ofs);
+    time_replay<UnrolledLinkedList>(operations, trace_name, "unrolled_linked_list", have_checksum, checksum, ofs);
+    time_replay<SkipList>(operations, trace_name, "skip_list", have_checksum, checksum, ofs);
+    time_replay<CountedBTree>(operations, trace_name, "counted_btree", have_checksum, checksum, ofs);
+    time_replay<CompactLinkedList>(operations, trace_name, "compact_linked_list", have_checksum, checksum, ofs);
+}
+
+struct Benchmark
+{
+    const char *name;
+    void (*run)();
+};
+
+// The timing benchmarks, in the order they run
+const Benchmark benchmarks[] = {
+    {"array_list_get", run_array_list_get},
+    {"array_list_insert_front", run_array_list_insert_front},
+    {"gap_buffer_cursor_walk", run_gap_buffer_cursor_walk},
+    {"array_list_growth_thrash", run_array_list_growth_thrash},
+    {"array_list_small_lists", run_array_list_small_lists},
+    {"array_list_simd_scan", run_array_list_simd_scan},
+    {"array_list_parallel_scan", run_array_list_parallel_scan},
+    {"linked_list_get", run_linked_list_get},
+    {"linked_list_insert_front", run_linked_list_insert_front},
+    {"linked_list_index_scan", run_linked_list_index_scan},
+    {"linked_list_sort", run_linked_list_sort},
+    {"linked_list_pool", run_linked_list_pool},
+    {"unrolled_linked_list", run_unrolled_linked_list},
+    {"tiered_vector_middle_edit", run_tiered_vector_middle_edit},
+    {"counted_btree_random_access", run_counted_btree_random_access},
+    {"lock_free_list_throughput", run_lock_free_list_throughput},
+    {"lock_free_queue_throughput", run_lock_free_queue_throughput},
+};
+
+void run_all()
+{
+    for (const Benchmark &benchmark : benchmarks)
+    {
+        benchmark.run();
+    }
+}
+
+#if defined(BENCH_MEMORY)
+
+/**
+ * @brief Memory use of one container in the common scenarios: building it
+ * with N appends, building it with N inserts at the front, reading the
+ * middle element and inserting plus removing in the middle. Writes one line
+ * per scenario and N: container scenario N bytes-per-element
+ * peak-bytes-per-element allocations-per-operation bytes-requested-per-operation.
+ *
+ */
+template <typename List>
+void account_container(const char *name, std::ofstream &ofs)
+{
     int runs = 1000;
+    auto write = [&](const char *scenario, int N, const memory::Snapshot &snapshot, double operations) {
+        memory::write(ofs, name, scenario, N, N, snapshot, operations);
+    };
+
     for (int N = 100; N < 1E6; N *= 10)
     {
+        {
+            memory::Scope scope;
+            List list{};
+            for (int i = 0; i < N; i++)
+            {
+                list.append(i);
+            }
+            write("append", N, scope.read(), N);
+        }
+        {
+            memory::Scope scope;
+            List list{};
+            for (int i = 0; i < N; i++)
+            {
+                list.insert(i, 0);
+            }
+            write("insert_front", N, scope.read(), N);
+        }
 
-        LinkedList ll{};
+        List list{};
         for (int i = 0; i < N; i++)
         {
-            ll.append(i);
+            list.append(i);
+        }
+        {
+            memory::Scope scope;
+            for (int run = 0; run < runs; run++)
+            {
+                harness::do_not_optimize(list[N / 2]);
+            }
+            memory::Snapshot snapshot = scope.read();
+            // Only the allocation count means something here
+            snapshot.live_bytes = snapshot.peak_live_bytes = 0;
+            write("get", N, snapshot, runs);
+        }
+        {
+            memory::Scope scope;
+            for (int run = 0; run < runs; run++)
+            {
+                list.insert(run, N / 2);
+                list.remove(N / 2);
+            }
+            memory::Snapshot snapshot = scope.read();
+            snapshot.live_bytes = snapshot.peak_live_bytes = 0;
+            write("middle_edit", N, snapshot, 2.0 * runs);
         }
-        auto start = high_resolution_clock::now();
-        // Get value in the middle
-for (int run = 0; run < runs; run++)
-{
-    auto middle_index = N / 2;
-    auto value = ll[middle_index];
-}
-
-        auto stop = high_resolution_clock::now();
-        auto duration = duration_cast<microseconds>(stop - start);
-        std::cout << N << " " << duration.count() / (double)runs << "\n";
-        ofs << N << " " << duration.count() / (double)runs << "\n";
     }
 }
 
-void run_linked_list_insert_front()
+void run_memory_footprint()
 {
-    std::cout << "Linked list - insert front \n";
-    std::ofstream ofs{"linked_list_insert.txt"};
+    std::cout << "\nMemory (container scenario N bytes/element peak-bytes/element allocations/op bytes-requested/op) \n";
+    std::ofstream ofs{"memory_footprint.txt"};
     if (!ofs)
     {
         throw std::runtime_error("Unable to open file");
     }
-    for (int N = 100; N < 1E6; N *= 10)
-    {
-        auto start = high_resolution_clock::now();
-        LinkedList a{};
-for (int i = N - 1; i >= 0; i--)
+    account_container<ArrayList<int>>("array_list", ofs);
+    account_container<CircularArrayList<int>>("circular_array_list", ofs);
+    account_container<TieredVector<int>>("tiered_vector", ofs);
+    account_container<GapBuffer<int>>("gap_buffer", ofs);
+    account_container<LinkedList>("linked_list", ofs);
+    account_container<UnrolledLinkedList>("unrolled_linked_list", ofs);
+    account_container<SkipList>("skip_list", ofs);
+    account_container<CountedBTree>("counted_btree", ofs);
+    account_container<CompactLinkedList>("compact_linked_list", ofs);
+}
+
+/**
+ * @brief Memory use of a timing benchmark. The workloads that
+ * account_container doesn't model (sorting and merging, the node pool, the
+ * cursor walk, small lists, growth thrash and the concurrent lists) write a
+ * line per scenario and N to passes, from an extra run through account_pass,
+ * in the format of run_memory_footprint. Then one line for the whole
+ * benchmark goes to ofs: benchmark allocations bytes-requested
+ * peak-live-bytes. The benchmark runs as usual and its time results are
+ * dropped, since the counting allocator slows it down.
+ *
+ */
+void account_benchmark(const Benchmark &benchmark, std::ofstream &ofs, std::ofstream &passes)
 {
-    a.insert(i, 0);
+    std::size_t recorded = results::recorded().size();
+    memory::Snapshot snapshot;
+    memory::pass_output = &passes;
+    {
+        memory::Scope scope;
+        benchmark.run();
+        snapshot = scope.read();
+    }
+    memory::pass_output = nullptr;
+    // The times are the sampled records, the passes are single values
+    std::vector<results::Record> &records = results::recorded();
+    records.erase(std::remove_if(records.begin() + recorded, records.end(),
+                                 [](const results::Record &r) { return r.stats.samples > 1; }),
+                  records.end());
+
+    std::cout << benchmark.name << " " << snapshot.allocations << " " << snapshot.bytes_requested << " "
+              << snapshot.peak_live_bytes << "\n";
+    ofs << benchmark.name << " " << snapshot.allocations << " " << snapshot.bytes_requested << " "
+        << snapshot.peak_live_bytes << "\n";
+    results::add(benchmark.name, "whole_benchmark", 0, snapshot.allocations, "allocations");
+    results::add(benchmark.name, "whole_benchmark", 0, snapshot.bytes_requested, "bytes_requested");
+    results::add(benchmark.name, "whole_benchmark", 0, snapshot.peak_live_bytes, "peak_live_bytes");
 }
 
-        auto stop = high_resolution_clock::now();
-        auto duration = duration_cast<microseconds>(stop - start);
-        std::cout << N << " " << duration.count() / (double)N << "\n";
-        ofs << N << " " << duration.count() / (double)N << "\n";
+void run_benchmark_allocations()
+{
+    std::ofstream ofs{"memory_benchmarks.txt"};
+    std::ofstream passes{"memory_benchmark_passes.txt"};
+    if (!ofs || !passes)
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+    for (const Benchmark &benchmark : benchmarks)
+    {
+        account_benchmark(benchmark, ofs, passes);
     }
 }
 
+#endif // BENCH_MEMORY
 
-int main()
+// Pass --memory to measure memory use instead of time (in a build with
+// -DBENCH_MEMORY), --replay with a trace file to time every container on the
+// recorded operations, and --compare with a results.csv from an earlier run
+// to flag medians that got worse by more than --threshold percent (10 by
+// default). The exit status is 1 when any sampled record did.
+int main(int argc, char *argv[])
 {
-    run_array_list_get();
-    run_array_list_insert_front();
-    run_linked_list_get();
-    run_linked_list_insert_front();
+    bool memory_mode = false;
+    std::string trace_path;
+    std::string baseline_path;
+    double threshold = 10;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--memory")
+            memory_mode = true;
+        else if (arg == "--replay" && i + 1 < argc)
+            trace_path = argv[++i];
+        else if (arg == "--compare" && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc)
+            threshold = std::atof(argv[++i]);
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--memory | --replay trace] [--compare baseline.csv] [--threshold percent]\n";
+            return 2;
+        }
+    }
+    // Read the baseline first, it may be the file this run writes
+    results::Run baseline;
+    if (!baseline_path.empty())
+    {
+        baseline = results::read_csv(baseline_path);
+    }
+
+    if (memory_mode)
+    {
+#if defined(BENCH_MEMORY)
+        run_memory_footprint();
+        std::cout << "\nMemory per benchmark (container scenario N bytes/element peak-bytes/element allocations/op "
+                     "bytes-requested/op for each pass, then benchmark allocations bytes-requested peak-live-bytes) \n";
+        run_benchmark_allocations();
+#else
+        std::cerr << "--memory needs a build with -DBENCH_MEMORY\n";
+        return 2;
+#endif
+    }
+    else if (!trace_path.empty())
+    {
+        run_trace_replay(trace_path);
+    }
+    else
+    {
+        run_all();
+    }
+
+    results::Run run{results::describe(), results::recorded()};
+    std::string name = memory_mode ? "memory_results" : !trace_path.empty() ? "replay_results" : "results";
+    results::write_json(name + ".json", run);
+    results::write_csv(name + ".csv", run);
+    if (!baseline_path.empty() && results::compare(baseline, run, threshold, std::cout) > 0)
+    {
+        return 1;
+    }
     return 0;
 }
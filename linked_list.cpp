@@ -1,5 +1,16 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <numeric>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 struct Node
@@ -12,6 +23,163 @@ struct Node
     Node *next = nullptr; 
 };
 
+/**
+ * @brief Slab allocator for nodes. Nodes are carved out of large chunks and
+ * removed nodes are recycled through a free list, so a list only goes to the
+ * heap once per chunk. All chunks are freed together when the pool dies.
+ * A pool can be shared between several lists.
+ *
+ */
+class NodePool
+{
+  private:
+    /**
+     * @brief Keeps chunks alive. A link owns one chunk or joins in everything
+     * another pool keeps alive, and points only to links that existed before
+     * it, so the links form a graph without cycles that pools share instead
+     * of copying. Adopting a pool is then one new link.
+     *
+     */
+    struct ChunkLink
+    {
+        std::unique_ptr<Node[]> chunk;
+        std::shared_ptr<ChunkLink> older;
+        std::shared_ptr<ChunkLink> adopted;
+
+        ~ChunkLink()
+        {
+            // Free links only this one holds in a loop, so a long history of
+            // chunks and adoptions doesn't recurse once per link
+            std::vector<std::shared_ptr<ChunkLink>> pending;
+            pending.push_back(std::move(older));
+            pending.push_back(std::move(adopted));
+            while (!pending.empty())
+            {
+                std::shared_ptr<ChunkLink> link = std::move(pending.back());
+                pending.pop_back();
+                if (link && link.use_count() == 1)
+                {
+                    pending.push_back(std::move(link->older));
+                    pending.push_back(std::move(link->adopted));
+                }
+            }
+        }
+    };
+
+    // The newest link; it owns the chunk new nodes come from, unless a pool
+    // was adopted since
+    std::shared_ptr<ChunkLink> chunks;
+    // The chunk new nodes come from, its size and how many of its nodes are
+    // handed out
+    Node *current = nullptr;
+    int chunk_size = 0;
+    int used = 0;
+    int own_chunks = 0;
+    // Released nodes, linked through their next pointer
+    Node *free_list = nullptr;
+    // Statistics
+    long long acquired = 0;
+    long long recycled = 0;
+
+    static constexpr int first_chunk_size = 64;
+    static constexpr int max_chunk_size = 1 << 16;
+
+    void add_chunk()
+    {
+        chunk_size = chunk_size == 0 ? first_chunk_size : std::min(chunk_size * 2, max_chunk_size);
+        std::shared_ptr<ChunkLink> link = std::make_shared<ChunkLink>();
+        link->chunk.reset(new Node[chunk_size]);
+        link->older = std::move(chunks);
+        chunks = std::move(link);
+        current = chunks->chunk.get();
+        own_chunks++;
+        used = 0;
+    }
+
+  public:
+    NodePool()
+    {
+    }
+
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    /**
+     * @brief Get a node from the pool
+     *
+     * @param val The value of the node
+     * @param prev The previous node
+     * @param next The next node
+     * @return Node* The node
+     */
+    Node *acquire(int val, Node *prev, Node *next)
+    {
+        acquired++;
+        Node *node;
+        if (free_list != nullptr)
+        {
+            node = free_list;
+            free_list = node->next;
+            recycled++;
+        }
+        else
+        {
+            if (used == chunk_size)
+                add_chunk();
+            node = &current[used++];
+        }
+        node->value = val;
+        node->prev = prev;
+        node->next = next;
+        return node;
+    }
+
+    /**
+     * @brief Give a node back to the pool so it can be reused
+     *
+     * @param node The node, which must come from this pool
+     */
+    void release(Node *node)
+    {
+        node->next = free_list;
+        free_list = node;
+    }
+
+    /**
+     * @brief Keep the chunks of another pool alive as long as this one, so
+     * that nodes taken over from a list using that pool stay valid. Takes
+     * O(1), whatever the number of chunks.
+     *
+     * @param other The other pool
+     */
+    void adopt(const NodePool &other)
+    {
+        if (!other.chunks || other.chunks == chunks || (chunks && chunks->adopted == other.chunks))
+            return;
+        std::shared_ptr<ChunkLink> link = std::make_shared<ChunkLink>();
+        link->older = std::move(chunks);
+        link->adopted = other.chunks;
+        chunks = std::move(link);
+    }
+
+    // Number of chunks this pool carved nodes from, not counting adopted ones
+    int chunk_count()
+    {
+        return own_chunks;
+    }
+
+    // Number of nodes handed out, and how many of those were recycled
+    long long acquire_count()
+    {
+        return acquired;
+    }
+
+    long long recycle_count()
+    {
+        return recycled;
+    }
+};
+
 class LinkedList
 {
   private:
@@ -20,6 +188,103 @@ class LinkedList
     Node *tail = nullptr;
     // Size of the list
     int _size = 0;
+    // Where the nodes come from, created on the first insertion
+    std::shared_ptr<NodePool> _pool;
+    // The last node looked up by index, so that nearby lookups can start
+    // there instead of at the head; null when there is none
+    Node *finger = nullptr;
+    int finger_index = 0;
+
+    // Give the nodes up. A pool of our own is freed in bulk when it dies;
+    // a shared one gets the nodes back.
+    void release_nodes()
+    {
+        if (_pool.use_count() > 1)
+        {
+            Node *current = head;
+            while (current != nullptr)
+            {
+                Node *next = current->next;
+                _pool->release(current);
+                current = next;
+            }
+        }
+        _pool.reset();
+        head = tail = finger = nullptr;
+        _size = 0;
+    }
+
+    // Take over the nodes and pool of another list and leave it empty
+    void take(LinkedList &other)
+    {
+        head = other.head;
+        tail = other.tail;
+        _size = other._size;
+        _pool = std::move(other._pool);
+        finger = other.finger;
+        finger_index = other.finger_index;
+        other.head = other.tail = other.finger = nullptr;
+        other._size = 0;
+    }
+
+    // Make sure nodes coming from another list stay alive with this list
+    void share_nodes_of(LinkedList &other)
+    {
+        if (other._pool == _pool)
+            return;
+        if (!_pool)
+            _pool = std::make_shared<NodePool>();
+        _pool->adopt(*other._pool);
+    }
+
+    /**
+     * @brief Merge two sorted chains linked through next. On equal values
+     * the node from the first chain comes first.
+     *
+     * @return Node* The first node of the merged chain
+     */
+    static Node *merge_chains(Node *a, Node *b)
+    {
+        Node before;
+        Node *last = &before;
+        while (a != nullptr && b != nullptr)
+        {
+            if (b->value < a->value)
+            {
+                last->next = b;
+                b = b->next;
+            }
+            else
+            {
+                last->next = a;
+                a = a->next;
+            }
+            last = last->next;
+        }
+        last->next = a != nullptr ? a : b;
+        return before.next;
+    }
+
+    // Make head the start of a chain linked through next, and set the prev
+    // pointers and tail to match
+    void relink_from(Node *first)
+    {
+        head = first;
+        tail = nullptr;
+        for (Node *current = first; current != nullptr; current = current->next)
+        {
+            current->prev = tail;
+            tail = current;
+        }
+        finger = nullptr;
+    }
+
+    Node *new_node(int val, Node *prev, Node *next)
+    {
+        if (!_pool)
+            _pool = std::make_shared<NodePool>();
+        return _pool->acquire(val, prev, next);
+    }
 
     /**
      * @brief Check wheter the given index if out of
@@ -34,7 +299,8 @@ class LinkedList
     }
 
     /**
-     * @brief Find the node at the given index
+     * @brief Find the node at the given index, walking from the nearest of
+     * the head, the tail and the finger, and move the finger there
      *
      * @param index The index where you want the node
      * @return Node* A pointer to the node at the index
@@ -42,11 +308,60 @@ class LinkedList
     Node *find_node_at_index(int index)
     {
         Node *current = head;
-        for (int i = 0; i < index; i++)
+        int position = 0;
+        int distance = index;
+        if (_size - 1 - index < distance)
+        {
+            current = tail;
+            position = _size - 1;
+            distance = _size - 1 - index;
+        }
+        if (finger != nullptr && std::abs(index - finger_index) < distance)
+        {
+            current = finger;
+            position = finger_index;
+        }
+        for (; position < index; position++)
             current = current->next;
+        for (; position > index; position--)
+            current = current->prev;
+
+        finger = current;
+        finger_index = index;
         return current;
     }
 
+    /**
+     * @brief Unlink the node at the given index and give it back to the pool
+     *
+     * @param current The node
+     * @param index Its index
+     */
+    void erase_node(Node *current, int index)
+    {
+        if (current->prev != nullptr)
+            current->prev->next = current->next;
+        else
+            head = current->next;
+        if (current->next != nullptr)
+            current->next->prev = current->prev;
+        else
+            tail = current->prev;
+
+        // Keep the finger on a live node
+        if (finger == current)
+        {
+            finger = current->next != nullptr ? current->next : current->prev;
+            finger_index = current->next != nullptr ? index : index - 1;
+        }
+        else if (finger != nullptr && finger_index > index)
+        {
+            finger_index--;
+        }
+        _pool->release(current);
+        _size--;
+    }
+
   public:
     // Default constructor
     LinkedList()
@@ -60,16 +375,342 @@ class LinkedList
             append(v);
     }
 
+    // Constructor for a list that takes its nodes from a shared pool. It is a
+    // template so that a braced list like {0} never converts to a pool.
+    template <typename Pool, typename = std::enable_if_t<std::is_same<Pool, std::shared_ptr<NodePool>>::value>>
+    explicit LinkedList(Pool pool) : _pool(std::move(pool))
+    {
+    }
+
+    LinkedList(const LinkedList &) = delete;
+    LinkedList &operator=(const LinkedList &) = delete;
+
+    // Move constructor, takes over the nodes and leaves the other list empty
+    LinkedList(LinkedList &&other) noexcept
+    {
+        take(other);
+    }
+
+    LinkedList &operator=(LinkedList &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release_nodes();
+            take(other);
+        }
+        return *this;
+    }
+
 ~LinkedList()
 {
-    Node *current = head;
-    while (current != nullptr)
+    release_nodes();
+}
+
+    /**
+     * @brief Return the pool the nodes come from
+     *
+     * @return std::shared_ptr<NodePool> The pool, null before the first insertion
+     */
+    std::shared_ptr<NodePool> pool()
     {
-        Node *next = current->next;
-        delete current;
-        current = next;
+        return _pool;
+    }
+
+    /**
+     * @brief Bidirectional iterator over the values. It stays valid until
+     * the node it points to is removed.
+     *
+     */
+    template <typename Value>
+    class basic_iterator
+    {
+        friend class LinkedList;
+        template <typename> friend class basic_iterator;
+
+        Node *node = nullptr;
+        // Needed to step back from end()
+        const LinkedList *list = nullptr;
+
+        basic_iterator(Node *node, const LinkedList *list) : node(node), list(list)
+        {
+        }
+
+      public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value *;
+        using reference = Value &;
+
+        basic_iterator()
+        {
+        }
+
+        // An iterator converts to a const_iterator
+        operator basic_iterator<const int>() const
+        {
+            return basic_iterator<const int>(node, list);
+        }
+
+        reference operator*() const
+        {
+            return node->value;
+        }
+
+        pointer operator->() const
+        {
+            return &node->value;
+        }
+
+        basic_iterator &operator++()
+        {
+            node = node->next;
+            return *this;
+        }
+
+        basic_iterator operator++(int)
+        {
+            basic_iterator old = *this;
+            node = node->next;
+            return old;
+        }
+
+        basic_iterator &operator--()
+        {
+            node = node == nullptr ? list->tail : node->prev;
+            return *this;
+        }
+
+        basic_iterator operator--(int)
+        {
+            basic_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        friend bool operator==(const basic_iterator &a, const basic_iterator &b)
+        {
+            return a.node == b.node;
+        }
+
+        friend bool operator!=(const basic_iterator &a, const basic_iterator &b)
+        {
+            return a.node != b.node;
+        }
+    };
+
+    using iterator = basic_iterator<int>;
+    using const_iterator = basic_iterator<const int>;
+
+    iterator begin()
+    {
+        return iterator(head, this);
+    }
+
+    iterator end()
+    {
+        return iterator(nullptr, this);
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(head, this);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(nullptr, this);
+    }
+
+    /**
+     * @brief Insert a value in front of the node an iterator points to,
+     * without walking the list
+     *
+     * @param position The iterator, end() to append
+     * @param val The value to be added
+     * @return iterator The new node
+     */
+    iterator insert_before(iterator position, int val)
+    {
+        if (position.node == nullptr)
+        {
+            append(val);
+            return iterator(tail, this);
+        }
+        if (position.node == head)
+        {
+            push_front(val);
+            return begin();
+        }
+        Node *current = position.node;
+        Node *newNode = new_node(val, current->prev, current);
+        current->prev->next = newNode;
+        current->prev = newNode;
+        // The index of the new node is unknown, so the finger can't be kept
+        finger = nullptr;
+        _size++;
+        return iterator(newNode, this);
+    }
+
+    /**
+     * @brief Move all nodes of another list in front of the node an iterator
+     * points to. Nothing is copied or allocated; the other list is left empty.
+     *
+     * @param position The iterator, end() to add the nodes at the end
+     * @param other The list to take the nodes from
+     */
+    void splice(iterator position, LinkedList &other)
+    {
+        if (&other == this || other._size == 0)
+            return;
+        share_nodes_of(other);
+
+        Node *next = position.node;
+        Node *prev = next == nullptr ? tail : next->prev;
+        other.head->prev = prev;
+        other.tail->next = next;
+        if (prev != nullptr)
+            prev->next = other.head;
+        else
+            head = other.head;
+        if (next != nullptr)
+            next->prev = other.tail;
+        else
+            tail = other.tail;
+
+        // The finger keeps its node; only its index can move
+        if (finger != nullptr && next != nullptr)
+        {
+            if (prev == nullptr)
+                finger_index += other._size;
+            else
+                finger = nullptr;
+        }
+        _size += other._size;
+
+        other.head = other.tail = other.finger = nullptr;
+        other._size = 0;
+    }
+
+    /**
+     * @brief Move all nodes of another list to the end of this one
+     *
+     * @param other The list to take the nodes from, left empty
+     */
+    void concat(LinkedList &other)
+    {
+        splice(end(), other);
+    }
+
+    /**
+     * @brief Cut the list in two at an index. The nodes from the index on
+     * move to a new list that shares this list's pool; nothing is copied.
+     *
+     * @param index The first index of the new list, between 0 and length()
+     * @return LinkedList The list of the elements from the index on
+     */
+    LinkedList split_at(int index)
+    {
+        if (index < 0 || index > _size)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        LinkedList rest{_pool};
+        if (index == _size)
+            return rest;
+
+        Node *first = find_node_at_index(index);
+        rest.head = first;
+        rest.tail = tail;
+        rest._size = _size - index;
+
+        tail = first->prev;
+        if (tail != nullptr)
+            tail->next = nullptr;
+        else
+            head = nullptr;
+        first->prev = nullptr;
+        _size = index;
+        finger = tail;
+        finger_index = index - 1;
+        return rest;
+    }
+
+    /**
+     * @brief Sort the list in place with a bottom-up merge sort on the links.
+     * O(N log N), stable, and no allocation.
+     *
+     */
+    void sort()
+    {
+        if (_size < 2)
+            return;
+
+        // runs[i] holds a sorted run of 2^i nodes, or nothing. Each node is
+        // added as a run of one and equal runs are merged, like a binary
+        // counter; earlier nodes are always in the first chain of a merge.
+        Node *runs[32] = {};
+        Node *current = head;
+        while (current != nullptr)
+        {
+            Node *run = current;
+            current = current->next;
+            run->next = nullptr;
+            int i = 0;
+            for (; runs[i] != nullptr; i++)
+            {
+                run = merge_chains(runs[i], run);
+                runs[i] = nullptr;
+            }
+            runs[i] = run;
+        }
+
+        Node *sorted = nullptr;
+        for (Node *run : runs)
+        {
+            if (run != nullptr)
+                sorted = merge_chains(run, sorted);
+        }
+        relink_from(sorted);
+    }
+
+    /**
+     * @brief Merge another sorted list into this sorted list in linear time,
+     * by relinking the nodes. On equal values the elements of this list come
+     * first. The other list is left empty.
+     *
+     * @param other The list to take the nodes from
+     */
+    void merge(LinkedList &other)
+    {
+        if (&other == this || other._size == 0)
+            return;
+        share_nodes_of(other);
+        relink_from(merge_chains(head, other.head));
+        _size += other._size;
+
+        other.head = other.tail = other.finger = nullptr;
+        other._size = 0;
+    }
+
+    /**
+     * @brief Remove the node an iterator points to, without walking the list
+     *
+     * @param position The iterator
+     * @return iterator The node after the removed one
+     */
+    iterator erase(iterator position)
+    {
+        if (position.node == nullptr)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        Node *next = position.node->next;
+        // The index of the node is unknown, so the finger can't be kept
+        finger = nullptr;
+        erase_node(position.node, 0);
+        return iterator(next, this);
     }
-}
 
 
     /**
@@ -90,7 +731,7 @@ class LinkedList
 void append(int val)
 {
     _size++;
-    Node *newNode = new Node{val, tail, nullptr};
+    Node *newNode = new_node(val, tail, nullptr);
     if (head == nullptr)
     {
         // Hvis listen er tom, setter både hodet og halen til den nye noden.
@@ -146,11 +787,14 @@ void print()
      */
 void push_front(int val)
 {
-    Node *newNode = new Node{val, nullptr, head};
+    Node *newNode = new_node(val, nullptr, head);
     if (head != nullptr) {
         head->prev = newNode;
     }
     head = newNode;
+    if (finger != nullptr) {
+        finger_index++;
+    }
 
     if (tail == nullptr) {
         // Hvis listen er tom, oppdaterer vi også halen til å være den nye noden.
@@ -186,12 +830,14 @@ void insert(int val, int index)
     Node *current = find_node_at_index(index);
 
     // Opprett en ny node med de riktige pekerne
-    Node *newNode = new Node{val, current->prev, current};
+    Node *newNode = new_node(val, current->prev, current);
 
     // Oppdater pekerne for de omkringliggende noder
     current->prev->next = newNode;
     current->prev = newNode;
 
+    // Fingeren peker nå på den nye noden
+    finger = newNode;
     _size++;
 }
 
@@ -209,149 +855,2231 @@ void remove(int index)
         throw std::out_of_range("Index out of bounds");
     }
 
-    // Finn den gjeldende noden ved den valgte indeksen
+    // Finn den gjeldende noden ved den valgte indeksen og fjern den
     Node *current = find_node_at_index(index);
+    erase_node(current, index);
+}
+
+
+    /***
+     * @brief removing element at index given
+     * 
+     * @param index
+     * @return int the value at that index
+    */
+int pop(int index)
+{
+    if (index < 0 || index >= _size)
+    {
+        throw std::out_of_range("Index out of bounds");
+    }
+
+    Node *current = find_node_at_index(index);
+    int value = current->value;
+    erase_node(current, index);
+    return value;
+}
+
+int pop()
+{
+    if (_size == 0)
+    {
+        throw std::out_of_range("List is empty");
+    }
+
+    int value = tail->value;
+    erase_node(tail, _size - 1);
+    return value;
+}
+
+
+    int min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+
+        int minimum = head->value;
+        Node *current = head->next;
+
+        while (current != nullptr)
+        {
+            if (current->value < minimum)
+            {
+                minimum = current->value;
+            }
+            current = current->next;
+        }
+
+        return minimum;
+    }
+
+    int max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+
+        int maximum = head->value;
+        Node *current = head->next;
 
-    if (index == 0)
+        while (current != nullptr)
+        {
+            if (current->value > maximum)
+            {
+                maximum = current->value;
+            }
+            current = current->next;
+        }
+
+        return maximum;
+    }
+
+    // Test functions
+    void test_min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+
+        int minValue = min();
+        std::cout << "The minimum value in the list is: " << minValue << " - Success!\n";
+    }
+
+    void test_max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+
+        int maxValue = max();
+        std::cout << "The maximum value in the list is: " << maxValue << " - Success!\n";
+    }
+
+};
+
+struct UnrolledNode
+{
+    // Number of values that fit when a node fills two cache lines
+    static constexpr int capacity = (128 - 2 * sizeof(void *) - sizeof(int)) / sizeof(int);
+
+    // Number of values in use, packed at the start of the array
+    int count = 0;
+    int values[capacity];
+    UnrolledNode *prev = nullptr;
+    UnrolledNode *next = nullptr;
+};
+
+/**
+ * @brief Linked list that keeps a small packed array of values in each node,
+ * so traversals touch one node per UnrolledNode::capacity values instead of
+ * one per value. Has the same interface as LinkedList.
+ *
+ */
+class UnrolledLinkedList
+{
+  private:
+    UnrolledNode *head = nullptr;
+    UnrolledNode *tail = nullptr;
+    // Number of values in the list
+    int _size = 0;
+
+    void check_index_out_of_bounds(int index)
     {
-        // Hvis vi fjerner den første noden, oppdater hodet
-        head = current->next;
-        if (head != nullptr)
+        if ((index < 0) || (index >= length()))
+            throw std::range_error("Index out of bounds");
+    }
+
+    /**
+     * @brief Find the node holding the given index, walking from whichever
+     * end is closer
+     *
+     * @param index The index, between 0 and length() - 1
+     * @param offset Set to the position of the index inside the node
+     * @return UnrolledNode* The node
+     */
+    UnrolledNode *find_node_at_index(int index, int &offset)
+    {
+        if (index < _size / 2)
         {
-            head->prev = nullptr;
+            UnrolledNode *current = head;
+            while (index >= current->count)
+            {
+                index -= current->count;
+                current = current->next;
+            }
+            offset = index;
+            return current;
+        }
+        UnrolledNode *current = tail;
+        int start = _size - current->count;
+        while (index < start)
+        {
+            current = current->prev;
+            start -= current->count;
         }
+        offset = index - start;
+        return current;
+    }
+
+    // Link a new, empty node in after the given one (or at the front if null)
+    UnrolledNode *add_node_after(UnrolledNode *node)
+    {
+        UnrolledNode *newNode = new UnrolledNode{};
+        newNode->prev = node;
+        newNode->next = node == nullptr ? head : node->next;
+        if (newNode->next != nullptr)
+            newNode->next->prev = newNode;
         else
+            tail = newNode;
+        if (node != nullptr)
+            node->next = newNode;
+        else
+            head = newNode;
+        return newNode;
+    }
+
+    void unlink_node(UnrolledNode *node)
+    {
+        if (node->prev != nullptr)
+            node->prev->next = node->next;
+        else
+            head = node->next;
+        if (node->next != nullptr)
+            node->next->prev = node->prev;
+        else
+            tail = node->prev;
+        delete node;
+    }
+
+    /**
+     * @brief Put a value at the given position inside a node, splitting the
+     * node in two halves first if it is full
+     */
+    void insert_into_node(UnrolledNode *node, int offset, int val)
+    {
+        if (node->count == UnrolledNode::capacity)
         {
-            // Hvis listen nå er tom, oppdater også halen
-            tail = nullptr;
+            UnrolledNode *second = add_node_after(node);
+            int half = node->count / 2;
+            second->count = node->count - half;
+            std::copy(node->values + half, node->values + node->count, second->values);
+            node->count = half;
+            if (offset > half)
+            {
+                node = second;
+                offset -= half;
+            }
         }
+        std::copy_backward(node->values + offset, node->values + node->count, node->values + node->count + 1);
+        node->values[offset] = val;
+        node->count++;
+        _size++;
     }
-    else if (index == _size - 1)
+
+    /**
+     * @brief Take the value at the given position out of a node, and keep
+     * nodes at least half full by merging with or borrowing from the next one
+     */
+    void remove_from_node(UnrolledNode *node, int offset)
     {
-        // Hvis vi fjerner den siste noden, oppdater halen
-        tail = current->prev;
-        if (tail != nullptr)
+        std::copy(node->values + offset + 1, node->values + node->count, node->values + offset);
+        node->count--;
+        _size--;
+
+        UnrolledNode *next = node->next;
+        if (node->count >= UnrolledNode::capacity / 2 || next == nullptr)
         {
-            tail->next = nullptr;
+            if (node->count == 0)
+                unlink_node(node);
+            return;
+        }
+        if (node->count + next->count <= UnrolledNode::capacity)
+        {
+            std::copy(next->values, next->values + next->count, node->values + node->count);
+            node->count += next->count;
+            unlink_node(next);
         }
         else
         {
-            // Hvis listen nå er tom, oppdater også hodet
-            head = nullptr;
+            int moved = (next->count - node->count) / 2;
+            std::copy(next->values, next->values + moved, node->values + node->count);
+            std::copy(next->values + moved, next->values + next->count, next->values);
+            node->count += moved;
+            next->count -= moved;
         }
     }
-    else
+
+  public:
+    // Default constructor
+    UnrolledLinkedList()
+    {
+    }
+
+    // Constructor for a list of values
+    UnrolledLinkedList(std::vector<int> values)
+    {
+        for (int v : values)
+            append(v);
+    }
+
+    UnrolledLinkedList(const UnrolledLinkedList &) = delete;
+    UnrolledLinkedList &operator=(const UnrolledLinkedList &) = delete;
+
+    ~UnrolledLinkedList()
+    {
+        UnrolledNode *current = head;
+        while (current != nullptr)
+        {
+            UnrolledNode *next = current->next;
+            delete current;
+            current = next;
+        }
+    }
+
+    /**
+     * @brief Return the length of the list
+     *
+     * @return int The length
+     */
+    int length()
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param val The value to be appended
+     */
+    void append(int val)
+    {
+        if (tail == nullptr || tail->count == UnrolledNode::capacity)
+            add_node_after(tail);
+        tail->values[tail->count++] = val;
+        _size++;
+    }
+
+    /**
+     * @brief Print values in the list
+     *
+     */
+    void print()
     {
-        // Hvis vi fjerner en node i midten, oppdater pekerne for de omkringliggende nodene
-        current->prev->next = current->next;
-        current->next->prev = current->prev;
+        std::cout << "[";
+        for (UnrolledNode *current = head; current != nullptr; current = current->next)
+        {
+            for (int i = 0; i < current->count; i++)
+            {
+                std::cout << current->values[i];
+                if (i + 1 < current->count || current->next != nullptr)
+                    std::cout << ", ";
+            }
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get value at a given index
+     *
+     * @param index The index
+     * @return int& Reference to the value at that index
+     */
+    int &operator[](int index)
+    {
+        check_index_out_of_bounds(index);
+        int offset;
+        UnrolledNode *current = find_node_at_index(index, offset);
+        return current->values[offset];
+    }
+
+    /**
+     * @brief Add element to the beginning of the list
+     *
+     * @param val The value to be added
+     */
+    void push_front(int val)
+    {
+        if (head == nullptr)
+            add_node_after(nullptr);
+        insert_into_node(head, 0, val);
+    }
+
+    /***
+     * @brief Add element to index chosen
+     *
+     * @param val The value to be added
+     * @param index The index
+     */
+    void insert(int val, int index)
+    {
+        if (index <= 0)
+        {
+            push_front(val);
+            return;
+        }
+        if (index >= _size)
+        {
+            append(val);
+            return;
+        }
+        int offset;
+        UnrolledNode *current = find_node_at_index(index, offset);
+        insert_into_node(current, offset, val);
+    }
+
+    /**
+     * @brief deletes the element at given index from the list.
+     *
+     * @param index The index.
+     */
+    void remove(int index)
+    {
+        pop(index);
+    }
+
+    /***
+     * @brief removing element at index given
+     *
+     * @param index
+     * @return int the value at that index
+     */
+    int pop(int index)
+    {
+        if (index < 0 || index >= _size)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        int offset;
+        UnrolledNode *current = find_node_at_index(index, offset);
+        int value = current->values[offset];
+        remove_from_node(current, offset);
+        return value;
+    }
+
+    int pop()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        return pop(_size - 1);
+    }
+
+    int min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int minimum = head->values[0];
+        for (UnrolledNode *current = head; current != nullptr; current = current->next)
+        {
+            for (int i = 0; i < current->count; i++)
+            {
+                if (current->values[i] < minimum)
+                    minimum = current->values[i];
+            }
+        }
+        return minimum;
+    }
+
+    int max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int maximum = head->values[0];
+        for (UnrolledNode *current = head; current != nullptr; current = current->next)
+        {
+            for (int i = 0; i < current->count; i++)
+            {
+                if (current->values[i] > maximum)
+                    maximum = current->values[i];
+            }
+        }
+        return maximum;
+    }
+};
+
+struct SkipNode
+{
+    // Link to the next node on one level, and how many positions it skips
+    struct Link
+    {
+        SkipNode *next;
+        int width;
+    };
+
+    int value;
+    // Number of levels the node takes part in
+    int height;
+
+    // The links are allocated right after the node
+    Link *links()
+    {
+        return reinterpret_cast<Link *>(this + 1);
+    }
+
+    static SkipNode *create(int value, int height)
+    {
+        void *memory = ::operator new(sizeof(SkipNode) + height * sizeof(Link));
+        SkipNode *node = new (memory) SkipNode{value, height};
+        for (int l = 0; l < height; l++)
+            new (node->links() + l) Link{nullptr, 0};
+        return node;
+    }
+
+    static void destroy(SkipNode *node)
+    {
+        ::operator delete(node);
+    }
+};
+
+/**
+ * @brief Indexable skip list. Every link stores how many positions it skips,
+ * so operator[], insert, remove and pop take expected O(log N) steps. Has the
+ * same interface as LinkedList.
+ *
+ */
+class SkipList
+{
+  private:
+    static constexpr int max_height = 32;
+
+    // Sentinel before the first element, at position 0. Element i is at
+    // position i + 1, and a link to nullptr reaches position length() + 1.
+    SkipNode *head = SkipNode::create(0, max_height);
+    // Number of levels in use
+    int levels = 1;
+    int _size = 0;
+    // State of the random number generator for node heights
+    unsigned long long seed = 0x9E3779B97F4A7C15ULL;
+
+    void check_index_out_of_bounds(int index)
+    {
+        if ((index < 0) || (index >= length()))
+            throw std::range_error("Index out of bounds");
+    }
+
+    // Height for a new node, each extra level with probability 1/2
+    int random_height()
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        int height = 1;
+        unsigned long long bits = seed;
+        while ((bits & 1) && height < max_height)
+        {
+            height++;
+            bits >>= 1;
+        }
+        return height;
+    }
+
+    /**
+     * @brief Find the last node before the given position on every level
+     *
+     * @param position The position
+     * @param update Set to the node on each level
+     * @param update_position Set to the position of those nodes
+     */
+    void find_predecessors(int position, SkipNode **update, int *update_position)
+    {
+        SkipNode *current = head;
+        int current_position = 0;
+        for (int l = levels - 1; l >= 0; l--)
+        {
+            while (current_position + current->links()[l].width < position)
+            {
+                current_position += current->links()[l].width;
+                current = current->links()[l].next;
+            }
+            update[l] = current;
+            update_position[l] = current_position;
+        }
+    }
+
+    /**
+     * @brief Find the node at the given index
+     *
+     * @param index The index, between 0 and length() - 1
+     * @return SkipNode* The node
+     */
+    SkipNode *find_node_at_index(int index)
+    {
+        int position = index + 1;
+        SkipNode *current = head;
+        int current_position = 0;
+        for (int l = levels - 1; l >= 0; l--)
+        {
+            while (current_position + current->links()[l].width <= position)
+            {
+                current_position += current->links()[l].width;
+                current = current->links()[l].next;
+            }
+        }
+        return current;
+    }
+
+  public:
+    // Default constructor
+    SkipList()
+    {
+        head->links()[0].width = 1;
+    }
+
+    // Constructor for a list of values
+    SkipList(std::vector<int> values) : SkipList()
+    {
+        for (int v : values)
+            append(v);
+    }
+
+    SkipList(const SkipList &) = delete;
+    SkipList &operator=(const SkipList &) = delete;
+
+    ~SkipList()
+    {
+        SkipNode *current = head;
+        while (current != nullptr)
+        {
+            SkipNode *next = current->links()[0].next;
+            SkipNode::destroy(current);
+            current = next;
+        }
+    }
+
+    /**
+     * @brief Return the length of the list
+     *
+     * @return int The length
+     */
+    int length()
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param val The value to be appended
+     */
+    void append(int val)
+    {
+        insert(val, _size);
+    }
+
+    /**
+     * @brief Print values in the list
+     *
+     */
+    void print()
+    {
+        std::cout << "[";
+        SkipNode *current = head->links()[0].next;
+        while (current != nullptr)
+        {
+            std::cout << current->value;
+            current = current->links()[0].next;
+            if (current != nullptr)
+                std::cout << ", ";
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get value at a given index
+     *
+     * @param index The index
+     * @return int& Reference to the value at that index
+     */
+    int &operator[](int index)
+    {
+        check_index_out_of_bounds(index);
+        return find_node_at_index(index)->value;
+    }
+
+    /**
+     * @brief Add element to the beginning of the list
+     *
+     * @param val The value to be added
+     */
+    void push_front(int val)
+    {
+        insert(val, 0);
+    }
+
+    /***
+     * @brief Add element to index chosen
+     *
+     * @param val The value to be added
+     * @param index The index
+     */
+    void insert(int val, int index)
+    {
+        index = std::max(0, std::min(index, _size));
+        int position = index + 1;
+
+        int height = random_height();
+        while (levels < height)
+        {
+            // A new level starts with one link from the head past the end
+            head->links()[levels] = {nullptr, _size + 1};
+            levels++;
+        }
+
+        SkipNode *update[max_height] = {};
+        int update_position[max_height] = {};
+        find_predecessors(position, update, update_position);
+
+        SkipNode *newNode = SkipNode::create(val, height);
+        for (int l = 0; l < levels; l++)
+        {
+            SkipNode::Link &link = update[l]->links()[l];
+            if (l < height)
+            {
+                int end = update_position[l] + link.width + 1;
+                newNode->links()[l] = {link.next, end - position};
+                link = {newNode, position - update_position[l]};
+            }
+            else
+            {
+                link.width++;
+            }
+        }
+        _size++;
+    }
+
+    /**
+     * @brief deletes the element at given index from the list.
+     *
+     * @param index The index.
+     */
+    void remove(int index)
+    {
+        pop(index);
+    }
+
+    /***
+     * @brief removing element at index given
+     *
+     * @param index
+     * @return int the value at that index
+     */
+    int pop(int index)
+    {
+        if (index < 0 || index >= _size)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        SkipNode *update[max_height] = {};
+        int update_position[max_height] = {};
+        find_predecessors(index + 1, update, update_position);
+
+        SkipNode *current = update[0]->links()[0].next;
+        for (int l = 0; l < levels; l++)
+        {
+            SkipNode::Link &link = update[l]->links()[l];
+            if (l < current->height)
+                link = {current->links()[l].next, link.width + current->links()[l].width - 1};
+            else
+                link.width--;
+        }
+        while (levels > 1 && head->links()[levels - 1].next == nullptr)
+            levels--;
+
+        int value = current->value;
+        SkipNode::destroy(current);
+        _size--;
+        return value;
+    }
+
+    int pop()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        return pop(_size - 1);
+    }
+
+    int min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int minimum = head->links()[0].next->value;
+        for (SkipNode *current = head->links()[0].next; current != nullptr; current = current->links()[0].next)
+        {
+            if (current->value < minimum)
+                minimum = current->value;
+        }
+        return minimum;
+    }
+
+    int max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int maximum = head->links()[0].next->value;
+        for (SkipNode *current = head->links()[0].next; current != nullptr; current = current->links()[0].next)
+        {
+            if (current->value > maximum)
+                maximum = current->value;
+        }
+        return maximum;
+    }
+};
+
+struct BTreeNode
+{
+    bool leaf;
+    // Number of values in a leaf, or children in a branch
+    int count = 0;
+    // Smallest and largest value in the subtree
+    int min = 0;
+    int max = 0;
+
+    explicit BTreeNode(bool leaf) : leaf(leaf)
+    {
+    }
+};
+
+struct BTreeLeaf : BTreeNode
+{
+    static constexpr int capacity = 64;
+    // Room for one extra value before the leaf is split
+    int values[capacity + 1] = {};
+
+    BTreeLeaf() : BTreeNode(true)
+    {
+    }
+};
+
+struct BTreeBranch : BTreeNode
+{
+    static constexpr int capacity = 32;
+    // Number of values under each child; room for one extra child before
+    // the branch is split
+    int sizes[capacity + 1] = {};
+    BTreeNode *children[capacity + 1] = {};
+
+    BTreeBranch() : BTreeNode(false)
+    {
+    }
+};
+
+/**
+ * @brief Sequence stored as a counted B+tree. Leaves hold packed arrays of
+ * values and branches keep the number of values under each child, so
+ * operator[], insert, remove and pop take O(log N) steps in the worst case.
+ * Every node also keeps the minimum and maximum of its subtree, so min() and
+ * max() are O(1). Has the same interface as LinkedList.
+ *
+ */
+class CountedBTree
+{
+  private:
+    BTreeNode *root = nullptr;
+    int _size = 0;
+
+    void check_index_out_of_bounds(int index)
+    {
+        if ((index < 0) || (index >= length()))
+            throw std::range_error("Index out of bounds");
+    }
+
+    static void destroy(BTreeNode *node)
+    {
+        if (node->leaf)
+        {
+            delete static_cast<BTreeLeaf *>(node);
+            return;
+        }
+        BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+        for (int i = 0; i < branch->count; i++)
+            destroy(branch->children[i]);
+        delete branch;
+    }
+
+    static int capacity_of(BTreeNode *node)
+    {
+        return node->leaf ? BTreeLeaf::capacity : BTreeBranch::capacity;
+    }
+
+    // Recompute the minimum and maximum of a node from its values or children
+    static void refresh(BTreeNode *node)
+    {
+        if (node->leaf)
+        {
+            BTreeLeaf *leaf = static_cast<BTreeLeaf *>(node);
+            leaf->min = *std::min_element(leaf->values, leaf->values + leaf->count);
+            leaf->max = *std::max_element(leaf->values, leaf->values + leaf->count);
+            return;
+        }
+        BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+        branch->min = branch->children[0]->min;
+        branch->max = branch->children[0]->max;
+        for (int i = 1; i < branch->count; i++)
+        {
+            branch->min = std::min(branch->min, branch->children[i]->min);
+            branch->max = std::max(branch->max, branch->children[i]->max);
+        }
+    }
+
+    // Number of values in a subtree
+    static int subtree_size(BTreeNode *node)
+    {
+        if (node->leaf)
+            return node->count;
+        BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+        return std::accumulate(branch->sizes, branch->sizes + branch->count, 0);
+    }
+
+    // Find the child of a branch holding the given index, and the index
+    // inside it; an index one past the end goes to the last child
+    static int find_child(BTreeBranch *branch, int &index)
+    {
+        int i = 0;
+        while (i + 1 < branch->count && index >= branch->sizes[i])
+        {
+            index -= branch->sizes[i];
+            i++;
+        }
+        return i;
+    }
+
+    /**
+     * @brief Move the last entries of a node, starting at from, to the front
+     * of an empty or following sibling
+     *
+     * @return int The number of values that moved
+     */
+    static int move_tail(BTreeNode *node, int from, BTreeNode *sibling)
+    {
+        int moved = node->count - from;
+        int values = moved;
+        if (node->leaf)
+        {
+            BTreeLeaf *left = static_cast<BTreeLeaf *>(node);
+            BTreeLeaf *right = static_cast<BTreeLeaf *>(sibling);
+            std::copy_backward(right->values, right->values + right->count, right->values + right->count + moved);
+            std::copy(left->values + from, left->values + left->count, right->values);
+        }
+        else
+        {
+            BTreeBranch *left = static_cast<BTreeBranch *>(node);
+            BTreeBranch *right = static_cast<BTreeBranch *>(sibling);
+            std::copy_backward(right->sizes, right->sizes + right->count, right->sizes + right->count + moved);
+            std::copy_backward(right->children, right->children + right->count, right->children + right->count + moved);
+            std::copy(left->sizes + from, left->sizes + left->count, right->sizes);
+            std::copy(left->children + from, left->children + left->count, right->children);
+            values = std::accumulate(right->sizes, right->sizes + moved, 0);
+        }
+        node->count = from;
+        sibling->count += moved;
+        return values;
+    }
+
+    /**
+     * @brief Move the first entries of a node to the end of the preceding
+     * sibling
+     *
+     * @return int The number of values that moved
+     */
+    static int move_head(BTreeNode *node, int moved, BTreeNode *sibling)
+    {
+        int values = moved;
+        if (node->leaf)
+        {
+            BTreeLeaf *right = static_cast<BTreeLeaf *>(node);
+            BTreeLeaf *left = static_cast<BTreeLeaf *>(sibling);
+            std::copy(right->values, right->values + moved, left->values + left->count);
+            std::copy(right->values + moved, right->values + right->count, right->values);
+        }
+        else
+        {
+            BTreeBranch *right = static_cast<BTreeBranch *>(node);
+            BTreeBranch *left = static_cast<BTreeBranch *>(sibling);
+            values = std::accumulate(right->sizes, right->sizes + moved, 0);
+            std::copy(right->sizes, right->sizes + moved, left->sizes + left->count);
+            std::copy(right->children, right->children + moved, left->children + left->count);
+            std::copy(right->sizes + moved, right->sizes + right->count, right->sizes);
+            std::copy(right->children + moved, right->children + right->count, right->children);
+        }
+        node->count -= moved;
+        sibling->count += moved;
+        return values;
+    }
+
+    /**
+     * @brief Insert a value into a subtree
+     *
+     * @return BTreeNode* The new right half if the node was split, else null
+     */
+    BTreeNode *insert_into(BTreeNode *node, int index, int val)
+    {
+        if (node->leaf)
+        {
+            BTreeLeaf *leaf = static_cast<BTreeLeaf *>(node);
+            std::copy_backward(leaf->values + index, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+            leaf->values[index] = val;
+            leaf->count++;
+        }
+        else
+        {
+            BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+            int i = find_child(branch, index);
+            BTreeNode *split = insert_into(branch->children[i], index, val);
+            branch->sizes[i]++;
+            if (split != nullptr)
+            {
+                std::copy_backward(branch->sizes + i + 1, branch->sizes + branch->count, branch->sizes + branch->count + 1);
+                std::copy_backward(branch->children + i + 1, branch->children + branch->count, branch->children + branch->count + 1);
+                branch->children[i + 1] = split;
+                branch->count++;
+                int moved = subtree_size(split);
+                branch->sizes[i] -= moved;
+                branch->sizes[i + 1] = moved;
+            }
+        }
+        if (node->count == 1)
+        {
+            node->min = node->max = val;
+        }
+        else
+        {
+            node->min = std::min(node->min, val);
+            node->max = std::max(node->max, val);
+        }
+
+        if (node->count <= capacity_of(node))
+            return nullptr;
+        BTreeNode *sibling;
+        if (node->leaf)
+            sibling = new BTreeLeaf();
+        else
+            sibling = new BTreeBranch();
+        move_tail(node, node->count / 2, sibling);
+        refresh(node);
+        refresh(sibling);
+        return sibling;
+    }
+
+    /**
+     * @brief Join an underfull child of a branch with a neighbour, or move
+     * entries over from the neighbour if they don't fit in one node
+     */
+    void fix_underflow(BTreeBranch *branch, int i)
+    {
+        int left = i + 1 < branch->count ? i : i - 1;
+        int right = left + 1;
+        BTreeNode *a = branch->children[left];
+        BTreeNode *b = branch->children[right];
+        if (a->count + b->count <= capacity_of(a))
+        {
+            move_head(b, b->count, a);
+            branch->sizes[left] += branch->sizes[right];
+            a->min = std::min(a->min, b->min);
+            a->max = std::max(a->max, b->max);
+            destroy(b);
+            std::copy(branch->sizes + right + 1, branch->sizes + branch->count, branch->sizes + right);
+            std::copy(branch->children + right + 1, branch->children + branch->count, branch->children + right);
+            branch->count--;
+            return;
+        }
+        int target = (a->count + b->count) / 2;
+        int moved;
+        if (a->count < target)
+        {
+            moved = move_head(b, target - a->count, a);
+            branch->sizes[left] += moved;
+            branch->sizes[right] -= moved;
+        }
+        else
+        {
+            moved = move_tail(a, target, b);
+            branch->sizes[left] -= moved;
+            branch->sizes[right] += moved;
+        }
+        refresh(a);
+        refresh(b);
+    }
+
+    // Remove the value at an index of a subtree and return it
+    int remove_from(BTreeNode *node, int index)
+    {
+        int value;
+        if (node->leaf)
+        {
+            BTreeLeaf *leaf = static_cast<BTreeLeaf *>(node);
+            value = leaf->values[index];
+            std::copy(leaf->values + index + 1, leaf->values + leaf->count, leaf->values + index);
+            leaf->count--;
+        }
+        else
+        {
+            BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+            int i = find_child(branch, index);
+            BTreeNode *child = branch->children[i];
+            value = remove_from(child, index);
+            branch->sizes[i]--;
+            if (child->count < capacity_of(child) / 2)
+                fix_underflow(branch, i);
+        }
+        if (node->count > 0 && (value == node->min || value == node->max))
+            refresh(node);
+        return value;
+    }
+
+    // Write a value at an index of a subtree and return the value it replaced
+    static int set_in(BTreeNode *node, int index, int val)
+    {
+        int old;
+        if (node->leaf)
+        {
+            BTreeLeaf *leaf = static_cast<BTreeLeaf *>(node);
+            old = leaf->values[index];
+            leaf->values[index] = val;
+        }
+        else
+        {
+            BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+            int i = find_child(branch, index);
+            old = set_in(branch->children[i], index, val);
+        }
+        if (old == node->min || old == node->max)
+        {
+            refresh(node);
+        }
+        else
+        {
+            node->min = std::min(node->min, val);
+            node->max = std::max(node->max, val);
+        }
+        return old;
+    }
+
+    static void print_node(BTreeNode *node, bool &first)
+    {
+        if (node->leaf)
+        {
+            BTreeLeaf *leaf = static_cast<BTreeLeaf *>(node);
+            for (int i = 0; i < leaf->count; i++)
+            {
+                if (!first)
+                    std::cout << ", ";
+                std::cout << leaf->values[i];
+                first = false;
+            }
+            return;
+        }
+        BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+        for (int i = 0; i < branch->count; i++)
+            print_node(branch->children[i], first);
+    }
+
+  public:
+    // Default constructor
+    CountedBTree()
+    {
+    }
+
+    // Constructor for a list of values
+    CountedBTree(std::vector<int> values)
+    {
+        for (int v : values)
+            append(v);
+    }
+
+    CountedBTree(const CountedBTree &) = delete;
+    CountedBTree &operator=(const CountedBTree &) = delete;
+
+    ~CountedBTree()
+    {
+        if (root != nullptr)
+            destroy(root);
+    }
+
+    /**
+     * @brief Return the length of the list
+     *
+     * @return int The length
+     */
+    int length()
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param val The value to be appended
+     */
+    void append(int val)
+    {
+        insert(val, _size);
+    }
+
+    /**
+     * @brief Print values in the list
+     *
+     */
+    void print()
+    {
+        std::cout << "[";
+        bool first = true;
+        if (root != nullptr)
+            print_node(root, first);
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get value at a given index. It is returned by value, since a
+     * write through a reference would miss the cached minimum and maximum;
+     * use set() to change it.
+     *
+     * @param index The index
+     * @return int The value at that index
+     */
+    int operator[](int index)
+    {
+        check_index_out_of_bounds(index);
+        BTreeNode *node = root;
+        while (!node->leaf)
+        {
+            BTreeBranch *branch = static_cast<BTreeBranch *>(node);
+            node = branch->children[find_child(branch, index)];
+        }
+        return static_cast<BTreeLeaf *>(node)->values[index];
+    }
+
+    /**
+     * @brief Replace the value at a given index, updating the minimum and
+     * maximum of the nodes on the way to it
+     *
+     * @param index The index
+     * @param val The new value
+     */
+    void set(int index, int val)
+    {
+        check_index_out_of_bounds(index);
+        set_in(root, index, val);
+    }
+
+    /**
+     * @brief Add element to the beginning of the list
+     *
+     * @param val The value to be added
+     */
+    void push_front(int val)
+    {
+        insert(val, 0);
+    }
+
+    /***
+     * @brief Add element to index chosen
+     *
+     * @param val The value to be added
+     * @param index The index
+     */
+    void insert(int val, int index)
+    {
+        index = std::max(0, std::min(index, _size));
+        if (root == nullptr)
+            root = new BTreeLeaf();
+
+        BTreeNode *split = insert_into(root, index, val);
+        _size++;
+        if (split != nullptr)
+        {
+            // The tree grows a level
+            BTreeBranch *branch = new BTreeBranch();
+            branch->count = 2;
+            branch->children[0] = root;
+            branch->children[1] = split;
+            branch->sizes[1] = subtree_size(split);
+            branch->sizes[0] = _size - branch->sizes[1];
+            refresh(branch);
+            root = branch;
+        }
+    }
+
+    /**
+     * @brief deletes the element at given index from the list.
+     *
+     * @param index The index.
+     */
+    void remove(int index)
+    {
+        pop(index);
+    }
+
+    /***
+     * @brief removing element at index given
+     *
+     * @param index
+     * @return int the value at that index
+     */
+    int pop(int index)
+    {
+        if (index < 0 || index >= _size)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        int value = remove_from(root, index);
+        _size--;
+
+        // The tree shrinks a level when the root has a single child
+        if (!root->leaf && root->count == 1)
+        {
+            BTreeBranch *branch = static_cast<BTreeBranch *>(root);
+            root = branch->children[0];
+            delete branch;
+        }
+        else if (root->count == 0)
+        {
+            destroy(root);
+            root = nullptr;
+        }
+        return value;
+    }
+
+    int pop()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        return pop(_size - 1);
+    }
+
+    int min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        return root->min;
+    }
+
+    int max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        return root->max;
+    }
+};
+
+struct CompactNode
+{
+    int value;
+    // Slots of the previous and next node in the node array
+    std::uint32_t prev;
+    std::uint32_t next;
+};
+
+/**
+ * @brief Linked list that keeps its nodes in one contiguous array and links
+ * them with 32-bit slot numbers instead of pointers, 12 bytes per element and
+ * no allocation per node. Slots of removed nodes are reused through a free
+ * list, and compact() renumbers the nodes into list order. Has the same
+ * interface as LinkedList.
+ *
+ */
+class CompactLinkedList
+{
+  private:
+    // Slot number that stands for "no node"
+    static constexpr std::uint32_t none = UINT32_MAX;
+
+    std::vector<CompactNode> nodes;
+    std::uint32_t head = none;
+    std::uint32_t tail = none;
+    // Free slots, linked through their next field
+    std::uint32_t free_list = none;
+    int _size = 0;
+
+    void check_index_out_of_bounds(int index)
+    {
+        if ((index < 0) || (index >= length()))
+            throw std::range_error("Index out of bounds");
+    }
+
+    // Find the slot of the node at the given index, walking from the closer end
+    std::uint32_t find_node_at_index(int index)
+    {
+        std::uint32_t current;
+        if (index < _size / 2)
+        {
+            current = head;
+            for (int i = 0; i < index; i++)
+                current = nodes[current].next;
+        }
+        else
+        {
+            current = tail;
+            for (int i = _size - 1; i > index; i--)
+                current = nodes[current].prev;
+        }
+        return current;
+    }
+
+    // Take a free slot, or a new one at the end of the array
+    std::uint32_t new_node(int val, std::uint32_t prev, std::uint32_t next)
+    {
+        std::uint32_t slot;
+        if (free_list != none)
+        {
+            slot = free_list;
+            free_list = nodes[slot].next;
+            nodes[slot] = {val, prev, next};
+        }
+        else
+        {
+            slot = nodes.size();
+            nodes.push_back({val, prev, next});
+        }
+        _size++;
+        return slot;
+    }
+
+    void erase_node(std::uint32_t slot)
+    {
+        CompactNode &node = nodes[slot];
+        if (node.prev != none)
+            nodes[node.prev].next = node.next;
+        else
+            head = node.next;
+        if (node.next != none)
+            nodes[node.next].prev = node.prev;
+        else
+            tail = node.prev;
+        node.next = free_list;
+        free_list = slot;
+        _size--;
+    }
+
+    // True when every slot of the array holds a node of the list
+    bool dense()
+    {
+        return free_list == none;
+    }
+
+  public:
+    // Default constructor
+    CompactLinkedList()
+    {
+    }
+
+    // Constructor for a list of values
+    CompactLinkedList(std::vector<int> values)
+    {
+        nodes.reserve(values.size());
+        for (int v : values)
+            append(v);
+    }
+
+    /**
+     * @brief Return the length of the list
+     *
+     * @return int The length
+     */
+    int length()
+    {
+        return _size;
+    }
+
+    /**
+     * @brief Append element to the end of the list
+     *
+     * @param val The value to be appended
+     */
+    void append(int val)
+    {
+        std::uint32_t slot = new_node(val, tail, none);
+        if (tail != none)
+            nodes[tail].next = slot;
+        else
+            head = slot;
+        tail = slot;
+    }
+
+    /**
+     * @brief Print values in the list
+     *
+     */
+    void print()
+    {
+        std::cout << "[";
+        for (std::uint32_t current = head; current != none; current = nodes[current].next)
+        {
+            std::cout << nodes[current].value;
+            if (nodes[current].next != none)
+                std::cout << ", ";
+        }
+        std::cout << "]\n";
+    }
+
+    /**
+     * @brief Get value at a given index
+     *
+     * @param index The index
+     * @return int& Reference to the value at that index
+     */
+    int &operator[](int index)
+    {
+        check_index_out_of_bounds(index);
+        return nodes[find_node_at_index(index)].value;
+    }
+
+    /**
+     * @brief Add element to the beginning of the list
+     *
+     * @param val The value to be added
+     */
+    void push_front(int val)
+    {
+        std::uint32_t slot = new_node(val, none, head);
+        if (head != none)
+            nodes[head].prev = slot;
+        else
+            tail = slot;
+        head = slot;
+    }
+
+    /***
+     * @brief Add element to index chosen
+     *
+     * @param val The value to be added
+     * @param index The index
+     */
+    void insert(int val, int index)
+    {
+        if (index <= 0)
+        {
+            push_front(val);
+            return;
+        }
+        if (index >= _size)
+        {
+            append(val);
+            return;
+        }
+        std::uint32_t current = find_node_at_index(index);
+        std::uint32_t prev = nodes[current].prev;
+        std::uint32_t slot = new_node(val, prev, current);
+        nodes[prev].next = slot;
+        nodes[current].prev = slot;
+    }
+
+    /**
+     * @brief deletes the element at given index from the list.
+     *
+     * @param index The index.
+     */
+    void remove(int index)
+    {
+        pop(index);
+    }
+
+    /***
+     * @brief removing element at index given
+     *
+     * @param index
+     * @return int the value at that index
+     */
+    int pop(int index)
+    {
+        if (index < 0 || index >= _size)
+        {
+            throw std::out_of_range("Index out of bounds");
+        }
+        std::uint32_t current = find_node_at_index(index);
+        int value = nodes[current].value;
+        erase_node(current);
+        return value;
+    }
+
+    int pop()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int value = nodes[tail].value;
+        erase_node(tail);
+        return value;
+    }
+
+    // The order doesn't matter for min and max, so without free slots they
+    // read the node array front to back instead of following the links
+    int min()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int minimum = nodes[head].value;
+        if (dense())
+        {
+            for (const CompactNode &node : nodes)
+                minimum = std::min(minimum, node.value);
+            return minimum;
+        }
+        for (std::uint32_t current = head; current != none; current = nodes[current].next)
+            minimum = std::min(minimum, nodes[current].value);
+        return minimum;
+    }
+
+    int max()
+    {
+        if (_size == 0)
+        {
+            throw std::out_of_range("List is empty");
+        }
+        int maximum = nodes[head].value;
+        if (dense())
+        {
+            for (const CompactNode &node : nodes)
+                maximum = std::max(maximum, node.value);
+            return maximum;
+        }
+        for (std::uint32_t current = head; current != none; current = nodes[current].next)
+            maximum = std::max(maximum, nodes[current].value);
+        return maximum;
+    }
+
+    /**
+     * @brief Renumber the nodes so that slot i holds element i and drop the
+     * free slots. Afterwards traversals walk the array front to back.
+     *
+     */
+    void compact()
+    {
+        std::vector<CompactNode> ordered;
+        ordered.reserve(_size);
+        std::uint32_t slot = 0;
+        for (std::uint32_t current = head; current != none; current = nodes[current].next)
+        {
+            ordered.push_back({nodes[current].value, slot == 0 ? none : slot - 1, slot + 1});
+            slot++;
+        }
+        if (_size > 0)
+            ordered.back().next = none;
+        nodes.swap(ordered);
+        head = _size > 0 ? 0 : none;
+        tail = _size > 0 ? _size - 1 : none;
+        free_list = none;
+    }
+
+    // Number of node slots, used and free
+    int slot_count()
+    {
+        return nodes.size();
+    }
+};
+
+/**
+ * @brief Epoch-based reclamation for lock-free structures. Threads enter the
+ * domain with a Guard for the length of one operation, and nodes unlinked
+ * during an operation are retired instead of deleted. A retired node is
+ * deleted once the global epoch has moved on twice, because by then every
+ * thread that could still see it has left the domain.
+ *
+ */
+class EpochDomain
+{
+  private:
+    static constexpr std::uint64_t idle = UINT64_MAX;
+    // How many retirements between attempts to move the epoch on
+    static constexpr int advance_interval = 64;
+
+    struct Retired
+    {
+        void *pointer;
+        // Called with the context and the pointer once it is safe
+        void (*reclaim)(void *, void *);
+        void *context;
+    };
+
+    // State of one thread in the domain. Records are never freed while the
+    // domain lives; a thread that exits hands its record to the next one.
+    struct Record
+    {
+        // The epoch the thread is in, or idle
+        std::atomic<std::uint64_t> epoch{idle};
+        std::atomic<bool> owned{true};
+        // Nodes retired by the thread, by epoch modulo 3
+        std::vector<Retired> limbo[3];
+        std::uint64_t limbo_epoch[3] = {0, 0, 0};
+        int retired = 0;
+        Record *next = nullptr;
+    };
+
+    // Shared with the threads that have a record here, so that a record
+    // outlives the domain for as long as its thread holds on to it
+    struct Registry
+    {
+        std::atomic<std::uint64_t> global{0};
+        std::atomic<Record *> records{nullptr};
+
+        ~Registry()
+        {
+            Record *record = records.load();
+            while (record != nullptr)
+            {
+                Record *next = record->next;
+                delete record;
+                record = next;
+            }
+        }
+    };
+
+    // A record held by the current thread, given back when the thread exits
+    struct Registration
+    {
+        std::shared_ptr<Registry> registry;
+        Record *record;
+
+        Registration(std::shared_ptr<Registry> registry, Record *record) : registry(std::move(registry)), record(record)
+        {
+        }
+
+        Registration(Registration &&other) noexcept : registry(std::move(other.registry)), record(other.record)
+        {
+            other.record = nullptr;
+        }
+
+        Registration &operator=(Registration &&other) noexcept
+        {
+            std::swap(registry, other.registry);
+            std::swap(record, other.record);
+            return *this;
+        }
+
+        ~Registration()
+        {
+            if (record != nullptr)
+                record->owned.store(false, std::memory_order_release);
+        }
+    };
+
+    std::shared_ptr<Registry> registry = std::make_shared<Registry>();
+
+    static void free_all(std::vector<Retired> &limbo)
+    {
+        for (Retired &retired : limbo)
+            retired.reclaim(retired.context, retired.pointer);
+        limbo.clear();
+    }
+
+    // The record of the current thread, claimed on its first visit
+    Record *record()
+    {
+        thread_local std::vector<Registration> registrations;
+        for (Registration &registration : registrations)
+        {
+            if (registration.registry == registry)
+                return registration.record;
+        }
+        // Forget domains that no longer exist
+        registrations.erase(std::remove_if(registrations.begin(), registrations.end(),
+                                           [](const Registration &r) { return r.registry.use_count() == 1; }),
+                            registrations.end());
+
+        Record *claimed = nullptr;
+        for (Record *r = registry->records.load(); r != nullptr && claimed == nullptr; r = r->next)
+        {
+            bool owned = false;
+            if (!r->owned.load(std::memory_order_relaxed) && r->owned.compare_exchange_strong(owned, true))
+                claimed = r;
+        }
+        if (claimed == nullptr)
+        {
+            claimed = new Record;
+            claimed->next = registry->records.load();
+            while (!registry->records.compare_exchange_weak(claimed->next, claimed))
+            {
+            }
+        }
+        registrations.emplace_back(registry, claimed);
+        return claimed;
+    }
+
+    // Move the global epoch on if every thread inside the domain has seen it
+    void try_advance()
+    {
+        std::uint64_t epoch = registry->global.load();
+        for (Record *r = registry->records.load(); r != nullptr; r = r->next)
+        {
+            std::uint64_t seen = r->epoch.load();
+            if (seen != idle && seen != epoch)
+                return;
+        }
+        registry->global.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+  public:
+    EpochDomain()
+    {
+    }
+
+    EpochDomain(const EpochDomain &) = delete;
+    EpochDomain &operator=(const EpochDomain &) = delete;
+
+    ~EpochDomain()
+    {
+        reclaim_all();
+    }
+
+    // Reclaim everything still waiting. No thread may be inside the domain.
+    void reclaim_all()
+    {
+        for (Record *r = registry->records.load(); r != nullptr; r = r->next)
+        {
+            for (std::vector<Retired> &limbo : r->limbo)
+                free_all(limbo);
+        }
+    }
+
+    /**
+     * @brief Marks the current thread as inside the domain while it lives.
+     * Nodes reachable while the guard is held are not deleted.
+     *
+     */
+    class Guard
+    {
+        EpochDomain &domain;
+        Record *record;
+
+      public:
+        explicit Guard(EpochDomain &domain) : domain(domain), record(domain.record())
+        {
+            // Announce an epoch that is still current after the announcement
+            std::uint64_t epoch = domain.registry->global.load();
+            while (true)
+            {
+                record->epoch.store(epoch);
+                std::uint64_t now = domain.registry->global.load();
+                if (now == epoch)
+                    break;
+                epoch = now;
+            }
+        }
+
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+        ~Guard()
+        {
+            record->epoch.store(idle, std::memory_order_release);
+        }
+
+        /**
+         * @brief Delete a node once no thread can see it any more
+         *
+         * @param node A node that has been unlinked and can't be reached
+         */
+        template <typename T>
+        void retire(T *node)
+        {
+            retire(node, [](void *, void *p) { delete static_cast<T *>(p); }, nullptr);
+        }
+
+        /**
+         * @brief Hand a node to a reclaim function once no thread can see it
+         * any more, e.g. to put it on a free list
+         *
+         * @param node A node that has been unlinked and can't be reached
+         * @param reclaim Called as reclaim(context, node)
+         * @param context Passed on to reclaim
+         */
+        void retire(void *node, void (*reclaim)(void *, void *), void *context)
+        {
+            std::uint64_t epoch = record->epoch.load(std::memory_order_relaxed);
+            int slot = epoch % 3;
+            // Whatever is in this slot was retired at least three epochs ago
+            if (record->limbo_epoch[slot] != epoch)
+            {
+                free_all(record->limbo[slot]);
+                record->limbo_epoch[slot] = epoch;
+            }
+            record->limbo[slot].push_back({node, reclaim, context});
+            if (++record->retired % advance_interval == 0)
+                domain.try_advance();
+        }
+    };
+};
+
+struct LockFreeNode
+{
+    int value;
+    // The lowest bit marks this node as removed
+    std::atomic<LockFreeNode *> next;
+};
+
+/**
+ * @brief Sorted set of ints that many threads can use at once without locks
+ * (Harris' list with Michael's unlinking). A node is removed by first
+ * marking its next pointer and then unlinking it; threads that find a marked
+ * node on their way help unlink it. Unlinked nodes are reclaimed through an
+ * EpochDomain.
+ *
+ */
+class LockFreeSortedList
+{
+  private:
+    // Sentinel in front of the first node
+    LockFreeNode head{0, {nullptr}};
+    EpochDomain epochs;
+
+    static bool is_marked(LockFreeNode *p)
+    {
+        return reinterpret_cast<std::uintptr_t>(p) & 1;
+    }
+
+    static LockFreeNode *marked(LockFreeNode *p)
+    {
+        return reinterpret_cast<LockFreeNode *>(reinterpret_cast<std::uintptr_t>(p) | 1);
+    }
+
+    static LockFreeNode *unmarked(LockFreeNode *p)
+    {
+        return reinterpret_cast<LockFreeNode *>(reinterpret_cast<std::uintptr_t>(p) & ~std::uintptr_t(1));
+    }
+
+    /**
+     * @brief Find the first node with a value not less than val, unlinking
+     * removed nodes on the way
+     *
+     * @param val The value
+     * @param prev Set to the link that points to the node
+     * @param current Set to the node, null at the end of the list
+     * @return bool True if the node holds val
+     */
+    bool find(int val, std::atomic<LockFreeNode *> *&prev, LockFreeNode *&current, EpochDomain::Guard &guard)
+    {
+    retry:
+        prev = &head.next;
+        current = prev->load();
+        while (current != nullptr)
+        {
+            LockFreeNode *next = current->next.load();
+            if (is_marked(next))
+            {
+                LockFreeNode *expected = current;
+                if (!prev->compare_exchange_strong(expected, unmarked(next)))
+                    goto retry;
+                guard.retire(current);
+                current = unmarked(next);
+                continue;
+            }
+            if (current->value >= val)
+                return current->value == val;
+            prev = &current->next;
+            current = next;
+        }
+        return false;
+    }
+
+  public:
+    LockFreeSortedList()
+    {
+    }
+
+    LockFreeSortedList(const LockFreeSortedList &) = delete;
+    LockFreeSortedList &operator=(const LockFreeSortedList &) = delete;
+
+    // No other thread may use the list any more
+    ~LockFreeSortedList()
+    {
+        LockFreeNode *current = unmarked(head.next.load());
+        while (current != nullptr)
+        {
+            LockFreeNode *next = unmarked(current->next.load());
+            delete current;
+            current = next;
+        }
+    }
+
+    /**
+     * @brief Add a value to the set
+     *
+     * @param val The value
+     * @return bool False if the value was already there
+     */
+    bool insert(int val)
+    {
+        EpochDomain::Guard guard(epochs);
+        LockFreeNode *node = nullptr;
+        while (true)
+        {
+            std::atomic<LockFreeNode *> *prev;
+            LockFreeNode *current;
+            if (find(val, prev, current, guard))
+            {
+                delete node;
+                return false;
+            }
+            if (node == nullptr)
+                node = new LockFreeNode{val, {current}};
+            else
+                node->next.store(current, std::memory_order_relaxed);
+            if (prev->compare_exchange_strong(current, node))
+                return true;
+        }
+    }
+
+    /**
+     * @brief Remove a value from the set
+     *
+     * @param val The value
+     * @return bool False if the value wasn't there
+     */
+    bool remove(int val)
+    {
+        EpochDomain::Guard guard(epochs);
+        while (true)
+        {
+            std::atomic<LockFreeNode *> *prev;
+            LockFreeNode *current;
+            if (!find(val, prev, current, guard))
+                return false;
+            LockFreeNode *next = current->next.load();
+            if (is_marked(next) || !current->next.compare_exchange_strong(next, marked(next)))
+                continue;
+            // The node is removed; unlink it now or leave it to find()
+            LockFreeNode *expected = current;
+            if (prev->compare_exchange_strong(expected, next))
+                guard.retire(current);
+            else
+                find(val, prev, current, guard);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Check if a value is in the set, without writing to the list
+     *
+     * @param val The value
+     * @return bool True if it is there
+     */
+    bool contains(int val)
+    {
+        EpochDomain::Guard guard(epochs);
+        LockFreeNode *current = unmarked(head.next.load());
+        while (current != nullptr && current->value < val)
+            current = unmarked(current->next.load());
+        return current != nullptr && current->value == val && !is_marked(current->next.load());
+    }
+};
+
+struct QueueNode
+{
+    int value;
+    std::atomic<QueueNode *> next;
+};
+
+/**
+ * @brief Queue of ints for many producers and consumers without locks
+ * (Michael and Scott). The head is a dummy node; enqueue links a node after
+ * the last one and swings the tail, dequeue swings the head to the next node
+ * and returns its value. Old dummies are recycled through a free list once
+ * the EpochDomain says no thread can see them.
+ *
+ * A queue made with the single_thread mode may only be used from one thread
+ * at a time and skips the compare-and-swaps and the epochs.
+ *
+ */
+class LockFreeQueue
+{
+  public:
+    enum Mode
+    {
+        concurrent,
+        single_thread
+    };
+
+  private:
+    // Head and tail on their own cache lines, so producers and consumers
+    // don't slow each other down
+    alignas(64) std::atomic<QueueNode *> head;
+    alignas(64) std::atomic<QueueNode *> tail;
+    // Nodes ready for reuse, a stack linked through next
+    alignas(64) std::atomic<QueueNode *> free_nodes{nullptr};
+    std::atomic<long long> allocations{0};
+    Mode mode;
+    EpochDomain epochs;
+
+    // Take a node from the free list, or a new one. In concurrent mode the
+    // caller holds a guard, so a node can't come back to the free list while
+    // another thread is looking at it.
+    QueueNode *new_node(int val)
+    {
+        QueueNode *node = free_nodes.load(std::memory_order_acquire);
+        while (node != nullptr &&
+               !free_nodes.compare_exchange_weak(node, node->next.load(std::memory_order_relaxed),
+                                                 std::memory_order_acquire))
+        {
+        }
+        if (node == nullptr)
+        {
+            node = new QueueNode;
+            allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        node->value = val;
+        node->next.store(nullptr, std::memory_order_relaxed);
+        return node;
     }
 
-    // Slett den gjeldende noden
-    delete current;
-    _size--;
-}
-
-
-    /***
-     * @brief removing element at index given
-     * 
-     * @param index
-     * @return int the value at that index
-    */
-int pop(int index)
-{
-    if (index < 0 || index >= _size)
+    static void recycle(void *queue, void *pointer)
     {
-        throw std::out_of_range("Index out of bounds");
+        LockFreeQueue *self = static_cast<LockFreeQueue *>(queue);
+        QueueNode *node = static_cast<QueueNode *>(pointer);
+        QueueNode *top = self->free_nodes.load(std::memory_order_relaxed);
+        do
+        {
+            node->next.store(top, std::memory_order_relaxed);
+        } while (!self->free_nodes.compare_exchange_weak(top, node, std::memory_order_release));
     }
 
-    Node *current = find_node_at_index(index);
-    int value = current->value;
-    remove(index);
-    return value;
-}
+    static void delete_chain(QueueNode *node)
+    {
+        while (node != nullptr)
+        {
+            QueueNode *next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
 
-int pop()
-{
-    if (_size == 0)
+  public:
+    explicit LockFreeQueue(Mode mode = concurrent) : mode(mode)
     {
-        throw std::out_of_range("List is empty");
+        QueueNode *dummy = new QueueNode{0, {nullptr}};
+        allocations.store(1);
+        head.store(dummy);
+        tail.store(dummy);
     }
 
-    int value = tail->value;
-    remove(_size - 1);
-    return value;
-}
+    LockFreeQueue(const LockFreeQueue &) = delete;
+    LockFreeQueue &operator=(const LockFreeQueue &) = delete;
 
+    // No other thread may use the queue any more
+    ~LockFreeQueue()
+    {
+        epochs.reclaim_all();
+        delete_chain(head.load());
+        delete_chain(free_nodes.load());
+    }
 
-    int min()
+    /**
+     * @brief Add a value at the back of the queue
+     *
+     * @param val The value
+     */
+    void enqueue(int val)
     {
-        if (_size == 0)
+        if (mode == single_thread)
         {
-            throw std::out_of_range("List is empty");
+            QueueNode *node = new_node(val);
+            tail.load(std::memory_order_relaxed)->next.store(node, std::memory_order_relaxed);
+            tail.store(node, std::memory_order_relaxed);
+            return;
         }
 
-        int minimum = head->value;
-        Node *current = head->next;
-
-        while (current != nullptr)
+        EpochDomain::Guard guard(epochs);
+        QueueNode *node = new_node(val);
+        while (true)
         {
-            if (current->value < minimum)
+            QueueNode *last = tail.load();
+            QueueNode *next = last->next.load();
+            if (last != tail.load())
+                continue;
+            if (next != nullptr)
             {
-                minimum = current->value;
+                // The tail is behind; help move it on
+                tail.compare_exchange_weak(last, next);
+                continue;
+            }
+            if (last->next.compare_exchange_weak(next, node))
+            {
+                tail.compare_exchange_strong(last, node);
+                return;
             }
-            current = current->next;
         }
-
-        return minimum;
     }
 
-    int max()
+    /**
+     * @brief Take the value at the front of the queue
+     *
+     * @param val Set to the value
+     * @return bool False if the queue was empty
+     */
+    bool dequeue(int &val)
     {
-        if (_size == 0)
+        if (mode == single_thread)
         {
-            throw std::out_of_range("List is empty");
+            QueueNode *first = head.load(std::memory_order_relaxed);
+            QueueNode *next = first->next.load(std::memory_order_relaxed);
+            if (next == nullptr)
+                return false;
+            val = next->value;
+            head.store(next, std::memory_order_relaxed);
+            recycle(this, first);
+            return true;
         }
 
-        int maximum = head->value;
-        Node *current = head->next;
-
-        while (current != nullptr)
+        EpochDomain::Guard guard(epochs);
+        while (true)
         {
-            if (current->value > maximum)
+            QueueNode *first = head.load();
+            QueueNode *last = tail.load();
+            QueueNode *next = first->next.load();
+            if (first != head.load())
+                continue;
+            if (first == last)
             {
-                maximum = current->value;
+                if (next == nullptr)
+                    return false;
+                tail.compare_exchange_weak(last, next);
+                continue;
+            }
+            // Read the value before another consumer can recycle the node
+            int value = next->value;
+            if (head.compare_exchange_weak(first, next))
+            {
+                val = value;
+                guard.retire(first, recycle, this);
+                return true;
             }
-            current = current->next;
         }
-
-        return maximum;
     }
 
-    // Test functions
-    void test_min()
+    // Check if the queue is empty; may be stale as soon as it returns
+    bool empty()
     {
-        if (_size == 0)
-        {
-            throw std::out_of_range("List is empty");
-        }
-
-        int minValue = min();
-        std::cout << "The minimum value in the list is: " << minValue << " - Success!\n";
+        return head.load()->next.load() == nullptr;
     }
 
-    void test_max()
+    // Number of nodes taken from the heap; the rest were recycled
+    long long node_allocations()
     {
-        if (_size == 0)
-        {
-            throw std::out_of_range("List is empty");
-        }
-
-        int maxValue = max();
-        std::cout << "The maximum value in the list is: " << maxValue << " - Success!\n";
+        return allocations.load(std::memory_order_relaxed);
     }
-
 };
 
 
@@ -546,6 +3274,609 @@ void test_pop()
 }
 
 
+/**
+ * @brief Test that removed nodes are reused and that lists
+ * can share a pool
+ */
+void test_node_pool()
+{
+    std::cout << "Testing node pool";
+    LinkedList ll{};
+    for (int i = 0; i < 1000; i++)
+        ll.append(i);
+    std::shared_ptr<NodePool> pool = ll.pool();
+    int chunks = pool->chunk_count();
+    for (int i = 0; i < 500; i++)
+        ll.pop(0);
+    for (int i = 0; i < 500; i++)
+        ll.push_front(i);
+    assert(pool->chunk_count() == chunks);
+    assert(pool->recycle_count() == 500);
+    assert(ll.length() == 1000);
+    assert(ll[0] == 499);
+    assert(ll[999] == 999);
+
+    {
+        LinkedList other{pool};
+        for (int i = 0; i < 10; i++)
+            other.append(i);
+        assert(other.length() == 10);
+        assert(pool->recycle_count() == 500);
+    }
+    ll.append(42);
+    assert(pool->recycle_count() == 501);
+    assert(ll[1000] == 42);
+
+    // Lists with their own pools can pass nodes back and forth; the pools
+    // keep each other's chunks alive without holding on to each other
+    LinkedList a{};
+    LinkedList b{};
+    for (int round = 0; round < 20000; round++)
+    {
+        LinkedList &from = round % 2 == 0 ? b : a;
+        LinkedList &to = round % 2 == 0 ? a : b;
+        from.append(round);
+        to.concat(from);
+    }
+    assert(a.length() == 0 && b.length() == 20000);
+    int expected = 0;
+    for (int value : b)
+        assert(value == expected++);
+    std::cout << " - Success!\n";
+}
+
+/**
+ * @brief Test indexed access in different orders while the list
+ * changes, so lookups start from the head, the tail and the finger
+ */
+void test_finger_lookups()
+{
+    std::cout << "Testing finger lookups";
+    LinkedList ll{};
+    std::vector<int> expected;
+    for (int i = 0; i < 200; i++)
+    {
+        ll.append(i);
+        expected.push_back(i);
+    }
+    for (int i = 0; i < 200; i++)
+        assert(ll[i] == expected[i]);
+    for (int i = 199; i >= 0; i -= 3)
+        assert(ll[i] == expected[i]);
+
+    for (int i = 10; i < 60; i += 2)
+    {
+        assert(ll[i] == expected[i]);
+        ll.insert(-i, i);
+        expected.insert(expected.begin() + i, -i);
+        assert(ll[i + 1] == expected[i + 1]);
+        assert(ll.pop(i + 2) == expected[i + 2]);
+        expected.erase(expected.begin() + i + 2);
+        ll.push_front(i);
+        expected.insert(expected.begin(), i);
+        assert(ll[i] == expected[i]);
+        ll.remove(0);
+        expected.erase(expected.begin());
+        assert(ll.pop() == expected.back());
+        expected.pop_back();
+    }
+    assert(ll.length() == (int)expected.size());
+    for (int i = 0; i < ll.length(); i++)
+        assert(ll[i] == expected[i]);
+    while (ll.length() > 0)
+        ll.pop(ll.length() / 2);
+    ll.append(1);
+    assert(ll[0] == 1);
+    std::cout << " - Success!\n";
+}
+
+/**
+ * @brief Test iterating with range-for and algorithms, and editing
+ * through iterators
+ */
+void test_iterators()
+{
+    std::cout << "Testing iterators";
+    LinkedList ll{{4, 1, 3}};
+    int sum = 0;
+    for (int value : ll)
+        sum += value;
+    assert(sum == 8);
+    assert(*std::find(ll.begin(), ll.end(), 3) == 3);
+    assert(*std::max_element(ll.begin(), ll.end()) == 4);
+
+    LinkedList::iterator it = ll.end();
+    assert(*--it == 3);
+    assert(*--it == 1);
+    std::vector<int> reversed(std::make_reverse_iterator(ll.end()), std::make_reverse_iterator(ll.begin()));
+    assert((reversed == std::vector<int>{3, 1, 4}));
+
+    const LinkedList &constant = ll;
+    LinkedList::const_iterator cit = constant.begin();
+    assert(cit == ll.begin());
+    assert(*cit == 4);
+
+    it = ll.insert_before(std::next(ll.begin()), 2);
+    assert(*it == 2 && ll[1] == 2 && ll.length() == 4);
+    ll.insert_before(ll.begin(), 0);
+    ll.insert_before(ll.end(), 5);
+    assert(ll[0] == 0 && ll[5] == 5);
+
+    // Remove the odd values in one pass
+    LinkedList filtered{};
+    for (int i = 0; i < 1000; i++)
+        filtered.append(i);
+    for (LinkedList::iterator p = filtered.begin(); p != filtered.end();)
+    {
+        if (*p % 2 == 1)
+            p = filtered.erase(p);
+        else
+            ++p;
+    }
+    assert(filtered.length() == 500);
+    assert(filtered[0] == 0 && filtered[499] == 998);
+    assert(filtered.pop() == 998);
+    std::cout << " - Success!\n";
+}
+
+/**
+ * @brief Test moving nodes between lists with splice, concat and
+ * split_at, also between lists with different pools
+ */
+void test_splice_split_concat()
+{
+    std::cout << "Testing splice, split and concat";
+    LinkedList a{{1, 2, 3}};
+    LinkedList b{{10, 11}};
+    a.splice(std::next(a.begin()), b);
+    assert(b.length() == 0);
+    assert(a.length() == 5);
+    std::vector<int> values(a.begin(), a.end());
+    assert((values == std::vector<int>{1, 10, 11, 2, 3}));
+
+    LinkedList c{{0}};
+    assert(c[0] == 0);
+    c.splice(c.begin(), a);
+    assert(c.length() == 6 && c[0] == 1 && c[5] == 0);
+    c.concat(b);
+    assert(c.length() == 6);
+
+    LinkedList rest = c.split_at(2);
+    assert(c.length() == 2 && rest.length() == 4);
+    values.assign(c.begin(), c.end());
+    assert((values == std::vector<int>{1, 10}));
+    values.assign(rest.begin(), rest.end());
+    assert((values == std::vector<int>{11, 2, 3, 0}));
+    assert(c.pop() == 10 && rest.pop(0) == 11);
+
+    LinkedList empty = rest.split_at(0);
+    assert(rest.length() == 0 && empty.length() == 3);
+    assert(rest.split_at(0).length() == 0);
+
+    // The nodes from a and b must outlive the lists they came from
+    LinkedList d{};
+    {
+        LinkedList e{};
+        for (int i = 0; i < 1000; i++)
+            e.append(i);
+        d.concat(e);
+        d.push_front(-1);
+    }
+    for (int i = 0; i < 500; i++)
+        d.pop();
+    for (int i = 0; i < 500; i++)
+        d.append(i);
+    assert(d.length() == 1001 && d[0] == -1 && d[1000] == 499);
+
+    LinkedList moved = std::move(d);
+    assert(d.length() == 0 && moved.length() == 1001);
+    d = std::move(moved);
+    assert(d[500] == 499);
+    std::cout << " - Success!\n";
+}
+
+/**
+ * @brief Test sorting in place against std::sort, and merging sorted
+ * lists
+ */
+void test_sort_and_merge()
+{
+    std::cout << "Testing sort and merge";
+    LinkedList empty{};
+    empty.sort();
+    assert(empty.length() == 0);
+
+    for (int n : {1, 2, 3, 17, 1000})
+    {
+        LinkedList ll{};
+        std::vector<int> expected;
+        unsigned seed = n;
+        for (int i = 0; i < n; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            ll.append((seed >> 8) % 100);
+            expected.push_back((seed >> 8) % 100);
+        }
+        ll.sort();
+        std::sort(expected.begin(), expected.end());
+        std::vector<int> values(ll.begin(), ll.end());
+        assert(values == expected);
+        std::vector<int> reversed(std::make_reverse_iterator(ll.end()), std::make_reverse_iterator(ll.begin()));
+        assert(std::equal(reversed.rbegin(), reversed.rend(), expected.begin()));
+        assert(ll.length() == n);
+        assert(ll[n - 1] == expected.back());
+    }
+
+    LinkedList a{{1, 3, 5, 5, 9}};
+    LinkedList b{{0, 2, 5, 10}};
+    a.merge(b);
+    assert(b.length() == 0 && a.length() == 9);
+    std::vector<int> values(a.begin(), a.end());
+    assert((values == std::vector<int>{0, 1, 2, 3, 5, 5, 5, 9, 10}));
+    a.append(11);
+    assert(a.pop() == 11 && a.pop() == 10);
+    LinkedList c{};
+    c.merge(a);
+    assert(c.length() == 8 && c[0] == 0 && c[7] == 9);
+    std::cout << " - Success!\n";
+}
+
+/**
+ * @brief Test the unrolled list against a vector through enough inserts
+ * and removes to split and merge nodes
+ */
+void test_unrolled_linked_list()
+{
+    std::cout << "Testing unrolled linked list";
+    UnrolledLinkedList ul{{1, 2, 3}};
+    assert(ul.length() == 3);
+    assert(ul[2] == 3);
+
+    std::vector<int> expected{1, 2, 3};
+    unsigned seed = 7;
+    for (int step = 0; step < 5000; step++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int r = (seed >> 8) % 1000;
+        if (r < 600 || expected.empty())
+        {
+            int index = r % (expected.size() + 1);
+            ul.insert(step, index);
+            expected.insert(expected.begin() + index, step);
+        }
+        else
+        {
+            int index = r % expected.size();
+            assert(ul.pop(index) == expected[index]);
+            expected.erase(expected.begin() + index);
+        }
+    }
+    assert(ul.length() == (int)expected.size());
+    for (int i = 0; i < ul.length(); i++)
+        assert(ul[i] == expected[i]);
+    assert(ul.min() == *std::min_element(expected.begin(), expected.end()));
+    assert(ul.max() == *std::max_element(expected.begin(), expected.end()));
+
+    while (ul.length() > 0)
+        ul.pop();
+    ul.push_front(4);
+    ul.append(5);
+    assert(ul[0] == 4 && ul[1] == 5);
+
+    bool throwed_range_error = false;
+    try
+    {
+        ul[2];
+    }
+    catch (const std::range_error &e)
+    {
+        throwed_range_error = true;
+    }
+    assert(throwed_range_error);
+    std::cout << " - Success!\n";
+}
+
+/**
+ * @brief Test the skip list against a vector with inserts and
+ * removes at random positions
+ */
+void test_skip_list()
+{
+    std::cout << "Testing skip list";
+    SkipList sl{{1, 2, 3}};
+    assert(sl.length() == 3);
+    assert(sl[0] == 1 && sl[2] == 3);
+
+    std::vector<int> expected{1, 2, 3};
+    unsigned seed = 11;
+    for (int step = 0; step < 5000; step++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int r = (seed >> 8) % 1000;
+        if (r < 600 || expected.empty())
+        {
+            int index = r % (expected.size() + 1);
+            sl.insert(step, index);
+            expected.insert(expected.begin() + index, step);
+        }
+        else
+        {
+            int index = r % expected.size();
+            assert(sl.pop(index) == expected[index]);
+            expected.erase(expected.begin() + index);
+        }
+    }
+    assert(sl.length() == (int)expected.size());
+    for (int i = 0; i < sl.length(); i++)
+        assert(sl[i] == expected[i]);
+    assert(sl.min() == *std::min_element(expected.begin(), expected.end()));
+    assert(sl.max() == *std::max_element(expected.begin(), expected.end()));
+
+    while (sl.length() > 0)
+        sl.pop();
+    sl.push_front(4);
+    sl.append(5);
+    sl.insert(6, 1);
+    sl.remove(0);
+    assert(sl[0] == 6 && sl[1] == 5);
+
+    bool throwed_range_error = false;
+    try
+    {
+        sl[2];
+    }
+    catch (const std::range_error &e)
+    {
+        throwed_range_error = true;
+    }
+    assert(throwed_range_error);
+    std::cout << " - Success!\n";
+}
+
+/**
+ * @brief Test the B+tree against a vector with enough inserts and
+ * removes at random positions to split, merge and rebalance nodes,
+ * checking min and max along the way
+ */
+void test_counted_btree()
+{
+    std::cout << "Testing counted B+tree";
+    CountedBTree bt{{3, 1, 2}};
+    assert(bt.length() == 3);
+    assert(bt.min() == 1 && bt.max() == 3);
+
+    std::vector<int> expected{3, 1, 2};
+    unsigned seed = 5;
+    for (int step = 0; step < 40000; step++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int r = (seed >> 8) % 100000;
+        // Grow the tree for the first half, then shrink it again
+        if ((step < 20000 ? r < 70000 : r < 30000) || expected.empty())
+        {
+            int index = r % (expected.size() + 1);
+            bt.insert(r, index);
+            expected.insert(expected.begin() + index, r);
+        }
+        else
+        {
+            int index = r % expected.size();
+            assert(bt.pop(index) == expected[index]);
+            expected.erase(expected.begin() + index);
+        }
+        if (step % 1000 == 0 && !expected.empty())
+        {
+            assert(bt.min() == *std::min_element(expected.begin(), expected.end()));
+            assert(bt.max() == *std::max_element(expected.begin(), expected.end()));
+            for (int i = 0; i < bt.length(); i++)
+                assert(bt[i] == expected[i]);
+        }
+    }
+    assert(bt.length() == (int)expected.size());
+    for (int i = 0; i < bt.length(); i++)
+        assert(bt[i] == expected[i]);
+
+    // Writes keep min and max up to date, also when the old extreme goes
+    CountedBTree written{};
+    for (int i = 0; i < 5000; i++)
+        written.append(i);
+    written.set(2500, 1000000);
+    assert(written[2500] == 1000000 && written.max() == 1000000);
+    written.set(0, -5);
+    assert(written[0] == -5 && written.min() == -5);
+    written.set(2500, 7);
+    written.set(0, 3);
+    assert(written.min() == 1 && written.max() == 4999);
+
+    CountedBTree small{{1, 2, 3}};
+    small.set(0, 100);
+    assert(small.max() == 100);
+    small.set(1, -5);
+    assert(small.min() == -5);
+
+    while (bt.length() > 0)
+        bt.pop();
+    bt.push_front(4);
+    bt.append(5);
+    bt.remove(0);
+    assert(bt[0] == 5 && bt.min() == 5 && bt.max() == 5);
+
+    bool throwed_range_error = false;
+    try
+    {
+        bt[1];
+    }
+    catch (const std::range_error &e)
+    {
+        throwed_range_error = true;
+    }
+    assert(throwed_range_error);
+    std::cout << " - Success!\n";
+}
+
+/**
+ * @brief Test the compact list against a vector, that free slots
+ * are reused, and that compact() keeps the order
+ */
+void test_compact_linked_list()
+{
+    std::cout << "Testing compact linked list";
+    CompactLinkedList cl{{1, 2, 3}};
+    assert(cl.length() == 3);
+    assert(cl[0] == 1 && cl[2] == 3);
+
+    std::vector<int> expected{1, 2, 3};
+    unsigned seed = 3;
+    for (int step = 0; step < 5000; step++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int r = (seed >> 8) % 1000;
+        if (r < 550 || expected.empty())
+        {
+            int index = r % (expected.size() + 1);
+            cl.insert(r, index);
+            expected.insert(expected.begin() + index, r);
+        }
+        else
+        {
+            int index = r % expected.size();
+            assert(cl.pop(index) == expected[index]);
+            expected.erase(expected.begin() + index);
+        }
+    }
+    assert(cl.length() == (int)expected.size());
+    assert(cl.slot_count() < (int)expected.size() + 500);
+    assert(cl.min() == *std::min_element(expected.begin(), expected.end()));
+    assert(cl.max() == *std::max_element(expected.begin(), expected.end()));
+
+    cl.compact();
+    assert(cl.slot_count() == cl.length());
+    for (int i = 0; i < cl.length(); i++)
+        assert(cl[i] == expected[i]);
+    assert(cl.min() == *std::min_element(expected.begin(), expected.end()));
+    assert(cl.max() == *std::max_element(expected.begin(), expected.end()));
+
+    while (cl.length() > 0)
+        cl.pop();
+    cl.compact();
+    cl.push_front(4);
+    cl.append(5);
+    assert(cl[0] == 4 && cl[1] == 5);
+    std::cout << " - Success!\n";
+}
+
+/**
+ * @brief Test the lock-free list from one thread, then let several
+ * threads insert and remove their own values and check the result
+ */
+void test_lock_free_sorted_list()
+{
+    std::cout << "Testing lock-free sorted list";
+    LockFreeSortedList set{};
+    assert(!set.contains(1));
+    assert(set.insert(3) && set.insert(1) && set.insert(2));
+    assert(!set.insert(2));
+    assert(set.contains(1) && set.contains(2) && set.contains(3));
+    assert(set.remove(2) && !set.remove(2));
+    assert(!set.contains(2) && set.contains(3));
+
+    int threads = 4;
+    int per_thread = 2000;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&set, t, threads, per_thread] {
+            // Each thread owns the values v with v % threads == t
+            for (int i = 0; i < per_thread; i++)
+                assert(set.insert(100 + i * threads + t));
+            for (int i = 0; i < per_thread; i += 2)
+                assert(set.remove(100 + i * threads + t));
+            for (int i = 0; i < per_thread; i++)
+                assert(set.contains(100 + i * threads + t) == (i % 2 == 1));
+        });
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+    for (int i = 0; i < per_thread * threads; i++)
+        assert(set.contains(100 + i) == ((i / threads) % 2 == 1));
+    std::cout << " - Success!\n";
+}
+
+/**
+ * @brief Test the queue in both modes, that nodes are recycled, and
+ * that every value put in by several producers comes out exactly once
+ */
+void test_lock_free_queue()
+{
+    std::cout << "Testing lock-free queue";
+    for (LockFreeQueue::Mode mode : {LockFreeQueue::concurrent, LockFreeQueue::single_thread})
+    {
+        LockFreeQueue queue{mode};
+        int value;
+        assert(queue.empty() && !queue.dequeue(value));
+        for (int round = 0; round < 100; round++)
+        {
+            for (int i = 0; i < 10; i++)
+                queue.enqueue(round * 10 + i);
+            for (int i = 0; i < 10; i++)
+            {
+                assert(queue.dequeue(value));
+                assert(value == round * 10 + i);
+            }
+        }
+        assert(!queue.dequeue(value));
+        if (mode == LockFreeQueue::single_thread)
+            assert(queue.node_allocations() <= 11);
+    }
+
+    LockFreeQueue queue{};
+    int producers = 3;
+    int consumers = 3;
+    int per_producer = 20000;
+    std::vector<std::atomic<int>> seen(producers * per_producer);
+    std::atomic<int> taken{0};
+    std::vector<std::thread> workers;
+    for (int p = 0; p < producers; p++)
+    {
+        workers.emplace_back([&queue, p, per_producer] {
+            for (int i = 0; i < per_producer; i++)
+                queue.enqueue(p * per_producer + i);
+        });
+    }
+    for (int c = 0; c < consumers; c++)
+    {
+        workers.emplace_back([&queue, &seen, &taken, producers, per_producer] {
+            int value;
+            int last[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
+            while (taken.load() < producers * per_producer)
+            {
+                if (!queue.dequeue(value))
+                    continue;
+                taken++;
+                seen[value]++;
+                // Values of one producer come out in order
+                assert(value > last[value / per_producer]);
+                last[value / per_producer] = value;
+            }
+        });
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+    for (std::atomic<int> &count : seen)
+        assert(count.load() == 1);
+
+    // Once the epochs move on, dequeued nodes come back for new values
+    long long allocations = queue.node_allocations();
+    int value;
+    for (int i = 0; i < 10000; i++)
+    {
+        queue.enqueue(i);
+        assert(queue.dequeue(value) && value == i);
+    }
+    assert(queue.node_allocations() - allocations < 1000);
+    std::cout << " - Success!\n";
+}
+
 /**
  * @brief Test that we can construct a LinkedList
  * from a vector of integers
@@ -574,6 +3905,17 @@ int main()
     test_pop_at_index();
     test_pop();
     test_vector_constructor();
+    test_node_pool();
+    test_unrolled_linked_list();
+    test_finger_lookups();
+    test_iterators();
+    test_splice_split_concat();
+    test_sort_and_merge();
+    test_lock_free_sorted_list();
+    test_lock_free_queue();
+    test_skip_list();
+    test_counted_btree();
+    test_compact_linked_list();
     return 0;
 }
 
@@ -150,3 +150,592 @@ void test_max() {
     assert(a.max() == 10); // The largest element is 10.
 }
 
+
+void test_double_elements() {
+    ArrayList<double> a{{1.5, 2.5}};
+    a.insert(0.5, 0);
+    a.append(3.5);
+    assert(a.length() == 4);
+    assert(a[0] == 0.5);
+    assert(a[3] == 3.5);
+    assert(a.max() == 3.5);
+    assert(a.argmin() == 0);
+    assert(a.pop(1) == 1.5);
+    assert(a[1] == 2.5);
+}
+
+struct Point {
+    int x;
+    int y;
+};
+
+void test_trivially_copyable_struct_elements() {
+    ArrayList<Point> a{};
+    for (int i = 0; i < 10; i++) {
+        a.insert(Point{i, -i}, 0);
+    }
+    assert(a.length() == 10);
+    assert(a[0].x == 9);
+    assert(a[9].y == 0);
+    a.remove(0);
+    assert(a[0].x == 8);
+    assert(a.pop(8).x == 0);
+    assert(a.length() == 8);
+}
+
+void test_non_trivial_elements() {
+    ArrayList<std::string> a{};
+    for (int i = 0; i < 20; i++) {
+        a.insert(std::to_string(i), 0);
+    }
+    assert(a.length() == 20);
+    assert(a[0] == "19");
+    assert(a[19] == "0");
+    a.insert("middle", 10);
+    assert(a[10] == "middle");
+    assert(a[11] == "9");
+    assert(a.pop(10) == "middle");
+    for (int i = 0; i < 15; i++) {
+        a.remove(0);
+    }
+    assert(a.length() == 5);
+    assert(a[0] == "4");
+    assert(a.pop() == "0");
+    assert(a.count("2") == 1);
+}
+
+void test_growth_policy_one_and_a_half() {
+    ArrayList a{GrowthPolicy::one_and_a_half()};
+    for (int i = 0; i < 10; i++) {
+        a.append(i);
+    }
+    // 1 -> 2 -> 3 -> 4 -> 6 -> 9 -> 13
+    assert(a.capacity() == 13);
+    assert(a[9] == 9);
+}
+
+void test_growth_policy_custom() {
+    ArrayList a{GrowthPolicy::custom([](int capacity) { return capacity + 4; })};
+    for (int i = 0; i < 10; i++) {
+        a.append(i);
+    }
+    assert(a.capacity() == 13);
+}
+
+void test_growth_policy_no_shrink() {
+    ArrayList a{GrowthPolicy::no_shrink()};
+    for (int i = 0; i < 10; i++) {
+        a.append(i);
+    }
+    for (int i = 0; i < 10; i++) {
+        a.pop();
+    }
+    assert(a.length() == 0);
+    assert(a.capacity() == 16);
+}
+
+void test_growth_policy_hysteresis() {
+    ArrayList a{GrowthPolicy::hysteresis()};
+    for (int i = 0; i < 16; i++) {
+        a.append(i);
+    }
+    assert(a.capacity() == 16);
+    for (int i = 0; i < 13; i++) {
+        a.pop();
+    }
+    // Shrinks to twice the size instead of a tight fit
+    assert(a.capacity() == 8);
+    a.append(3);
+    a.append(4);
+    assert(a.capacity() == 8);
+}
+
+void test_growth_policy_min_capacity() {
+    GrowthPolicy policy;
+    policy.min_capacity = 8;
+    ArrayList a{policy};
+    a.append(0);
+    assert(a.capacity() == 8);
+    for (int i = 1; i < 9; i++) {
+        a.append(i);
+    }
+    assert(a.capacity() == 16);
+    for (int i = 0; i < 9; i++) {
+        a.pop();
+    }
+    assert(a.capacity() == 8);
+}
+
+void test_simd_kernels_match_scalar() {
+    // Few distinct values, so there are plenty of ties
+    std::vector<int> values;
+    for (int i = 0; i < 200; i++) {
+        values.push_back((i * 37) % 11 - 5);
+    }
+    simd::Kernels scalar = simd::kernels_for(simd::Isa::scalar);
+    for (simd::Isa isa : {simd::Isa::sse41, simd::Isa::avx2, simd::Isa::avx512}) {
+        if (!simd::supported(isa)) {
+            continue;
+        }
+        simd::Kernels k = simd::kernels_for(isa);
+        for (int n = 1; n <= 200; n++) {
+            const int* data = values.data() + 200 - n;
+            assert(k.min(data, n) == scalar.min(data, n));
+            assert(k.max(data, n) == scalar.max(data, n));
+            assert(k.argmin(data, n) == scalar.argmin(data, n));
+            assert(k.argmax(data, n) == scalar.argmax(data, n));
+            assert(k.count(data, n, 3) == scalar.count(data, n, 3));
+        }
+    }
+}
+
+void test_argmin_argmax_return_first_index_on_ties() {
+    ArrayList a{};
+    for (int i = 0; i < 100; i++) {
+        a.append(i % 2 == 0 ? 7 : 3);
+    }
+    a[40] = 1;
+    a[73] = 1;
+    a[41] = 9;
+    a[90] = 9;
+    assert(a.argmin() == 40);
+    assert(a.argmax() == 41);
+    assert(a.min() == 1);
+    assert(a.max() == 9);
+    assert(a.count(1) == 2);
+}
+
+void test_parallel_reductions_match_serial() {
+    ThreadPool pool(4);
+    ParallelPolicy policy;
+    policy.min_chunk = 10;
+    policy.pool = &pool;
+
+    ArrayList a{};
+    for (int i = 0; i < 1000; i++) {
+        a.append((i * 37) % 101);
+    }
+    assert(policy.chunks(a.length()) == 4);
+    assert(a.count(5, policy) == a.count(5));
+    assert(a.min(policy) == a.min());
+    assert(a.max(policy) == a.max());
+    assert(a.argmin(policy) == a.argmin());
+    assert(a.argmax(policy) == a.argmax());
+
+    ArrayList<double> b{{2.5, 1.5, 3.5, 1.5, 3.5}};
+    policy.min_chunk = 1;
+    assert(b.argmin(policy) == 1);
+    assert(b.argmax(policy) == 2);
+    assert(b.count(3.5, policy) == 2);
+}
+
+void test_parallel_reductions_fall_back_to_serial() {
+    ParallelPolicy policy;
+    assert(policy.chunks(1000) == 1);
+    ArrayList a{{4, 1, 4}};
+    assert(a.count(4, policy) == 2);
+    assert(a.argmin(policy) == 1);
+}
+
+void test_circular_insert_and_pop_front() {
+    CircularArrayList a{};
+    for (int i = 0; i < 10; i++) {
+        a.insert(i, 0);
+    }
+    assert(a.length() == 10);
+    assert(a.capacity() == 16);
+    for (int i = 0; i < 10; i++) {
+        assert(a[i] == 9 - i);
+    }
+    assert(a.pop(0) == 9);
+    a.remove(0);
+    assert(a[0] == 7);
+    assert(a.get(7) == 0);
+    a.append(-1);
+    assert(a[8] == -1);
+}
+
+void test_circular_wrapped_middle_edits() {
+    CircularArrayList<std::string> a{};
+    std::vector<std::string> expected;
+    for (int i = 0; i < 40; i++) {
+        int index = (i * 7) % (expected.size() + 1);
+        a.insert(std::to_string(i), index);
+        expected.insert(expected.begin() + index, std::to_string(i));
+        if (i % 3 == 0) {
+            a.append("x");
+            expected.push_back("x");
+            a.push_front("y");
+            expected.insert(expected.begin(), "y");
+        }
+    }
+    for (int i = 0; i < 30; i++) {
+        int index = (i * 5) % expected.size();
+        assert(a.pop(index) == expected[index]);
+        expected.erase(expected.begin() + index);
+    }
+    assert(a.length() == (int)expected.size());
+    for (int i = 0; i < a.length(); i++) {
+        assert(a[i] == expected[i]);
+    }
+}
+
+void test_circular_scans_across_wrap() {
+    CircularArrayList a{};
+    for (int i = 0; i < 20; i++) {
+        a.append(i % 5);
+    }
+    for (int i = 0; i < 20; i++) {
+        a.pop(0);
+        a.append(7);
+    }
+    a.push_front(-3);
+    // Index 15 sits in the wrapped part of the buffer
+    a[15] = -3;
+    a[16] = 9;
+    assert(a.min() == -3);
+    assert(a.argmin() == 0);
+    assert(a.max() == 9);
+    assert(a.argmax() == 16);
+    assert(a.count(7) == 18);
+}
+
+void test_tiered_vector_matches_vector() {
+    TieredVector a{};
+    std::vector<int> expected;
+    // Enough elements to force a few rebuilds with bigger blocks
+    for (int i = 0; i < 3000; i++) {
+        int index = (i * 7919) % (expected.size() + 1);
+        a.insert(i, index);
+        expected.insert(expected.begin() + index, i);
+    }
+    assert(a.block_size() > 16);
+    for (int i = 0; i < 2500; i++) {
+        int index = (i * 104729) % expected.size();
+        if (i % 2 == 0) {
+            assert(a.pop(index) == expected[index]);
+        } else {
+            a.remove(index);
+        }
+        expected.erase(expected.begin() + index);
+    }
+    assert(a.length() == (int)expected.size());
+    for (int i = 0; i < a.length(); i++) {
+        assert(a[i] == expected[i]);
+        assert(a.get(i) == expected[i]);
+    }
+    assert(a.min() == *std::min_element(expected.begin(), expected.end()));
+    assert(a.argmax() == std::max_element(expected.begin(), expected.end()) - expected.begin());
+}
+
+void test_tiered_vector_first_index_on_ties() {
+    TieredVector a{};
+    for (int i = 0; i < 100; i++) {
+        a.insert(5, 0);
+    }
+    a[70] = 1;
+    a[90] = 1;
+    a[20] = 8;
+    a[21] = 8;
+    assert(a.argmin() == 70);
+    assert(a.argmax() == 20);
+    assert(a.count(5) == 96);
+    assert(a.pop() == 5);
+    assert(a.length() == 99);
+}
+
+void test_gap_buffer_cursor_edits() {
+    GapBuffer<std::string> a{{"a", "b", "c"}};
+    a.insert("x", 1);
+    a.insert("y", 2);
+    assert(a.cursor() == 3);
+    a.remove(2);
+    a.insert("z", 0);
+    assert(a.length() == 5);
+    assert(a[0] == "z");
+    assert(a[1] == "a");
+    assert(a[2] == "x");
+    assert(a[3] == "b");
+    assert(a.get(4) == "c");
+    a.append("d");
+    assert(a.pop() == "d");
+    assert(a.pop(0) == "z");
+    assert(a.count("x") == 1);
+}
+
+void test_gap_buffer_matches_vector() {
+    GapBuffer a{};
+    std::vector<int> expected;
+    int cursor = 0;
+    for (int i = 0; i < 2000; i++) {
+        // Mostly type at the cursor, sometimes delete or jump a little
+        if (i % 7 == 3 && cursor > 0) {
+            cursor--;
+            assert(a.pop(cursor) == expected[cursor]);
+            expected.erase(expected.begin() + cursor);
+        } else if (i % 11 == 5) {
+            cursor = (cursor * 3 + i) % (expected.size() + 1);
+        } else {
+            a.insert(i % 50, cursor);
+            expected.insert(expected.begin() + cursor, i % 50);
+            cursor++;
+        }
+    }
+    assert(a.length() == (int)expected.size());
+    for (int i = 0; i < a.length(); i++) {
+        assert(a[i] == expected[i]);
+    }
+    assert(a.argmin() == std::min_element(expected.begin(), expected.end()) - expected.begin());
+    assert(a.argmax() == std::max_element(expected.begin(), expected.end()) - expected.begin());
+    assert(a.count(7) == std::count(expected.begin(), expected.end(), 7));
+}
+
+void test_empty_list_has_no_buffer() {
+    ArrayList a{};
+    assert(a.capacity() == 0);
+    a.print();
+    a.append(1);
+    assert(a.capacity() == 1);
+    ArrayList b{std::vector<int>{}};
+    assert(b.capacity() == 0);
+    assert(b.count(1) == 0);
+}
+
+void test_inline_storage_spills_and_returns() {
+    ArrayList<int, std::allocator<int>, 4> a{};
+    assert(a.capacity() == 4);
+    for (int i = 0; i < 4; i++) {
+        a.append(i);
+    }
+    assert(a.is_inline());
+    a.insert(-1, 0);
+    assert(!a.is_inline());
+    assert(a.capacity() == 8);
+    assert(a[0] == -1);
+    assert(a[4] == 3);
+    for (int i = 0; i < 4; i++) {
+        a.pop();
+    }
+    assert(a.is_inline());
+    assert(a.length() == 1);
+    assert(a[0] == -1);
+}
+
+void test_inline_storage_non_trivial_elements() {
+    ArrayList<std::string, std::allocator<std::string>, 2> a{{"first", "second"}};
+    assert(a.is_inline());
+    a.insert("zeroth", 0);
+    assert(!a.is_inline());
+    assert(a[1] == "first");
+    a.remove(0);
+    a.remove(0);
+    assert(a.get(0) == "second");
+    assert(a.pop() == "second");
+    assert(a.is_inline());
+    a.append("again");
+    assert(a[0] == "again");
+}
+
+int sum_by_value(ArrayList<int> list) {
+    int sum = 0;
+    for (int i = 0; i < list.length(); i++) {
+        sum += list[i];
+    }
+    return sum;
+}
+
+void test_copy_is_independent() {
+    ArrayList a{{1, 2, 3}};
+    ArrayList b = a;
+    b[0] = 10;
+    assert(a[0] == 1);
+    assert(sum_by_value(a) == 6);
+    a = b;
+    assert(a[0] == 10);
+    a = a;
+    assert(a.length() == 3);
+
+    ArrayList<std::string, std::allocator<std::string>, 2> c{{"x", "y", "z"}};
+    ArrayList<std::string, std::allocator<std::string>, 2> d{c};
+    d.pop();
+    assert(c.length() == 3);
+    assert(d[1] == "y");
+}
+
+void test_move_takes_buffer() {
+    ArrayList a{};
+    for (int i = 0; i < 100; i++) {
+        a.append(i);
+    }
+    int *data = &a[0];
+    ArrayList b = std::move(a);
+    assert(&b[0] == data);
+    assert(b.length() == 100);
+    assert(a.length() == 0);
+    a.append(5);
+    assert(a[0] == 5);
+
+    a = std::move(b);
+    assert(a.length() == 100);
+    assert(&a[0] == data);
+}
+
+void test_move_and_swap_inline_lists() {
+    ArrayList<std::string, std::allocator<std::string>, 4> a{{"a", "b"}};
+    ArrayList<std::string, std::allocator<std::string>, 4> b{{"c", "d", "e", "f", "g"}};
+    a.swap(b);
+    assert(a.length() == 5);
+    assert(a[4] == "g");
+    assert(b.length() == 2);
+    assert(b.is_inline());
+    assert(b[1] == "b");
+    ArrayList<std::string, std::allocator<std::string>, 4> c = std::move(b);
+    assert(c[0] == "a");
+    assert(b.length() == 0);
+}
+
+void test_adopt_vector_buffer() {
+    std::vector<int> values(1000, 7);
+    values.reserve(2000);
+    int *data = values.data();
+    ArrayList a = ArrayList<int>::adopt(std::move(values));
+    assert(a.length() == 1000);
+    assert(a.capacity() == 2000);
+    assert(&a[0] == data);
+    a.append(8);
+    assert(&a[0] == data);
+    for (int i = 0; i < 1500; i++) {
+        a.append(i);
+    }
+    assert(a[2500] == 1499);
+    assert(a.count(7) == 1001);
+
+    ArrayList<std::string> b = ArrayList<std::string>::adopt(std::vector<std::string>{"a", "b"});
+    assert(b[1] == "b");
+}
+
+void test_adopt_raw_buffer() {
+    std::allocator<double> alloc;
+    double *data = alloc.allocate(8);
+    for (int i = 0; i < 3; i++) {
+        data[i] = i + 0.5;
+    }
+    ArrayList a = ArrayList<double>::adopt(data, 3, 8);
+    assert(a.capacity() == 8);
+    assert(a[2] == 2.5);
+    a.append(3.5);
+    assert(a.max() == 3.5);
+}
+
+void test_iterators_work_with_algorithms() {
+    ArrayList a{{5, 3, 8, 1}};
+    int sum = 0;
+    for (int value : a) {
+        sum += value;
+    }
+    assert(sum == 17);
+    std::sort(a.begin(), a.end());
+    assert(a[0] == 1 && a[3] == 8);
+    assert(std::find(a.begin(), a.end(), 5) - a.begin() == 2);
+    assert(a.end()[-1] == 8);
+
+    const ArrayList<int> &b = a;
+    sum = 0;
+    for (const int *p = b.begin(); p != b.end(); ++p) {
+        sum += *p;
+    }
+    assert(sum == 17);
+}
+
+void test_insert_before_and_erase_iterators() {
+    ArrayList<std::string> a{{"a", "c"}};
+    auto it = a.insert_before(a.begin() + 1, "b");
+    assert(*it == "b");
+    it = a.insert_before(a.end(), "d");
+    assert(a.length() == 4 && *it == "d");
+    it = a.erase(a.begin());
+    assert(*it == "b" && a.length() == 3);
+
+    // Remove the odd values in one pass
+    ArrayList c{};
+    for (int i = 0; i < 1000; i++) {
+        c.append(i);
+    }
+    c.erase(std::remove_if(c.begin(), c.end(), [](int v) { return v % 2 == 1; }), c.end());
+    assert(c.length() == 500);
+    assert(c[499] == 998);
+    assert(c.capacity() == 1024);
+    c.erase(c.begin() + 10, c.end());
+    assert(c.length() == 10 && c[9] == 18);
+    assert(c.capacity() < 1024);
+}
+
+void test_trace_record_and_replay() {
+    TraceRecorder<ArrayList<int>> recorder{};
+    for (int i = 0; i < 200; i++) {
+        recorder.append(i - 100);
+    }
+    recorder.insert(-70000, 3);
+    recorder.remove(10);
+    assert(recorder.pop() == 99);
+    assert(recorder.pop(0) == -100);
+    assert(recorder[2] == -70000);
+    assert(recorder.min() == -70000);
+    assert(recorder.max() == 98);
+    assert(recorder.count(5) == 1);
+    assert(recorder.length() == 198);
+
+    const OperationTrace& trace = recorder.trace();
+    assert(trace.length() == 208);
+    // Opcode plus one or two bytes per argument for these values
+    assert(trace.size_in_bytes() < 4 * 208);
+
+    std::vector<OperationTrace::Operation> operations = trace.decode();
+    assert(operations.size() == 208);
+    assert(operations[0].op == OperationTrace::append && operations[0].value == -100);
+    assert(operations[200].op == OperationTrace::insert);
+    assert(operations[200].value == -70000 && operations[200].index == 3);
+    assert(operations[207].op == OperationTrace::count && operations[207].value == 5);
+
+    // Replaying gives the same list, and the same checksum on other lists
+    ArrayList a{};
+    unsigned long long checksum = replay(operations, a);
+    assert(a.length() == recorder.length());
+    for (int i = 0; i < a.length(); i++) {
+        assert(a[i] == recorder.list()[i]);
+    }
+    GapBuffer<int> g{};
+    assert(replay(operations, g) == checksum);
+    CircularArrayList<int> c{};
+    assert(replay(operations, c) == checksum);
+
+    // Elements already in a wrapped list are recorded too
+    TraceRecorder<ArrayList<int>> wrapped{ArrayList<int>{{4, 5}}};
+    wrapped.insert(6, 1);
+    ArrayList d{};
+    replay(wrapped.trace().decode(), d);
+    assert(d.length() == 3 && d[0] == 4 && d[1] == 6 && d[2] == 5);
+
+    trace.save("trace_test.bin");
+    OperationTrace loaded = OperationTrace::load("trace_test.bin");
+    std::remove("trace_test.bin");
+    assert(loaded.length() == trace.length());
+    ArrayList b{};
+    assert(replay(loaded.decode(), b) == checksum);
+}
+
+struct ThrowingMove {
+    int value = 0;
+    ThrowingMove() = default;
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove(ThrowingMove&& other) : value(other.value) {}
+    ThrowingMove& operator=(const ThrowingMove&) = default;
+};
+
+void test_move_noexcept_follows_element_type() {
+    static_assert(std::is_nothrow_move_constructible<ArrayList<int, std::allocator<int>, 4>>::value, "");
+    static_assert(std::is_nothrow_move_constructible<ArrayList<ThrowingMove>>::value, "");
+    static_assert(!std::is_nothrow_move_constructible<ArrayList<ThrowingMove, std::allocator<ThrowingMove>, 4>>::value, "");
+    static_assert(!noexcept(std::declval<ArrayList<ThrowingMove, std::allocator<ThrowingMove>, 4>&>().swap(
+        std::declval<ArrayList<ThrowingMove, std::allocator<ThrowingMove>, 4>&>())), "");
+}